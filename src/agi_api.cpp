@@ -1,36 +1,113 @@
 #include "agi_api.h"
 #include "module_integration.h"
-#include <sstream>
-#include <iomanip>
+#include "persistence.h"
+#include "learning_log.h"
+#include "model_snapshot.h"
+#include "learning_queue.h"
+#include "config.h"
+#include "json.h"
+#include "status_snapshot.h"
+#include <cctype>
 
-extern std::string generateResponse(const std::string& input);
+extern std::string chatResponse(const std::string& input);
+extern void clearHistory();
 extern void sv(const std::string& filename);
 extern void ld(const std::string& filename);
+extern void export_text(const std::string& filename);
+extern void import_text(const std::string& filename);
 
 AGI_API::AGI_API(int port) : server_(std::make_unique<WebServer>(port)) {
     server_->register_route("POST", "/api/chat", [this](const HttpRequest& req) { return handle_chat(req); });
     server_->register_route("POST", "/api/save", [this](const HttpRequest& req) { return handle_save(req); });
+    server_->register_route("GET", "/api/save", [this](const HttpRequest& req) { return handle_save_status(req); });
     server_->register_route("POST", "/api/load", [this](const HttpRequest& req) { return handle_load(req); });
+    server_->register_route("POST", "/api/export", [this](const HttpRequest& req) { return handle_export(req); });
+    server_->register_route("POST", "/api/import", [this](const HttpRequest& req) { return handle_import(req); });
+    server_->register_route("GET", "/api/status", [this](const HttpRequest& req) { return handle_status(req); });
+    server_->register_route("GET", "/api/consciousness", [this](const HttpRequest& req) { return handle_consciousness(req); });
+    server_->register_route("GET", "/api/thoughts", [this](const HttpRequest& req) { return handle_thoughts(req); });
+    server_->register_route("GET", "/api/goals", [this](const HttpRequest& req) { return handle_goals(req); });
+    server_->register_route("GET", "/api/valence", [this](const HttpRequest& req) { return handle_valence(req); });
+    server_->register_route("GET", "/api/history", [this](const HttpRequest& req) { return handle_history(req); });
+    server_->register_route("POST", "/api/clear", [this](const HttpRequest& req) { return handle_clear(req); });
+    server_->register_route("GET", "/api/memory", [this](const HttpRequest& req) { return handle_memory(req); });
+    server_->register_route("GET", "/api/ngrams", [this](const HttpRequest& req) { return handle_ngrams(req); });
+    server_->register_route("GET", "/api/ngrams/:word", [this](const HttpRequest& req) { return handle_ngrams(req); });
+    server_->register_route("GET", "/api/embedding", [this](const HttpRequest& req) { return handle_embedding(req); });
+    server_->register_route("GET", "/api/embedding/:word", [this](const HttpRequest& req) { return handle_embedding(req); });
+    server_->register_route("GET", "/api/startup", [this](const HttpRequest& req) { return handle_startup(req); });
+    server_->register_route("GET", "/api/learning", [this](const HttpRequest& req) { return handle_learning(req); });
     server_->register_route("GET", "/", [this](const HttpRequest& req) { return handle_ui(req); });
 }
 
 AGI_API::~AGI_API() { stop(); }
 void AGI_API::start() { server_->start(); }
-void AGI_API::stop() { server_->stop(); }
-
-std::string AGI_API::json_escape(const std::string& str) {
-    std::ostringstream oss;
-    for (char c : str) {
-        switch (c) {
-            case '"': oss << "\\\""; break;
-            case '\\': oss << "\\\\"; break;
-            case '\n': oss << "\\n"; break;
-            case '\r': oss << "\\r"; break;
-            case '\t': oss << "\\t"; break;
-            default: oss << c;
+void AGI_API::stop() {
+    allow_writes();
+    server_->stop();
+}
+
+void AGI_API::hold_writes() {
+    std::lock_guard<std::mutex> lock(startup_mutex_);
+    writes_held_ = true;
+}
+
+void AGI_API::allow_writes() {
+    {
+        std::lock_guard<std::mutex> lock(startup_mutex_);
+        writes_held_ = false;
+    }
+    writes_allowed_.notify_all();
+}
+
+void AGI_API::await_writes() {
+    std::unique_lock<std::mutex> lock(startup_mutex_);
+    writes_allowed_.wait(lock, [this] { return !writes_held_; });
+}
+
+void AGI_API::set_startup(const StartupTimes& times) {
+    std::lock_guard<std::mutex> lock(startup_mutex_);
+    startup_ = times;
+}
+
+namespace {
+std::string error_json(std::string_view message) {
+    std::string body;
+    JsonWriter(body).begin_object()
+        .field("status", "error")
+        .field("message", message)
+        .end_object();
+    return body;
+}
+}
+
+std::string AGI_API::query_param(const HttpRequest& req, const std::string& name) {
+    // A path parameter of the same name wins ("/api/embedding/:word")
+    auto param = req.params.find(name);
+    if (param != req.params.end()) return param->second;
+    size_t pos = 0;
+    while (pos <= req.query.size()) {
+        size_t end = req.query.find('&', pos);
+        if (end == std::string::npos) end = req.query.size();
+        size_t eq = req.query.find('=', pos);
+        if (eq < end && req.query.compare(pos, eq - pos, name) == 0) {
+            std::string value;
+            for (size_t i = eq + 1; i < end; i++) {
+                if (req.query[i] == '+') {
+                    value += ' ';
+                } else if (req.query[i] == '%' && i + 2 < end && isxdigit((unsigned char)req.query[i + 1]) &&
+                           isxdigit((unsigned char)req.query[i + 2])) {
+                    value += (char)std::stoi(req.query.substr(i + 1, 2), nullptr, 16);
+                    i += 2;
+                } else {
+                    value += req.query[i];
+                }
+            }
+            return value;
         }
+        pos = end + 1;
     }
-    return oss.str();
+    return "";
 }
 
 std::string AGI_API::sanitize_output(const std::string& raw) {
@@ -101,54 +178,272 @@ HttpResponse AGI_API::handle_chat(const HttpRequest& req) {
     HttpResponse resp;
     resp.status_code = 200;
     
-    std::string message;
-    size_t msg_pos = req.body.find("\"message\":");
-    if (msg_pos != std::string::npos) {
-        size_t start = req.body.find('"', msg_pos + 10) + 1;
-        size_t end = req.body.find('"', start);
-        message = req.body.substr(start, end - start);
+    JsonDocument doc;
+    if (!doc.parse(req.body)) {
+        resp.status_code = 400;
+        JsonWriter(resp.body).begin_object()
+            .field("error", "Invalid JSON")
+            .field("detail", doc.error())
+            .field("offset", doc.error_offset())
+            .end_object();
+        return resp;
     }
+    std::string message(doc.root()["message"].as_string());
     
+    await_writes();
     try {
-        std::string raw_response = generateResponse(message);
+        std::string raw_response = chatResponse(message);
         std::string sanitized = sanitize_output(raw_response);
         
-        std::ostringstream oss;
-        oss << "{\"status\":\"ok\",\"response\":\"" << json_escape(sanitized) << "\"}";
-        resp.body = oss.str();
+        JsonWriter(resp.body).begin_object()
+            .field("status", "ok")
+            .field("response", sanitized)
+            .end_object();
     } catch (const std::exception& e) {
-        resp.body = "{\"status\":\"error\",\"message\":\"" + json_escape(e.what()) + "\"}";
+        resp.body = error_json(e.what());
         resp.status_code = 500;
     }
     return resp;
 }
 
-HttpResponse AGI_API::handle_save(const HttpRequest&) {
+HttpResponse AGI_API::handle_save(const HttpRequest& req) {
+    // Queued for the simulation loop; the write happens in the background
+    PersistenceService::request("state.dat");
+    HttpResponse resp = handle_save_status(req);
+    resp.status_code = 202;
+    return resp;
+}
+
+HttpResponse AGI_API::handle_save_status(const HttpRequest&) {
+    SaveStatus ss = PersistenceService::status();
+    CheckpointStats cs = checkpoint_stats();
+    LearningLogStats ls = LearningLog::stats();
     HttpResponse resp;
     resp.status_code = 200;
+    JsonWriter(resp.body).begin_object()
+        .field("status", ss.state)
+        .field("last_result", ss.last_result)
+        .field("last_error", ss.last_error)
+        .field("kind", ss.last_kind)
+        .field("bytes", ss.last_bytes)
+        .field("capture_ms", ss.capture_ms, 2)
+        .field("write_ms", ss.write_ms, 2)
+        .field("generation", ss.generation)
+        .field("completed", ss.completed)
+        .field("failed", ss.failed)
+        .field("coalesced", ss.coalesced)
+        .field("delta_frames", cs.delta_frames)
+        .key("learning_log").begin_object()
+            .field("open", ls.open)
+            .field("sync", ls.sync)
+            .field("last_lsn", ls.last_lsn)
+            .field("durable_lsn", ls.durable_lsn)
+            .field("covered_lsn", ls.covered_lsn)
+            .field("pending_bytes", ls.pending_bytes)
+            .field("events", ls.events)
+            .field("commits", ls.commits)
+        .end_object()
+        .end_object();
+    return resp;
+}
+
+HttpResponse AGI_API::handle_load(const HttpRequest&) {
+    HttpResponse resp;
+    resp.status_code = 200;
+    await_writes();
     try {
-        sv("state.dat");
-        resp.body = "{\"status\":\"saved\"}";
+        ModelWriter::submit([] { ld("state.dat"); });
+        resp.body = "{\"status\":\"loaded\"}";
     } catch (const std::exception& e) {
         resp.status_code = 500;
-        resp.body = "{\"status\":\"error\",\"message\":\"" + json_escape(e.what()) + "\"}";
+        resp.body = error_json(e.what());
     }
     return resp;
 }
 
-HttpResponse AGI_API::handle_load(const HttpRequest&) {
+HttpResponse AGI_API::handle_export(const HttpRequest&) {
     HttpResponse resp;
     resp.status_code = 200;
+    await_writes();
     try {
-        ld("state.dat");
-        resp.body = "{\"status\":\"loaded\"}";
+        ModelWriter::submit([] { export_text("state.txt"); });
+        resp.body = "{\"status\":\"exported\",\"file\":\"state.txt\"}";
     } catch (const std::exception& e) {
         resp.status_code = 500;
-        resp.body = "{\"status\":\"error\",\"message\":\"" + json_escape(e.what()) + "\"}";
+        resp.body = error_json(e.what());
     }
     return resp;
 }
 
+HttpResponse AGI_API::handle_import(const HttpRequest&) {
+    HttpResponse resp;
+    resp.status_code = 200;
+    await_writes();
+    try {
+        ModelWriter::submit([] { import_text("state.txt"); });
+        resp.body = "{\"status\":\"imported\",\"file\":\"state.txt\"}";
+    } catch (const std::exception& e) {
+        resp.status_code = 500;
+        resp.body = error_json(e.what());
+    }
+    return resp;
+}
+
+// The dashboard endpoints serve what the loop rendered at its last tick
+// boundary; see status_snapshot.h.
+namespace {
+HttpResponse status_doc(std::string StatusDocs::*doc) {
+    HttpResponse resp;
+    resp.status_code = 200;
+    resp.body = StatusSnapshot::current().get()->*doc;
+    return resp;
+}
+}
+
+HttpResponse AGI_API::handle_status(const HttpRequest&) { return status_doc(&StatusDocs::status); }
+HttpResponse AGI_API::handle_consciousness(const HttpRequest&) { return status_doc(&StatusDocs::consciousness); }
+HttpResponse AGI_API::handle_thoughts(const HttpRequest&) { return status_doc(&StatusDocs::thoughts); }
+HttpResponse AGI_API::handle_goals(const HttpRequest&) { return status_doc(&StatusDocs::goals); }
+HttpResponse AGI_API::handle_valence(const HttpRequest&) { return status_doc(&StatusDocs::valence); }
+HttpResponse AGI_API::handle_history(const HttpRequest&) { return status_doc(&StatusDocs::history); }
+HttpResponse AGI_API::handle_memory(const HttpRequest&) { return status_doc(&StatusDocs::memory); }
+
+HttpResponse AGI_API::handle_clear(const HttpRequest&) {
+    HttpResponse resp;
+    resp.status_code = 200;
+    await_writes();
+    try {
+        ModelWriter::submit([] {
+            LearningLog::record(LearningEventKind::ClearHistory);
+            clearHistory();
+        });
+        JsonWriter(resp.body).begin_object()
+            .field("status", "cleared")
+            .field("generation", StatusSnapshot::current()->generation)
+            .end_object();
+    } catch (const std::exception& e) {
+        resp.status_code = 500;
+        resp.body = error_json(e.what());
+    }
+    return resp;
+}
+
+// Served from the mapped snapshot until the lexicon is promoted, from the
+// published model view after.
+HttpResponse AGI_API::handle_ngrams(const HttpRequest& req) {
+    HttpResponse resp;
+    std::string word = query_param(req, "word");
+    if (word.empty()) {
+        resp.status_code = 400;
+        resp.body = "{\"error\": \"missing word\"}";
+        return resp;
+    }
+    std::string next = query_param(req, "next");
+    auto counts = [](JsonWriter& out, const std::map<std::string, int>& row) {
+        out.begin_object();
+        for (const auto& [w, c] : row) out.field(w, c);
+        out.end_object();
+    };
+    JsonWriter out(resp.body);
+    out.begin_object()
+        .field("word", word)
+        .field("source", lexicon_mapped() ? "mapped" : "live")
+        .key("bigrams");
+    counts(out, lookup_bigrams(word));
+    if (!next.empty()) {
+        out.field("next", next).key("trigrams");
+        counts(out, lookup_trigrams(word, next));
+    }
+    out.end_object();
+    resp.status_code = 200;
+    return resp;
+}
+
+HttpResponse AGI_API::handle_embedding(const HttpRequest& req) {
+    HttpResponse resp;
+    std::string word = query_param(req, "word");
+    if (word.empty()) {
+        resp.status_code = 400;
+        resp.body = "{\"error\": \"missing word\"}";
+        return resp;
+    }
+    bool mapped = lexicon_mapped();
+    TokenConceptEmbedding tce;
+    if (!lookup_embedding(word, tce)) {
+        resp.status_code = 404;
+        resp.body = "{\"error\": \"Not found\"}";
+        return resp;
+    }
+    JsonWriter out(resp.body);
+    out.begin_object()
+        .field("word", word)
+        .field("source", mapped ? "mapped" : "live")
+        .field("meaning", tce.meaning)
+        .field("freq", tce.freq)
+        .field("grounding", tce.grounding_value)
+        .field("stability", tce.semantic_stability)
+        .field("qualia_intensity", tce.qualia_intensity)
+        .key("embedding").begin_array();
+    for (double v : tce.embedding) out.value(v);
+    out.end_array().key("linked_concepts").begin_object();
+    for (const auto& [name, v] : tce.linked_concepts) out.field(name, v);
+    out.end_object().end_object();
+    resp.status_code = 200;
+    return resp;
+}
+
+HttpResponse AGI_API::handle_startup(const HttpRequest&) {
+    StartupTimes times;
+    {
+        std::lock_guard<std::mutex> lock(startup_mutex_);
+        times = startup_;
+    }
+    HttpResponse resp;
+    resp.status_code = 200;
+    JsonWriter out(resp.body);
+    auto since_start = [&](const char* name, std::chrono::steady_clock::time_point t) {
+        out.key(name);
+        if (t.time_since_epoch().count() == 0) out.null();
+        else out.value(std::chrono::duration<double, std::milli>(t - times.process_start).count(), 2);
+    };
+    LazyLoadStats lz = lazy_load_stats();
+    out.begin_object()
+        .field("lazy", times.lazy)
+        .field("load_ms", times.load_ms, 2);
+    since_start("api_ready_ms", server_->listening_since());
+    since_start("first_response_ms", server_->first_response_at());
+    if (times.ready_ms > 0) out.field("ready_ms", times.ready_ms, 2);
+    else out.key("ready_ms").null();
+    out.field("lexicon", lexicon_mapped() ? "mapped" : "live")
+        .field("map_ms", lz.map_ms, 2)
+        .field("promote_ms", lz.promote_ms, 2)
+        .field("mapped_lookups", lz.mapped_lookups)
+        .end_object();
+    return resp;
+}
+
+HttpResponse AGI_API::handle_learning(const HttpRequest&) {
+    LearningQueueStats q = LearningQueue::stats();
+    HttpResponse resp;
+    resp.status_code = 200;
+    JsonWriter(resp.body).begin_object()
+        .field("mode", NexusConfig::get().chat_learning == "before" ? "before" : "after")
+        .field("depth", q.depth)
+        .field("capacity", q.capacity)
+        .field("max_depth", q.max_depth)
+        .field("pushed", q.pushed)
+        .field("learned", q.learned)
+        .field("batches", q.batches)
+        .field("full_waits", q.full_waits)
+        .key("last_batch").begin_object()
+            .field("messages", q.last_batch)
+            .field("distinct_tokens", q.last_batch_tokens)
+            .field("ms", q.last_batch_ms, 2)
+        .end_object()
+        .end_object();
+    return resp;
+}
+
 HttpResponse AGI_API::handle_ui(const HttpRequest&) {
     HttpResponse resp;
     resp.status_code = 200;
@@ -5,9 +5,20 @@
 #include <string>
 #include <memory>
 #include <functional>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include "web_server.h"
 #include "state.h"
 
+// Startup milestones for GET /api/startup, relative to process_start.
+struct StartupTimes {
+    std::chrono::steady_clock::time_point process_start = std::chrono::steady_clock::now();
+    bool lazy = false;
+    double load_ms = 0;             // ld() or ld_lazy()
+    double ready_ms = 0;            // until the simulation loop started, 0 before
+};
+
 class AGI_API {
 public:
     explicit AGI_API(int port = 8080);
@@ -16,8 +27,21 @@ public:
     void start();
     void stop();
 
+    // With writes held, handlers that change the model wait until
+    // allow_writes(); lookups and status are served meanwhile. Used when the
+    // server comes up before startup has finished.
+    void hold_writes();
+    void allow_writes();
+    void set_startup(const StartupTimes& times);
+
 private:
     std::unique_ptr<WebServer> server_;
+    std::mutex startup_mutex_;
+    std::condition_variable writes_allowed_;
+    bool writes_held_ = false;
+    StartupTimes startup_;
+    
+    void await_writes();
     
     HttpResponse handle_chat(const HttpRequest& req);
     HttpResponse handle_status(const HttpRequest& req);
@@ -28,11 +52,18 @@ private:
     HttpResponse handle_valence(const HttpRequest& req);
     HttpResponse handle_history(const HttpRequest& req);
     HttpResponse handle_save(const HttpRequest& req);
+    HttpResponse handle_save_status(const HttpRequest& req);
     HttpResponse handle_load(const HttpRequest& req);
+    HttpResponse handle_export(const HttpRequest& req);
+    HttpResponse handle_import(const HttpRequest& req);
     HttpResponse handle_clear(const HttpRequest& req);
+    HttpResponse handle_ngrams(const HttpRequest& req);
+    HttpResponse handle_embedding(const HttpRequest& req);
+    HttpResponse handle_startup(const HttpRequest& req);
+    HttpResponse handle_learning(const HttpRequest& req);
     HttpResponse handle_ui(const HttpRequest& req);
     
-    std::string json_escape(const std::string& str);
+    std::string query_param(const HttpRequest& req, const std::string& name);
     std::string filter_markers(const std::string& text);
     std::string sanitize_output(const std::string& raw);
 };
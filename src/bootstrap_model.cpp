@@ -0,0 +1,65 @@
+#include "bootstrap_model.h"
+#include "state.h"
+#include "snapshot.h"
+#include "persistence.h"
+#include <chrono>
+#include <filesystem>
+#include <iterator>
+
+namespace {
+constexpr uint64_t STAMP_SEED = 0x6E78626F6F74ull;   // "nxboot"
+constexpr uint32_t BUILD_SEED = 0x4E5853;
+
+double ms_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+}
+
+uint64_t BootstrapModel::stamp(const string& corpus) {
+    ifstream in(corpus, ios::binary);
+    string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    uint64_t h = snapshot_checksum(data.data(), data.size(), STAMP_SEED ^ BOOTSTRAP_MODEL_VERSION);
+    // Snapshot id 0 means "none"
+    return h ? h : 1;
+}
+
+bool BootstrapModel::build(const string& path, const string& corpus, const function<void()>& bootstrap) {
+    auto t0 = chrono::steady_clock::now();
+    // Fixed seeds make the artifact reproducible from the same inputs
+    srand(BUILD_SEED);
+    rng.seed(BUILD_SEED);
+    bootstrap();
+    double bootstrap_ms = ms_since(t0);
+    try {
+        sv_binary(path, stamp(corpus));
+    } catch (const SnapshotError& e) {
+        cerr << "Failed to write bootstrap model " << path << ": " << e.what() << endl;
+        return false;
+    }
+    cout << "[Bootstrap model v" << BOOTSTRAP_MODEL_VERSION << " built in " << fixed << setprecision(1)
+         << bootstrap_ms << " ms]\n";
+    return true;
+}
+
+bool BootstrapModel::load(const string& path, const string& corpus) {
+    std::error_code ec;
+    if (path.empty() || !filesystem::exists(path, ec)) return false;
+    auto t0 = chrono::steady_clock::now();
+    try {
+        {
+            SnapshotReader r;
+            r.open(path);
+            if (r.snapshot_id() != stamp(corpus)) {
+                cerr << "Bootstrap model " << path << " was built from a different corpus or bootstrap version, "
+                     << "bootstrapping live" << endl;
+                return false;
+            }
+        }
+        ld_binary(path);
+    } catch (const SnapshotError& e) {
+        cerr << "Failed to load bootstrap model " << path << ": " << e.what() << ", bootstrapping live" << endl;
+        return false;
+    }
+    cout << "[Bootstrap model " << path << " loaded in " << fixed << setprecision(1) << ms_since(t0) << " ms]\n";
+    return true;
+}
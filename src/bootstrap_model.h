@@ -0,0 +1,35 @@
+#ifndef BOOTSTRAP_MODEL_H
+#define BOOTSTRAP_MODEL_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Prebuilt first-run model.
+//
+// A fresh instance (no state.dat) normally builds its model by ingesting the
+// built-in vocabulary and corpus.txt, which is slow and the same for every
+// instance. `Nexus --build-bootstrap <file>` (make bootstrap-model) runs that
+// bootstrap once and writes the result as a binary snapshot; first-run
+// startup loads it instead.
+//
+// The artifact is stamped, in the snapshot id, with a hash of
+// BOOTSTRAP_MODEL_VERSION and the corpus it was built from. An artifact
+// whose stamp does not match the running binary and the corpus next to it
+// is ignored and the bootstrap runs live. Bump BOOTSTRAP_MODEL_VERSION
+// whenever the bootstrap code or its built-in data changes.
+class BootstrapModel {
+public:
+    static constexpr uint32_t BOOTSTRAP_MODEL_VERSION = 1;
+
+    static uint64_t stamp(const std::string& corpus);
+
+    // Runs `bootstrap` on the fresh model with a fixed seed and writes the
+    // result to `path`. Returns false if the artifact could not be written.
+    static bool build(const std::string& path, const std::string& corpus, const std::function<void()>& bootstrap);
+
+    // Loads `path` when it exists and matches the current stamp.
+    static bool load(const std::string& path, const std::string& corpus);
+};
+
+#endif
@@ -0,0 +1,54 @@
+#include "config.h"
+#include <cstdlib>
+#include <charconv>
+#include <cstring>
+
+const NexusConfig& NexusConfig::get() {
+    static const NexusConfig config = from_env();
+    return config;
+}
+
+NexusConfig NexusConfig::from_env() {
+    NexusConfig c;
+    c.max_neurons = env_size("NEXUS_MAX_NEURONS", c.max_neurons);
+    c.worker_threads = env_size("NEXUS_THREADS", c.worker_threads);
+    c.neural_grain = env_size("NEXUS_NEURAL_GRAIN", c.neural_grain);
+    c.snapshot_format = env_string("NEXUS_SNAPSHOT_FORMAT", c.snapshot_format);
+    c.delta_checkpoints = env_flag("NEXUS_DELTA_CHECKPOINTS", c.delta_checkpoints);
+    c.delta_max_frames = env_size("NEXUS_DELTA_MAX_FRAMES", c.delta_max_frames);
+    c.learning_log = env_flag("NEXUS_LEARNING_LOG", c.learning_log);
+    c.learning_log_sync = env_string("NEXUS_LEARNING_LOG_SYNC", c.learning_log_sync);
+    c.learning_log_flush_ms = env_size("NEXUS_LEARNING_LOG_FLUSH_MS", c.learning_log_flush_ms);
+    c.lazy_load = env_flag("NEXUS_LAZY_LOAD", c.lazy_load);
+    c.bootstrap_model = env_string("NEXUS_BOOTSTRAP_MODEL", c.bootstrap_model);
+    if (c.bootstrap_model == "off") c.bootstrap_model.clear();
+    c.http_acceptors = env_size("NEXUS_HTTP_ACCEPTORS", c.http_acceptors);
+    c.http_workers = env_size("NEXUS_HTTP_WORKERS", c.http_workers);
+    c.http_max_requests = env_size("NEXUS_HTTP_MAX_REQUESTS", c.http_max_requests);
+    c.http_idle_timeout_ms = env_size("NEXUS_HTTP_IDLE_TIMEOUT_MS", c.http_idle_timeout_ms);
+    c.http_max_head_bytes = env_size("NEXUS_HTTP_MAX_HEAD_BYTES", c.http_max_head_bytes);
+    c.http_max_headers = env_size("NEXUS_HTTP_MAX_HEADERS", c.http_max_headers);
+    c.http_max_body_bytes = env_size("NEXUS_HTTP_MAX_BODY_BYTES", c.http_max_body_bytes);
+    c.chat_learning = env_string("NEXUS_CHAT_LEARNING", c.chat_learning);
+    c.chat_queue = env_size("NEXUS_CHAT_QUEUE", c.chat_queue);
+    return c;
+}
+
+size_t NexusConfig::env_size(const char* name, size_t fallback) {
+    const char* v = std::getenv(name);
+    if (!v || !*v) return fallback;
+    size_t out = 0;
+    auto [ptr, ec] = std::from_chars(v, v + std::strlen(v), out);
+    return (ec == std::errc() && *ptr == '\0') ? out : fallback;
+}
+
+bool NexusConfig::env_flag(const char* name, bool fallback) {
+    const char* v = std::getenv(name);
+    if (!v || !*v) return fallback;
+    return !(std::strcmp(v, "0") == 0 || std::strcmp(v, "false") == 0 || std::strcmp(v, "off") == 0);
+}
+
+std::string NexusConfig::env_string(const char* name, const std::string& fallback) {
+    const char* v = std::getenv(name);
+    return (v && *v) ? std::string(v) : fallback;
+}
@@ -0,0 +1,40 @@
+#ifndef NEXUS_CONFIG_H
+#define NEXUS_CONFIG_H
+
+#include <cstddef>
+#include <string>
+
+// Runtime tunables. Each field has a compiled-in default that can be
+// overridden with the NEXUS_* environment variable named next to it; values
+// are read once, on first use of get().
+struct NexusConfig {
+    size_t max_neurons = 500;       // NEXUS_MAX_NEURONS: growth cap for S.N
+    size_t worker_threads = 0;      // NEXUS_THREADS: pool workers, 0 = cores - 1
+    size_t neural_grain = 4096;     // NEXUS_NEURAL_GRAIN: rows per SpMV chunk
+    std::string snapshot_format = "binary";  // NEXUS_SNAPSHOT_FORMAT: binary | text
+    bool delta_checkpoints = true;  // NEXUS_DELTA_CHECKPOINTS: append deltas between full saves
+    size_t delta_max_frames = 32;   // NEXUS_DELTA_MAX_FRAMES: deltas before compacting to a base
+    bool learning_log = true;       // NEXUS_LEARNING_LOG: write-ahead log of learning events
+    std::string learning_log_sync = "none";  // NEXUS_LEARNING_LOG_SYNC: none | batch | always
+    size_t learning_log_flush_ms = 100;      // NEXUS_LEARNING_LOG_FLUSH_MS: group commit interval
+    bool lazy_load = false;         // NEXUS_LAZY_LOAD: serve the lexicon from the mapped snapshot at startup
+    std::string bootstrap_model = "bootstrap.dat";  // NEXUS_BOOTSTRAP_MODEL: prebuilt first-run model, off = none
+    size_t http_acceptors = 1;      // NEXUS_HTTP_ACCEPTORS: epoll loops accepting connections
+    size_t http_workers = 4;        // NEXUS_HTTP_WORKERS: request handler threads, 0 = run on the loop
+    size_t http_max_requests = 1000;        // NEXUS_HTTP_MAX_REQUESTS: per connection, 1 = no keep-alive
+    size_t http_idle_timeout_ms = 5000;     // NEXUS_HTTP_IDLE_TIMEOUT_MS: close connections idle this long
+    size_t http_max_head_bytes = 16384;     // NEXUS_HTTP_MAX_HEAD_BYTES: request line and headers, else 431
+    size_t http_max_headers = 64;           // NEXUS_HTTP_MAX_HEADERS: header fields per request, else 431
+    size_t http_max_body_bytes = 1 << 20;   // NEXUS_HTTP_MAX_BODY_BYTES: decoded request body, else 413
+    std::string chat_learning = "after";    // NEXUS_CHAT_LEARNING: after = reply at once, before = once learned
+    size_t chat_queue = 1024;               // NEXUS_CHAT_QUEUE: chat messages waiting to be learned
+
+    static const NexusConfig& get();
+    static NexusConfig from_env();
+
+    static size_t env_size(const char* name, size_t fallback);
+    static bool env_flag(const char* name, bool fallback);
+    static std::string env_string(const char* name, const std::string& fallback);
+};
+
+#endif
@@ -4,9 +4,8 @@
 #include <algorithm>
 #include <numeric>
 
-// Use std:: prefix for vector definitions
-std::vector<double> ConsciousnessCoherence::consciousness_trajectory_;
-std::vector<double> ConsciousnessCoherence::coherence_history_;
+RingBuffer<double, 100> ConsciousnessCoherence::consciousness_trajectory_;
+RingBuffer<double, 100> ConsciousnessCoherence::coherence_history_;
 
 CoherenceMetrics ConsciousnessCoherence::calculate_coherence(double current_valence, int generation) {
     (void)generation; // Mark unused parameter to silence warning
@@ -14,9 +13,6 @@ CoherenceMetrics ConsciousnessCoherence::calculate_coherence(double current_vale
 
     // Track trajectory
     consciousness_trajectory_.push_back(current_valence);
-    if (consciousness_trajectory_.size() > 100) {
-        consciousness_trajectory_.erase(consciousness_trajectory_.begin());
-    }
 
     // Initialize qualia valences for coherence calculation
     double qualia_valences[] = { current_valence, current_valence * 0.9, current_valence * 1.1 };
@@ -51,7 +47,7 @@ double ConsciousnessCoherence::calculate_semantic_coherence(const std::vector<do
     return std::clamp(coherence, 0.0, 1.0);
 }
 
-double ConsciousnessCoherence::calculate_temporal_coherence(const std::vector<double>& history) {
+double ConsciousnessCoherence::calculate_temporal_coherence(const RingBuffer<double, 100>& history) {
     if (history.size() < 2) return 1.0;
 
     double total_diff = 0.0;
@@ -92,5 +88,5 @@ double ConsciousnessCoherence::get_average_coherence() {
 }
 
 std::vector<double> ConsciousnessCoherence::get_consciousness_trajectory() {
-    return consciousness_trajectory_;
+    return consciousness_trajectory_.to_vector();
 }
\ No newline at end of file
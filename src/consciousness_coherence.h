@@ -2,6 +2,7 @@
 #define CONSCIOUSNESS_COHERENCE_H
 
 #include <vector>
+#include "ring_buffer.h"
 
 struct CoherenceMetrics {
     double semantic_coherence;
@@ -18,11 +19,11 @@ public:
 
 private:
     static double calculate_semantic_coherence(const std::vector<double>& qualia_valences);
-    static double calculate_temporal_coherence(const std::vector<double>& history);
+    static double calculate_temporal_coherence(const RingBuffer<double, 100>& history);
     static double calculate_integrated_information(const std::vector<double>& state_vector);
 
-    static std::vector<double> consciousness_trajectory_;
-    static std::vector<double> coherence_history_;
+    static RingBuffer<double, 100> consciousness_trajectory_;
+    static RingBuffer<double, 100> coherence_history_;
 };
 
 #endif
\ No newline at end of file
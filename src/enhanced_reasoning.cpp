@@ -13,8 +13,8 @@ map<string, ConceptNode> EnhancedReasoning::concept_graph_;
 ReasoningContext EnhancedReasoning::current_context_;
 
 extern random_device rd;
-extern mt19937 rng;
-extern map<string, TokenConceptEmbedding> token_concept_embedding_map;
+extern thread_local mt19937 rng;
+extern SampledMap<string, TokenConceptEmbedding> token_concept_embedding_map;
 extern vector<string> sentence_templates;
 
 // Helper function declarations (should match main.cpp)
@@ -17,7 +17,7 @@ vector<string> GoalPlanner::achieved_goals_;
 
 // Reference the external random engines
 extern std::random_device rd;
-extern std::mt19937 rng;
+extern thread_local std::mt19937 rng;
 
 AchievementGoal GoalPlanner::formulate_goal_from_context(const string& context, double current_valence) {
     AchievementGoal goal;
@@ -0,0 +1,271 @@
+#include "http_parser.h"
+#include <algorithm>
+
+namespace {
+constexpr size_t npos = std::string_view::npos;
+
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i], y = b[i];
+        if (x >= 'A' && x <= 'Z') x = (char)(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = (char)(y - 'A' + 'a');
+        if (x != y) return false;
+    }
+    return true;
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// Line [from, nl) without its CR.
+std::string_view line_at(std::string_view buf, size_t from, size_t nl) {
+    std::string_view line = buf.substr(from, nl - from);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    return line;
+}
+
+// True when the comma-separated header value lists `token`.
+bool has_token(std::string_view value, std::string_view token) {
+    while (!value.empty()) {
+        size_t comma = value.find(',');
+        if (iequals(trim(value.substr(0, comma)), token)) return true;
+        if (comma == npos) break;
+        value.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+bool parse_decimal(std::string_view s, size_t& out) {
+    if (s.empty() || s.size() > 18) return false;
+    out = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return false;
+        out = out * 10 + (size_t)(c - '0');
+    }
+    return true;
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool is_token_char(char c) {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) return true;
+    switch (c) {
+    case '!': case '#': case '$': case '%': case '&': case '\'': case '*': case '+':
+    case '-': case '.': case '^': case '_': case '`': case '|': case '~':
+        return true;
+    default:
+        return false;
+    }
+}
+}
+
+void HttpParser::reset() {
+    stage_ = Stage::Head;
+    start_ = line_ = head_end_ = pos_ = 0;
+    content_length_ = chunk_left_ = 0;
+    chunked_ = keep_alive_ = false;
+    headers_.clear();
+    decoded_.clear();
+    req_ = HttpRequestView{};
+    error_status_ = 0;
+    error_ = "";
+}
+
+HttpParser::Status HttpParser::fail(int status, const char* why) {
+    stage_ = Stage::Failed;
+    error_status_ = status;
+    error_ = why;
+    return Status::Error;
+}
+
+HttpParser::Status HttpParser::parse(std::string_view buf) {
+    if (stage_ == Stage::Failed) return Status::Error;
+    if (stage_ == Stage::Done) return Status::Complete;
+
+    if (stage_ == Stage::Head) {
+        // Find the blank line ending the head, one line per step; line_
+        // persists so a partial head is not rescanned on the next call.
+        for (;;) {
+            size_t nl = buf.find('\n', line_);
+            if (nl == npos) {
+                if (buf.size() > limits_.max_head_bytes) return fail(431, "Request head too large");
+                return Status::Incomplete;
+            }
+            if (nl + 1 > limits_.max_head_bytes) return fail(431, "Request head too large");
+            size_t from = line_;
+            line_ = nl + 1;
+            if (!line_at(buf, from, nl).empty()) continue;
+            if (from == start_) {
+                // Blank lines before the request line are ignored
+                start_ = line_;
+                continue;
+            }
+            head_end_ = line_;
+            break;
+        }
+        Status s = parse_head(buf);
+        if (s != Status::Incomplete) return s;
+    }
+
+    if (stage_ == Stage::Body) {
+        if (buf.size() - head_end_ < content_length_) return Status::Incomplete;
+        return complete(buf, head_end_ + content_length_);
+    }
+    return parse_chunks(buf);
+}
+
+// Splits the head recorded in [start_, head_end_) into spans and settles the
+// body framing. Returns Incomplete to continue with the body.
+HttpParser::Status HttpParser::parse_head(std::string_view buf) {
+    size_t nl = buf.find('\n', start_);
+    std::string_view line = line_at(buf, start_, nl);
+    size_t sp1 = line.find(' ');
+    size_t sp2 = sp1 == npos ? npos : line.find(' ', sp1 + 1);
+    if (sp1 == 0 || sp2 == npos || sp2 == sp1 + 1 || line.find(' ', sp2 + 1) != npos)
+        return fail(400, "Malformed request line");
+    for (size_t i = 0; i < sp1; ++i)
+        if (!is_token_char(line[i])) return fail(400, "Malformed request line");
+    std::string_view version = line.substr(sp2 + 1);
+    if (version != "HTTP/1.1" && version != "HTTP/1.0") return fail(400, "Unsupported HTTP version");
+
+    uint32_t base = (uint32_t)start_;
+    method_ = {base, (uint32_t)sp1};
+    target_ = {base + (uint32_t)sp1 + 1, (uint32_t)(sp2 - sp1 - 1)};
+    version_ = {base + (uint32_t)sp2 + 1, (uint32_t)version.size()};
+
+    bool has_length = false, close = false, keep = false;
+    for (size_t from = nl + 1; from < head_end_;) {
+        nl = buf.find('\n', from);
+        std::string_view h = line_at(buf, from, nl);
+        if (h.empty()) break;
+        if (h.front() == ' ' || h.front() == '\t') return fail(400, "Folded header line");
+        size_t colon = h.find(':');
+        if (colon == 0 || colon == npos) return fail(400, "Malformed header line");
+        for (size_t i = 0; i < colon; ++i)
+            if (!is_token_char(h[i])) return fail(400, "Malformed header name");
+        if (headers_.size() == limits_.max_headers) return fail(431, "Too many headers");
+
+        std::string_view name = h.substr(0, colon);
+        std::string_view value = trim(h.substr(colon + 1));
+        Span value_span{(uint32_t)(value.data() - buf.data()), (uint32_t)value.size()};
+        headers_.push_back({{(uint32_t)from, (uint32_t)colon}, value_span});
+
+        if (iequals(name, "Content-Length")) {
+            size_t n;
+            if (!parse_decimal(value, n) || (has_length && n != content_length_))
+                return fail(400, "Invalid Content-Length");
+            has_length = true;
+            content_length_ = n;
+        } else if (iequals(name, "Transfer-Encoding")) {
+            // Only "chunked" (alone) is implemented
+            if (!iequals(value, "chunked")) return fail(501, "Unsupported Transfer-Encoding");
+            chunked_ = true;
+        } else if (iequals(name, "Connection")) {
+            close = close || has_token(value, "close");
+            keep = keep || has_token(value, "keep-alive");
+        }
+        from = nl + 1;
+    }
+
+    // Both framings at once is how requests get smuggled past proxies
+    if (chunked_ && has_length) return fail(400, "Content-Length with Transfer-Encoding");
+    if (content_length_ > limits_.max_body_bytes) return fail(413, "Request body too large");
+    keep_alive_ = version == "HTTP/1.1" ? !close : keep;
+
+    if (chunked_) {
+        stage_ = Stage::ChunkSize;
+        pos_ = head_end_;
+    } else {
+        stage_ = Stage::Body;
+    }
+    return Status::Incomplete;
+}
+
+HttpParser::Status HttpParser::parse_chunks(std::string_view buf) {
+    for (;;) {
+        if (stage_ == Stage::ChunkSize) {
+            size_t nl = buf.find('\n', pos_);
+            if (nl == npos) {
+                if (buf.size() - pos_ > 1024) return fail(400, "Malformed chunk size");
+                return Status::Incomplete;
+            }
+            std::string_view line = line_at(buf, pos_, nl);
+            line = trim(line.substr(0, line.find(';')));    // extensions are ignored
+            if (line.empty() || line.size() > 15) return fail(400, "Malformed chunk size");
+            size_t size = 0;
+            for (char c : line) {
+                int v = hex_value(c);
+                if (v < 0) return fail(400, "Malformed chunk size");
+                size = size * 16 + (size_t)v;
+            }
+            if (decoded_.size() + size > limits_.max_body_bytes) return fail(413, "Request body too large");
+            pos_ = nl + 1;
+            chunk_left_ = size;
+            stage_ = size == 0 ? Stage::Trailers : Stage::ChunkData;
+        } else if (stage_ == Stage::ChunkData) {
+            // Data arrives piecemeal; take what is here and resume after it
+            size_t avail = std::min(chunk_left_, buf.size() - pos_);
+            decoded_.append(buf.data() + pos_, avail);
+            pos_ += avail;
+            chunk_left_ -= avail;
+            if (chunk_left_ > 0) return Status::Incomplete;
+            size_t crlf = buf.size() > pos_ && buf[pos_] == '\r' ? 2 : 1;
+            if (buf.size() - pos_ < crlf) return Status::Incomplete;
+            if (buf[pos_ + crlf - 1] != '\n') return fail(400, "Malformed chunk data");
+            pos_ += crlf;
+            stage_ = Stage::ChunkSize;
+        } else {
+            // Trailer fields are accepted and discarded
+            size_t nl = buf.find('\n', pos_);
+            if (nl == npos) {
+                if (buf.size() - pos_ > limits_.max_head_bytes) return fail(431, "Trailers too large");
+                return Status::Incomplete;
+            }
+            bool blank = line_at(buf, pos_, nl).empty();
+            pos_ = nl + 1;
+            if (blank) return complete(buf, pos_);
+        }
+    }
+}
+
+HttpParser::Status HttpParser::complete(std::string_view buf, size_t length) {
+    stage_ = Stage::Done;
+    req_.method = method_.in(buf);
+    req_.target = target_.in(buf);
+    req_.version = version_.in(buf);
+    size_t q = req_.target.find('?');
+    req_.path = req_.target.substr(0, q);
+    req_.query = q == npos ? std::string_view{} : req_.target.substr(q + 1);
+    req_.headers.clear();
+    req_.headers.reserve(headers_.size());
+    for (const auto& [name, value] : headers_) req_.headers.emplace_back(name.in(buf), value.in(buf));
+    req_.body = chunked_ ? std::string_view(decoded_) : buf.substr(head_end_, content_length_);
+    req_.length = length;
+    req_.keep_alive = keep_alive_;
+    return Status::Complete;
+}
+
+std::string percent_decode(std::string_view s, bool plus_as_space) {
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '%' && i + 2 < s.size() && hex_value(s[i + 1]) >= 0 && hex_value(s[i + 2]) >= 0) {
+            out += (char)(hex_value(s[i + 1]) * 16 + hex_value(s[i + 2]));
+            i += 2;
+        } else if (s[i] == '+' && plus_as_space) {
+            out += ' ';
+        } else {
+            out += s[i];
+        }
+    }
+    return out;
+}
@@ -0,0 +1,86 @@
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Incremental HTTP/1.x request parser.
+//
+// parse() is called with everything buffered for the current request, from
+// its first byte, each time more arrives. It resumes where the previous call
+// stopped, so every byte is scanned about once however the request is split
+// across reads. The head is recorded as offsets; on completion request()
+// returns string_view fields into the buffer passed to that last call. They
+// stay valid until the buffer is modified. Bodies are framed by
+// Content-Length or chunked transfer coding. A chunked body is decoded into
+// the parser and is the only part that is copied.
+//
+// Limit violations and malformed input end in Error with the status to
+// answer with (400, 413, 431 or 501); the connection cannot be reused.
+
+struct HttpLimits {
+    size_t max_head_bytes = 16 * 1024;      // request line and headers
+    size_t max_headers = 64;
+    size_t max_body_bytes = 1024 * 1024;    // after chunked decoding
+};
+
+struct HttpRequestView {
+    std::string_view method, target, path, query, version;
+    std::vector<std::pair<std::string_view, std::string_view>> headers;
+    std::string_view body;
+    size_t length = 0;          // bytes of the buffer the request occupies
+    bool keep_alive = false;    // per version and Connection header
+};
+
+class HttpParser {
+public:
+    enum class Status { Incomplete, Complete, Error };
+
+    explicit HttpParser(const HttpLimits& limits = {}) : limits_(limits) {}
+
+    Status parse(std::string_view buf);
+    // Valid after parse() returned Complete.
+    const HttpRequestView& request() const { return req_; }
+    // Valid after parse() returned Error.
+    int error_status() const { return error_status_; }
+    const char* error() const { return error_; }
+
+    // Ready for the next request; its first byte is the new buffer start.
+    void reset();
+
+private:
+    struct Span {
+        uint32_t off = 0, len = 0;
+        std::string_view in(std::string_view buf) const { return buf.substr(off, len); }
+    };
+    enum class Stage { Head, Body, ChunkSize, ChunkData, Trailers, Done, Failed };
+
+    Status fail(int status, const char* why);
+    Status parse_head(std::string_view buf);
+    Status parse_chunks(std::string_view buf);
+    Status complete(std::string_view buf, size_t length);
+
+    HttpLimits limits_;
+    Stage stage_ = Stage::Head;
+    size_t start_ = 0;          // request line (after tolerated leading blank lines)
+    size_t line_ = 0;           // start of the head line being scanned
+    size_t head_end_ = 0;       // first body byte
+    size_t pos_ = 0;            // chunked: next unparsed byte
+    size_t content_length_ = 0, chunk_left_ = 0;
+    bool chunked_ = false, keep_alive_ = false;
+    Span method_, target_, version_;
+    std::vector<std::pair<Span, Span>> headers_;
+    std::string decoded_;
+    HttpRequestView req_;
+    int error_status_ = 0;
+    const char* error_ = "";
+};
+
+// %XX decoding; '+' becomes a space only for form/query data.
+std::string percent_decode(std::string_view s, bool plus_as_space);
+
+#endif
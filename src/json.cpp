@@ -0,0 +1,426 @@
+#include "json.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+// Length of the prefix of [p, p + n) that a JSON string holds verbatim:
+// everything up to the first '"', '\\' or control character. The writer
+// copies these runs in bulk and the reader skips them the same way.
+size_t plain_run(const char* p, size_t n) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i ctrl = _mm_set1_epi8(0x1f);
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        // max(v, 0x1f) == 0x1f exactly for the bytes <= 0x1f (unsigned)
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                                   _mm_cmpeq_epi8(_mm_max_epu8(v, ctrl), ctrl));
+        int mask = _mm_movemask_epi8(hit);
+        if (mask) return i + (size_t)__builtin_ctz((unsigned)mask);
+    }
+#endif
+    for (; i < n; ++i) {
+        unsigned char c = (unsigned char)p[i];
+        if (c == '"' || c == '\\' || c < 0x20) return i;
+    }
+    return n;
+}
+
+int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += (char)cp;
+    } else if (cp < 0x800) {
+        out += (char)(0xc0 | (cp >> 6));
+        out += (char)(0x80 | (cp & 0x3f));
+    } else if (cp < 0x10000) {
+        out += (char)(0xe0 | (cp >> 12));
+        out += (char)(0x80 | ((cp >> 6) & 0x3f));
+        out += (char)(0x80 | (cp & 0x3f));
+    } else {
+        out += (char)(0xf0 | (cp >> 18));
+        out += (char)(0x80 | ((cp >> 12) & 0x3f));
+        out += (char)(0x80 | ((cp >> 6) & 0x3f));
+        out += (char)(0x80 | (cp & 0x3f));
+    }
+}
+
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
+}
+
+// ===== READER =====
+
+bool JsonDocument::parse(std::string_view text, size_t max_depth) {
+    nodes_.clear();
+    decoded_.clear();
+    in_ = text;
+    pos_ = 0;
+    max_depth_ = max_depth;
+    error_ = "";
+    error_at_ = 0;
+    skip_ws();
+    bool ok = value(0);
+    if (ok) {
+        skip_ws();
+        if (pos_ != in_.size()) ok = fail("Trailing characters");
+    }
+    if (!ok) nodes_.clear();
+    return ok;
+}
+
+bool JsonDocument::fail(const char* why) {
+    error_ = why;
+    error_at_ = pos_;
+    return false;
+}
+
+void JsonDocument::skip_ws() {
+    while (pos_ < in_.size()) {
+        char c = in_[pos_];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+        ++pos_;
+    }
+}
+
+bool JsonDocument::value(size_t depth) {
+    if (pos_ >= in_.size()) return fail("Unexpected end of input");
+    uint32_t self = (uint32_t)nodes_.size();
+    nodes_.emplace_back();
+    char c = in_[pos_];
+
+    if (c == '{' || c == '[') {
+        if (depth >= max_depth_) return fail("Nesting too deep");
+        bool object = c == '{';
+        char close = object ? '}' : ']';
+        nodes_[self].type = object ? JsonType::Object : JsonType::Array;
+        ++pos_;
+        skip_ws();
+        uint32_t count = 0;
+        if (pos_ < in_.size() && in_[pos_] == close) {
+            ++pos_;
+        } else {
+            for (;;) {
+                std::string_view key;
+                if (object) {
+                    if (pos_ >= in_.size() || in_[pos_] != '"') return fail("Expected member name");
+                    if (!string(key)) return false;
+                    skip_ws();
+                    if (pos_ >= in_.size() || in_[pos_] != ':') return fail("Expected ':'");
+                    ++pos_;
+                    skip_ws();
+                }
+                uint32_t child = (uint32_t)nodes_.size();
+                if (!value(depth + 1)) return false;
+                nodes_[child].key = key;
+                ++count;
+                skip_ws();
+                if (pos_ < in_.size() && in_[pos_] == ',') {
+                    ++pos_;
+                    skip_ws();
+                    continue;
+                }
+                if (pos_ < in_.size() && in_[pos_] == close) {
+                    ++pos_;
+                    break;
+                }
+                return fail(object ? "Expected ',' or '}'" : "Expected ',' or ']'");
+            }
+        }
+        nodes_[self].count = count;
+    } else if (c == '"') {
+        std::string_view s;
+        if (!string(s)) return false;
+        nodes_[self].type = JsonType::String;
+        nodes_[self].text = s;
+    } else if (c == 't' || c == 'f' || c == 'n') {
+        std::string_view word = c == 't' ? "true" : c == 'f' ? "false" : "null";
+        if (in_.substr(pos_, word.size()) != word) return fail("Invalid literal");
+        pos_ += word.size();
+        nodes_[self].type = c == 'n' ? JsonType::Null : JsonType::Bool;
+        nodes_[self].boolean = c == 't';
+    } else if (c == '-' || is_digit(c)) {
+        Node n;
+        if (!number(n)) return false;
+        nodes_[self] = n;
+    } else {
+        return fail("Unexpected character");
+    }
+    nodes_[self].end = (uint32_t)nodes_.size();
+    return true;
+}
+
+// At the opening quote. Unescaped strings are views into the input.
+bool JsonDocument::string(std::string_view& out) {
+    size_t start = ++pos_;
+    pos_ += plain_run(in_.data() + pos_, in_.size() - pos_);
+    if (pos_ < in_.size() && in_[pos_] == '"') {
+        out = in_.substr(start, pos_ - start);
+        ++pos_;
+        return true;
+    }
+    std::string& d = decoded_.emplace_back(in_.substr(start, pos_ - start));
+    for (;;) {
+        if (pos_ >= in_.size()) return fail("Unterminated string");
+        char c = in_[pos_];
+        if (c == '"') {
+            ++pos_;
+            break;
+        }
+        if ((unsigned char)c < 0x20) return fail("Control character in string");
+        // c is a backslash
+        if (pos_ + 1 >= in_.size()) return fail("Unterminated string");
+        char e = in_[pos_ + 1];
+        pos_ += 2;
+        switch (e) {
+        case '"': d += '"'; break;
+        case '\\': d += '\\'; break;
+        case '/': d += '/'; break;
+        case 'b': d += '\b'; break;
+        case 'f': d += '\f'; break;
+        case 'n': d += '\n'; break;
+        case 'r': d += '\r'; break;
+        case 't': d += '\t'; break;
+        case 'u': {
+            auto hex4 = [&](size_t at, uint32_t& cp) {
+                if (at + 4 > in_.size()) return false;
+                cp = 0;
+                for (size_t i = 0; i < 4; ++i) {
+                    int v = hex_digit(in_[at + i]);
+                    if (v < 0) return false;
+                    cp = cp * 16 + (uint32_t)v;
+                }
+                return true;
+            };
+            uint32_t cp;
+            if (!hex4(pos_, cp)) return fail("Invalid \\u escape");
+            pos_ += 4;
+            if (cp >= 0xd800 && cp < 0xdc00) {
+                uint32_t lo;
+                if (pos_ + 1 < in_.size() && in_[pos_] == '\\' && in_[pos_ + 1] == 'u' && hex4(pos_ + 2, lo) &&
+                    lo >= 0xdc00 && lo < 0xe000) {
+                    cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+                    pos_ += 6;
+                } else {
+                    cp = 0xfffd;
+                }
+            } else if (cp >= 0xdc00 && cp < 0xe000) {
+                cp = 0xfffd;
+            }
+            append_utf8(d, cp);
+            break;
+        }
+        default:
+            pos_ -= 2;
+            return fail("Invalid escape");
+        }
+        size_t run = plain_run(in_.data() + pos_, in_.size() - pos_);
+        d.append(in_.data() + pos_, run);
+        pos_ += run;
+    }
+    out = d;
+    return true;
+}
+
+bool JsonDocument::number(Node& n) {
+    size_t start = pos_;
+    if (in_[pos_] == '-') ++pos_;
+    if (pos_ >= in_.size() || !is_digit(in_[pos_])) return fail("Invalid number");
+    if (in_[pos_] == '0') {
+        ++pos_;
+    } else {
+        while (pos_ < in_.size() && is_digit(in_[pos_])) ++pos_;
+    }
+    if (pos_ < in_.size() && in_[pos_] == '.') {
+        ++pos_;
+        if (pos_ >= in_.size() || !is_digit(in_[pos_])) return fail("Invalid number");
+        while (pos_ < in_.size() && is_digit(in_[pos_])) ++pos_;
+    }
+    if (pos_ < in_.size() && (in_[pos_] == 'e' || in_[pos_] == 'E')) {
+        ++pos_;
+        if (pos_ < in_.size() && (in_[pos_] == '+' || in_[pos_] == '-')) ++pos_;
+        if (pos_ >= in_.size() || !is_digit(in_[pos_])) return fail("Invalid number");
+        while (pos_ < in_.size() && is_digit(in_[pos_])) ++pos_;
+    }
+    n.type = JsonType::Number;
+    n.text = in_.substr(start, pos_ - start);
+    auto r = std::from_chars(n.text.data(), n.text.data() + n.text.size(), n.number);
+    if (r.ec != std::errc()) {
+        pos_ = start;
+        return fail("Number out of range");
+    }
+    return true;
+}
+
+JsonType JsonValue::type() const {
+    return doc_ ? doc_->nodes_[i_].type : JsonType::Null;
+}
+
+std::string_view JsonValue::as_string(std::string_view fallback) const {
+    return is_string() ? doc_->nodes_[i_].text : fallback;
+}
+
+double JsonValue::as_number(double fallback) const {
+    return is_number() ? doc_->nodes_[i_].number : fallback;
+}
+
+int64_t JsonValue::as_int(int64_t fallback) const {
+    if (!is_number()) return fallback;
+    std::string_view t = doc_->nodes_[i_].text;
+    int64_t n;
+    auto r = std::from_chars(t.data(), t.data() + t.size(), n);
+    return r.ec == std::errc() && r.ptr == t.data() + t.size() ? n : fallback;
+}
+
+bool JsonValue::as_bool(bool fallback) const {
+    return is_bool() ? doc_->nodes_[i_].boolean : fallback;
+}
+
+size_t JsonValue::size() const {
+    return is_array() || is_object() ? doc_->nodes_[i_].count : 0;
+}
+
+JsonValue JsonValue::operator[](size_t i) const {
+    if (i >= size()) return {};
+    uint32_t c = i_ + 1;
+    while (i--) c = doc_->nodes_[c].end;
+    return JsonValue(doc_, c);
+}
+
+JsonValue JsonValue::operator[](std::string_view key) const {
+    if (!is_object()) return {};
+    uint32_t end = doc_->nodes_[i_].end;
+    for (uint32_t c = i_ + 1; c < end; c = doc_->nodes_[c].end) {
+        if (doc_->nodes_[c].key == key) return JsonValue(doc_, c);
+    }
+    return {};
+}
+
+std::string_view JsonValue::key() const {
+    return doc_ ? doc_->nodes_[i_].key : std::string_view{};
+}
+
+JsonValue::Iterator& JsonValue::Iterator::operator++() {
+    i_ = doc_->nodes_[i_].end;
+    return *this;
+}
+
+JsonValue::Iterator JsonValue::begin() const {
+    return size() ? Iterator(doc_, i_ + 1) : end();
+}
+
+JsonValue::Iterator JsonValue::end() const {
+    return Iterator(doc_, doc_ ? doc_->nodes_[i_].end : 0);
+}
+
+// ===== WRITER =====
+
+void json_escape_to(std::string& out, std::string_view s) {
+    static const char hex[] = "0123456789abcdef";
+    const char* p = s.data();
+    size_t n = s.size();
+    for (;;) {
+        size_t run = plain_run(p, n);
+        out.append(p, run);
+        p += run;
+        n -= run;
+        if (n == 0) return;
+        unsigned char c = (unsigned char)*p++;
+        --n;
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        default:
+            out += "\\u00";
+            out += hex[c >> 4];
+            out += hex[c & 15];
+        }
+    }
+}
+
+JsonWriter& JsonWriter::key(std::string_view k) {
+    separate();
+    out_ += '"';
+    json_escape_to(out_, k);
+    out_ += "\":";
+    comma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view s) {
+    separate();
+    out_.reserve(out_.size() + s.size() + 2);
+    out_ += '"';
+    json_escape_to(out_, s);
+    out_ += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool b) {
+    separate();
+    out_ += b ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double d) {
+    if (!std::isfinite(d)) return null();
+    separate();
+    char buf[32];
+    auto r = std::to_chars(buf, buf + sizeof(buf), d);
+    out_.append(buf, r.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double d, int precision) {
+    if (!std::isfinite(d)) return null();
+    separate();
+    precision = std::clamp(precision, 0, 17);
+    char buf[512];
+    auto r = std::to_chars(buf, buf + sizeof(buf), d, std::chars_format::fixed, precision);
+    out_.append(buf, r.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::integer(int64_t n) {
+    separate();
+    char buf[24];
+    auto r = std::to_chars(buf, buf + sizeof(buf), n);
+    out_.append(buf, r.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::unsigned_integer(uint64_t n) {
+    separate();
+    char buf[24];
+    auto r = std::to_chars(buf, buf + sizeof(buf), n);
+    out_.append(buf, r.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    out_ += "null";
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(std::string_view json) {
+    separate();
+    out_ += json;
+    return *this;
+}
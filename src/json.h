@@ -0,0 +1,172 @@
+#ifndef NEXUS_JSON_H
+#define NEXUS_JSON_H
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Small JSON reader and writer for the web API.
+//
+// JsonDocument::parse() makes one pass over the text and records every value
+// as a node in a flat, pre-order array; each node knows where its subtree
+// ends, so skipping a member is O(1). Strings and numbers are string_views
+// into the parsed text (only strings with escapes are decoded into the
+// document), so the text must outlive the document. A document can be
+// reused; its storage is kept between parses.
+//
+// JsonWriter appends to a caller-owned string, inserting commas itself.
+// Strings are escaped by copying the runs that need no escaping in bulk,
+// found 16 bytes at a time with SSE2 where available.
+
+enum class JsonType : uint8_t { Null, Bool, Number, String, Array, Object };
+
+class JsonDocument;
+
+// Handle to a node of a JsonDocument; valid while the document is unchanged.
+// Lookups that miss return a value for which exists() is false and that
+// reads as null.
+class JsonValue {
+public:
+    JsonValue() = default;
+
+    bool exists() const { return doc_ != nullptr; }
+    JsonType type() const;
+    bool is_null() const { return type() == JsonType::Null; }
+    bool is_bool() const { return type() == JsonType::Bool; }
+    bool is_number() const { return type() == JsonType::Number; }
+    bool is_string() const { return type() == JsonType::String; }
+    bool is_array() const { return type() == JsonType::Array; }
+    bool is_object() const { return type() == JsonType::Object; }
+
+    // The value when it has that type, else the fallback.
+    std::string_view as_string(std::string_view fallback = {}) const;
+    double as_number(double fallback = 0) const;
+    int64_t as_int(int64_t fallback = 0) const;     // integral numbers only
+    bool as_bool(bool fallback = false) const;
+
+    // Elements of an array or members of an object.
+    size_t size() const;
+    JsonValue operator[](size_t i) const;
+    JsonValue operator[](std::string_view key) const;
+    // Member name, for values reached by iterating an object.
+    std::string_view key() const;
+
+    class Iterator {
+    public:
+        JsonValue operator*() const { return JsonValue(doc_, i_); }
+        Iterator& operator++();
+        bool operator==(const Iterator& o) const { return i_ == o.i_; }
+    private:
+        friend class JsonValue;
+        Iterator(const JsonDocument* doc, uint32_t i) : doc_(doc), i_(i) {}
+        const JsonDocument* doc_;
+        uint32_t i_;
+    };
+    Iterator begin() const;
+    Iterator end() const;
+
+private:
+    friend class JsonDocument;
+    JsonValue(const JsonDocument* doc, uint32_t i) : doc_(doc), i_(i) {}
+    const JsonDocument* doc_ = nullptr;
+    uint32_t i_ = 0;
+};
+
+class JsonDocument {
+public:
+    // False on malformed input, trailing garbage or nesting deeper than
+    // max_depth; error() and error_offset() say what and where.
+    bool parse(std::string_view text, size_t max_depth = 64);
+    JsonValue root() const { return nodes_.empty() ? JsonValue() : JsonValue(this, 0); }
+
+    const char* error() const { return error_; }
+    size_t error_offset() const { return error_at_; }
+
+private:
+    friend class JsonValue;
+    struct Node {
+        JsonType type = JsonType::Null;
+        bool boolean = false;
+        uint32_t end = 0;           // one past the last node of the subtree
+        uint32_t count = 0;         // elements or members
+        double number = 0;
+        std::string_view text;      // string contents or number literal
+        std::string_view key;       // member name inside an object
+    };
+
+    bool value(size_t depth);
+    bool string(std::string_view& out);
+    bool number(Node& n);
+    bool fail(const char* why);
+    void skip_ws();
+
+    std::vector<Node> nodes_;
+    std::deque<std::string> decoded_;   // strings that had escapes
+    std::string_view in_;
+    size_t pos_ = 0, max_depth_ = 0;
+    const char* error_ = "";
+    size_t error_at_ = 0;
+};
+
+// Appends `s` with JSON string escaping, without the quotes.
+void json_escape_to(std::string& out, std::string_view s);
+
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) : out_(out) {}
+
+    JsonWriter& begin_object() { open('{'); return *this; }
+    JsonWriter& end_object() { close('}'); return *this; }
+    JsonWriter& begin_array() { open('['); return *this; }
+    JsonWriter& end_array() { close(']'); return *this; }
+    JsonWriter& key(std::string_view k);
+
+    JsonWriter& value(std::string_view s);
+    JsonWriter& value(const char* s) { return value(std::string_view(s)); }
+    JsonWriter& value(const std::string& s) { return value(std::string_view(s)); }
+    JsonWriter& value(bool b);
+    // Shortest round-trip form; NaN and infinities are written as null.
+    JsonWriter& value(double d);
+    // Fixed notation with `precision` decimals.
+    JsonWriter& value(double d, int precision);
+    template <std::integral T>
+        requires(!std::same_as<T, bool>)
+    JsonWriter& value(T n) {
+        if constexpr (std::is_signed_v<T>) return integer((int64_t)n);
+        else return unsigned_integer((uint64_t)n);
+    }
+    JsonWriter& null();
+    // An already serialized value.
+    JsonWriter& raw(std::string_view json);
+
+    template <class T>
+    JsonWriter& field(std::string_view k, const T& v) { return key(k).value(v); }
+    JsonWriter& field(std::string_view k, double d, int precision) { return key(k).value(d, precision); }
+
+private:
+    void separate() {
+        if (comma_) out_ += ',';
+        comma_ = true;
+    }
+    void open(char c) {
+        separate();
+        out_ += c;
+        comma_ = false;
+    }
+    void close(char c) {
+        out_ += c;
+        comma_ = true;
+    }
+    JsonWriter& integer(int64_t n);
+    JsonWriter& unsigned_integer(uint64_t n);
+
+    std::string& out_;
+    bool comma_ = false;
+};
+
+#endif
@@ -0,0 +1,333 @@
+#include "learning_log.h"
+#include "state.h"
+#include "snapshot.h"
+#include "config.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+// ===== RECORD FORMAT =====
+// A fixed header followed by `size` bytes of text. The checksum covers both,
+// so a record torn by a crash mid-write ends the log on recovery.
+
+namespace {
+constexpr uint32_t WAL_MAGIC = 0x4C57584E;      // "NXWL"
+constexpr size_t GROUP_BYTES = 64 * 1024;       // commit early once this much is buffered
+
+struct WalRecordHeader {
+    uint32_t magic;
+    uint32_t size;
+    uint64_t lsn;
+    uint64_t seed;
+    int64_t arg;
+    double value;
+    uint32_t kind;
+    uint32_t pad;
+    uint64_t checksum;
+};
+static_assert(sizeof(WalRecordHeader) == 56);
+
+uint64_t record_checksum(WalRecordHeader h, const char* text) {
+    h.checksum = 0;
+    return snapshot_checksum(text, h.size, snapshot_checksum(&h, sizeof(h)));
+}
+
+void encode(string& out, const LearningEvent& e, string_view text) {
+    WalRecordHeader h{WAL_MAGIC, (uint32_t)text.size(), e.lsn, e.seed, e.arg, e.value, (uint32_t)e.kind, 0, 0};
+    h.checksum = record_checksum(h, text.data());
+    out.append(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.append(text);
+}
+
+size_t record_size(const LearningEvent& e) { return sizeof(WalRecordHeader) + e.text.size(); }
+
+// Valid records from the start of `data`; `good` is set to the end of the
+// last one.
+vector<LearningEvent> decode(const string& data, size_t& good) {
+    vector<LearningEvent> events;
+    size_t pos = 0;
+    while (pos + sizeof(WalRecordHeader) <= data.size()) {
+        WalRecordHeader h;
+        memcpy(&h, data.data() + pos, sizeof(h));
+        if (h.magic != WAL_MAGIC || h.size > data.size() - pos - sizeof(h)) break;
+        const char* text = data.data() + pos + sizeof(h);
+        if (record_checksum(h, text) != h.checksum) break;
+        events.push_back({h.lsn, (LearningEventKind)h.kind, h.seed, h.arg, h.value, string(text, h.size)});
+        pos += sizeof(h) + h.size;
+    }
+    good = pos;
+    return events;
+}
+
+string read_file(const string& path) {
+    ifstream in(path, ios::binary);
+    return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+// ===== LOG STATE =====
+
+struct LogState {
+    std::mutex mutex;            // everything below except `file`
+    std::mutex io;               // `file`; taken before `mutex` when both are needed
+    std::condition_variable wake, committed;
+    FILE* file = nullptr;
+    bool open = false, replaying = false, stopping = false;
+    string snapshot, path, sync = "none";
+    string buffer;
+    uint64_t next_lsn = 1, buffered_lsn = 0, durable_lsn = 0, covered_lsn = 0;
+    size_t waiters = 0;          // record() calls blocked on a synced commit
+    std::thread writer;
+    std::map<LearningEventKind, LearningLog::Handler> handlers;
+    LearningLogStats stats;
+
+    ~LogState() { stop(); }
+
+    void stop();
+};
+LogState& log_state() {
+    static LogState st;
+    return st;
+}
+
+// Writes everything buffered as one group. Caller holds st.io.
+void commit_pending(LogState& st) {
+    string batch;
+    uint64_t upto;
+    {
+        std::lock_guard<std::mutex> lock(st.mutex);
+        if (st.buffer.empty()) return;
+        batch.swap(st.buffer);
+        upto = st.buffered_lsn;
+    }
+    bool ok = st.file && fwrite(batch.data(), 1, batch.size(), st.file) == batch.size() && fflush(st.file) == 0;
+    if (ok && st.sync != "none") ok = snapshot_sync(st.file);
+    if (!ok) cerr << "Learning log " << st.path << ": write of " << batch.size() << " bytes failed" << endl;
+
+    std::lock_guard<std::mutex> lock(st.mutex);
+    // Waiters are released either way; a failed group is reported, not retried
+    st.durable_lsn = upto;
+    st.stats.commits++;
+    st.committed.notify_all();
+}
+
+void writer_loop(LogState& st, std::chrono::milliseconds interval) {
+    std::unique_lock<std::mutex> lock(st.mutex);
+    while (!st.stopping) {
+        st.wake.wait_for(lock, interval, [&] {
+            return st.stopping || st.buffer.size() >= GROUP_BYTES || (st.waiters > 0 && !st.buffer.empty());
+        });
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> io(st.io);
+            commit_pending(st);
+        }
+        lock.lock();
+    }
+}
+
+void LogState::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (writer.joinable()) writer.join();
+    std::lock_guard<std::mutex> io_lock(io);
+    commit_pending(*this);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file) fclose(file);
+    file = nullptr;
+    open = false;
+    stopping = false;
+    committed.notify_all();
+}
+}
+
+// ===== ENTRY POINTS =====
+
+void LearningLog::on(LearningEventKind kind, Handler handler) {
+    LogState& st = log_state();
+    std::lock_guard<std::mutex> lock(st.mutex);
+    st.handlers[kind] = std::move(handler);
+}
+
+size_t LearningLog::recover(const string& snapshot, bool have_base) {
+    LogState& st = log_state();
+    st.stop();
+    const NexusConfig& cfg = NexusConfig::get();
+    string path = snapshot + ".wal";
+    std::error_code ec;
+
+    string data = read_file(path);
+    size_t good = 0;
+    vector<LearningEvent> events = decode(data, good);
+    if (good < data.size()) {
+        cerr << "Learning log " << path << ": dropping damaged tail (" << data.size() - good << " bytes)" << endl;
+        fs::resize_file(path, good, ec);
+    }
+    uint64_t max_lsn = 0;
+    for (const LearningEvent& e : events) max_lsn = max(max_lsn, e.lsn);
+
+    size_t replayed = 0;
+    if (!have_base) {
+        if (!events.empty()) {
+            cerr << "Learning log " << path << ": no snapshot to replay " << events.size()
+                 << " events onto, discarding" << endl;
+            fs::resize_file(path, 0, ec);
+        }
+    } else {
+        uint64_t covered;
+        {
+            std::lock_guard<std::mutex> lock(st.mutex);
+            st.replaying = true;
+            covered = st.covered_lsn;
+        }
+        for (const LearningEvent& e : events) {
+            if (e.lsn <= covered) continue;
+            auto it = st.handlers.find(e.kind);
+            if (it == st.handlers.end()) continue;
+            rng.seed((uint32_t)e.seed);
+            try {
+                it->second(e);
+                replayed++;
+            } catch (const exception& ex) {
+                cerr << "Learning log: replay of event " << e.lsn << " failed: " << ex.what() << endl;
+            }
+        }
+        if (replayed) cout << "[Learning log: replayed " << replayed << " events from " << path << "]\n";
+    }
+
+    std::lock_guard<std::mutex> lock(st.mutex);
+    st.replaying = false;
+    st.next_lsn = max({st.next_lsn, max_lsn + 1, st.covered_lsn + 1});
+    st.buffered_lsn = st.durable_lsn = st.next_lsn - 1;
+    st.stats.replayed += replayed;
+    if (!cfg.learning_log) return replayed;
+
+    st.file = fopen(path.c_str(), "ab");
+    if (!st.file) {
+        cerr << "Learning log: cannot open " << path << " for append, learning events will not be logged" << endl;
+        return replayed;
+    }
+    st.open = true;
+    st.snapshot = snapshot;
+    st.path = path;
+    st.sync = cfg.learning_log_sync == "batch" || cfg.learning_log_sync == "always" ? cfg.learning_log_sync : "none";
+    st.writer = std::thread(writer_loop, std::ref(st), std::chrono::milliseconds(max<size_t>(1, cfg.learning_log_flush_ms)));
+    return replayed;
+}
+
+uint64_t LearningLog::record(LearningEventKind kind, string_view text, int64_t arg, double value) {
+    LogState& st = log_state();
+    std::unique_lock<std::mutex> lock(st.mutex);
+    if (!st.open || st.replaying) return 0;
+    LearningEvent e;
+    e.lsn = st.next_lsn++;
+    e.kind = kind;
+    e.seed = rng();
+    e.arg = arg;
+    e.value = value;
+    rng.seed((uint32_t)e.seed);
+    encode(st.buffer, e, text);
+    st.buffered_lsn = e.lsn;
+    st.stats.events++;
+
+    if (st.sync == "always") {
+        st.waiters++;
+        st.wake.notify_one();
+        st.committed.wait(lock, [&] { return st.durable_lsn >= e.lsn || !st.open; });
+        st.waiters--;
+    } else if (st.buffer.size() >= GROUP_BYTES) {
+        st.wake.notify_one();
+    }
+    return e.lsn;
+}
+
+void LearningLog::flush() {
+    LogState& st = log_state();
+    std::lock_guard<std::mutex> io(st.io);
+    commit_pending(st);
+}
+
+void LearningLog::truncate(const string& snapshot, uint64_t covered) {
+    LogState& st = log_state();
+    std::lock_guard<std::mutex> io(st.io);
+    {
+        std::lock_guard<std::mutex> lock(st.mutex);
+        if (!st.open || snapshot != st.snapshot) return;
+        st.covered_lsn = max(st.covered_lsn, covered);
+    }
+    commit_pending(st);
+
+    // Usually everything is covered and the log just empties; events logged
+    // while the checkpoint was being written carry over
+    string data = read_file(st.path);
+    size_t good = 0;
+    vector<LearningEvent> events = decode(data, good);
+    size_t offset = 0;
+    for (const LearningEvent& e : events) {
+        if (e.lsn > covered) break;
+        offset += record_size(e);
+    }
+    if (offset == 0) return;
+
+    string tmp = st.path + ".tmp";
+    FILE* out = fopen(tmp.c_str(), "wb");
+    bool ok = out && fwrite(data.data() + offset, 1, good - offset, out) == good - offset;
+    if (out) {
+        ok = snapshot_sync(out) && ok;
+        fclose(out);
+    }
+    std::error_code ec;
+    if (!ok) {
+        cerr << "Learning log: cannot rewrite " << st.path << ", keeping covered events" << endl;
+        fs::remove(tmp, ec);
+        return;
+    }
+    fclose(st.file);
+    fs::rename(tmp, st.path, ec);
+    st.file = fopen(st.path.c_str(), "ab");
+
+    std::lock_guard<std::mutex> lock(st.mutex);
+    if (!st.file) {
+        cerr << "Learning log: cannot reopen " << st.path << ", learning events will not be logged" << endl;
+        st.open = false;
+        st.committed.notify_all();
+    }
+    st.stats.truncations++;
+}
+
+uint64_t LearningLog::last_lsn() {
+    LogState& st = log_state();
+    std::lock_guard<std::mutex> lock(st.mutex);
+    return st.next_lsn - 1;
+}
+
+void LearningLog::set_covered(uint64_t lsn) {
+    LogState& st = log_state();
+    std::lock_guard<std::mutex> lock(st.mutex);
+    st.covered_lsn = lsn;
+    st.next_lsn = max(st.next_lsn, lsn + 1);
+}
+
+LearningLogStats LearningLog::stats() {
+    LogState& st = log_state();
+    std::lock_guard<std::mutex> lock(st.mutex);
+    LearningLogStats s = st.stats;
+    s.open = st.open;
+    s.sync = st.sync;
+    s.last_lsn = st.next_lsn - 1;
+    s.durable_lsn = st.durable_lsn;
+    s.covered_lsn = st.covered_lsn;
+    s.pending_bytes = st.buffer.size();
+    return s;
+}
+
+void LearningLog::close() { log_state().stop(); }
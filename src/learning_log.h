@@ -0,0 +1,93 @@
+#ifndef LEARNING_LOG_H
+#define LEARNING_LOG_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// Write-ahead log of learning events.
+//
+// Everything that teaches the model outside the autonomous tick (chat input,
+// corpus lines, sampled word and concept learning, neuron mutation, manual
+// decay) is recorded here before it is applied. Each event carries a sequence
+// number (LSN) and the seed the shared RNG was reset to, so replaying it on
+// the same model repeats the same random draws.
+//
+// "<snapshot>.wal" holds the events in LSN order. Appends go to an in-memory
+// buffer; a writer thread commits the buffer as one write every
+// NEXUS_LEARNING_LOG_FLUSH_MS, or sooner once it fills. With
+// NEXUS_LEARNING_LOG_SYNC=batch each commit is fsynced, with =always
+// record() also waits for its commit (concurrent callers share one fsync);
+// the default, none, leaves syncing to the OS.
+//
+// Snapshots store the last LSN they cover (WAL_LSN in the meta section).
+// recover() replays the events past it on top of the loaded snapshot, and
+// truncate() drops the covered prefix once a checkpoint is durable.
+
+enum class LearningEventKind : uint32_t {
+    Chat = 1,           // text: message, via the API (logs from before ChatBatch)
+    Dialog,             // text: message, via the terminal input box
+    CorpusLine,         // text: corpus line, arg: sentence index
+    LearnWord,          // text: word, value: concept value
+    ConceptFormation,   // text: name then words, '\n'-separated
+    Mutation,           // mutateN()
+    Decay,              // comprehensive_system_decay()
+    ChatBatch,          // text: chat messages learned in one tick, one per line
+    ClearHistory,       // clearHistory(), via POST /api/clear
+};
+
+struct LearningEvent {
+    uint64_t lsn = 0;
+    LearningEventKind kind = LearningEventKind::Chat;
+    uint64_t seed = 0;
+    int64_t arg = 0;
+    double value = 0;
+    std::string text;
+};
+
+struct LearningLogStats {
+    bool open = false;
+    std::string sync;
+    uint64_t last_lsn = 0;          // last LSN handed out
+    uint64_t durable_lsn = 0;       // last LSN written to the file
+    uint64_t covered_lsn = 0;       // last LSN in the loaded or saved snapshot
+    uint64_t pending_bytes = 0;     // buffered, not yet committed
+    uint64_t commits = 0, events = 0, replayed = 0, truncations = 0;
+};
+
+class LearningLog {
+public:
+    using Handler = std::function<void(const LearningEvent&)>;
+
+    // Replay action for one kind of event.
+    static void on(LearningEventKind kind, Handler handler);
+
+    // Opens "<snapshot>.wal" for appending, dropping a torn tail. With
+    // `have_base` the events past the covered LSN are replayed; without one
+    // (fresh start) there is nothing to replay them onto and they are
+    // discarded. Returns the number of events replayed.
+    static size_t recover(const std::string& snapshot, bool have_base);
+
+    // Logs an event and reseeds the shared RNG with the seed stored in it.
+    // Returns its LSN, or 0 when the log is closed or replaying.
+    static uint64_t record(LearningEventKind kind, std::string_view text = {}, int64_t arg = 0, double value = 0);
+
+    // Commits buffered events now.
+    static void flush();
+
+    // Drops events up to `covered` once a checkpoint of `snapshot` holding
+    // them is durable.
+    static void truncate(const std::string& snapshot, uint64_t covered);
+
+    static uint64_t last_lsn();
+    // Called while loading a snapshot with the LSN it covers.
+    static void set_covered(uint64_t lsn);
+
+    static LearningLogStats stats();
+
+    // Commits what is buffered and stops the writer.
+    static void close();
+};
+
+#endif
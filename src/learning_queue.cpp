@@ -0,0 +1,87 @@
+#include "learning_queue.h"
+#include "config.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace {
+std::mutex queue_mutex;
+std::condition_variable space;      // pushers waiting for a drain
+std::condition_variable learned;    // wait() callers
+std::deque<std::vector<std::string>> queue;
+uint64_t next_ticket = 1;
+uint64_t released = 0;
+bool closed = false;
+LearningQueueStats counters;
+
+size_t capacity() {
+    return std::max<size_t>(1, NexusConfig::get().chat_queue);
+}
+}
+
+uint64_t LearningQueue::push(std::vector<std::string> words) {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    if (!closed && queue.size() >= capacity()) {
+        counters.full_waits++;
+        space.wait(lock, [] { return closed || queue.size() < capacity(); });
+    }
+    if (closed) return 0;
+    queue.push_back(std::move(words));
+    counters.pushed++;
+    counters.max_depth = std::max(counters.max_depth, queue.size());
+    return next_ticket++;
+}
+
+void LearningQueue::wait(uint64_t ticket) {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    learned.wait(lock, [&] { return closed || released >= ticket; });
+}
+
+LearningBatch LearningQueue::take() {
+    LearningBatch batch;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (queue.empty()) return batch;
+        batch.messages.assign(std::make_move_iterator(queue.begin()), std::make_move_iterator(queue.end()));
+        queue.clear();
+        batch.last = next_ticket - 1;
+        counters.batches++;
+        counters.learned += batch.messages.size();
+    }
+    space.notify_all();
+    return batch;
+}
+
+void LearningQueue::release(uint64_t through) {
+    if (through == 0) return;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        released = std::max(released, through);
+    }
+    learned.notify_all();
+}
+
+void LearningQueue::record_batch(size_t messages, size_t tokens, double ms) {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    counters.last_batch = messages;
+    counters.last_batch_tokens = tokens;
+    counters.last_batch_ms = ms;
+}
+
+LearningQueueStats LearningQueue::stats() {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    LearningQueueStats s = counters;
+    s.depth = queue.size();
+    s.capacity = capacity();
+    return s;
+}
+
+void LearningQueue::close() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        closed = true;
+    }
+    space.notify_all();
+    learned.notify_all();
+}
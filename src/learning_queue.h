@@ -0,0 +1,59 @@
+#ifndef LEARNING_QUEUE_H
+#define LEARNING_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Chat input waiting to be learned.
+//
+// API threads push the tokenized message and answer from the published
+// model right away; the loop takes everything queued at its next tick
+// boundary and learns it as one batch (see learnChatBatch in main.cpp). The
+// queue is bounded by NEXUS_CHAT_QUEUE: a push into a full queue waits for
+// the next drain, so a burst of chats slows down instead of growing memory.
+//
+// With NEXUS_CHAT_LEARNING=before a caller waits for the view that includes
+// its message before replying, which is what every chat did before the
+// queue existed.
+
+struct LearningBatch {
+    std::vector<std::vector<std::string>> messages;    // in push order
+    uint64_t last = 0;                                  // ticket of the newest message
+};
+
+struct LearningQueueStats {
+    size_t depth = 0, capacity = 0;
+    size_t max_depth = 0;           // deepest the queue has been
+    uint64_t pushed = 0;
+    uint64_t batches = 0;           // non-empty drains
+    uint64_t learned = 0;           // messages taken by the loop
+    uint64_t full_waits = 0;        // pushes that found the queue full
+    size_t last_batch = 0;          // messages in the latest batch
+    size_t last_batch_tokens = 0;   // distinct tokens in it
+    double last_batch_ms = 0;       // learning time for it
+};
+
+class LearningQueue {
+public:
+    // Queues a message; waits while the queue is full. Returns its ticket,
+    // 0 once the queue is closed.
+    static uint64_t push(std::vector<std::string> words);
+    // Returns once the batch holding `ticket` is learned and published, or
+    // the queue is closed.
+    static void wait(uint64_t ticket);
+
+    // Loop thread, at the tick boundary: everything queued so far.
+    static LearningBatch take();
+    // Loop thread, after the view including the batch is published.
+    static void release(uint64_t through);
+    static void record_batch(size_t messages, size_t tokens, double ms);
+
+    static LearningQueueStats stats();
+
+    // Loop thread, on exit: wakes and fails pushers and waiters.
+    static void close();
+};
+
+#endif
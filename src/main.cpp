@@ -16,6 +16,19 @@
 #include "struct.h"
 #include "web_server.h"
 #include "agi_api.h"
+#include "thread_pool.h"
+#include "config.h"
+#include "neural_engine.h"
+#include "persistence.h"
+#include "text_state.h"
+#include "learning_log.h"
+#include "bootstrap_model.h"
+#include "prune_rules.h"
+#include "memory_accounting.h"
+#include "model_snapshot.h"
+#include "learning_queue.h"
+#include "status_snapshot.h"
+#include "model_changes.h"
 #include <map>
 #include <set>
 #include <cstring>
@@ -24,6 +37,7 @@
 #include <functional>
 #include <memory>
 #include <deque>
+#include <bit>
 #include <vector>
 #include <cmath>
 #include <cstdlib>
@@ -55,7 +69,8 @@ vector<string> sentence_templates = {
 };
 
 random_device rd;
-mt19937 rng(rd());
+// One engine per thread; see model_snapshot.h
+thread_local mt19937 rng(rd());
 
 
 
@@ -67,16 +82,16 @@ vector<double>eh_hist,vh_hist;int qe,te,ce,pe,ne;double bh;
 double al,emerge_out1,emerge_behavior,sentience_ratio,env_oute,sensory_env;
 int total_neurons_ever;double current_valence,attention_focus,metacognitive_awareness;
 vector<double>valence_history;int peak_sentience_gen;string user_input,dialog_response;int dialog_timer;
-State S,BK;
+State S;
+UndoLog undo_log;
 WorkingMemory WM(32);
-map<string,TokenConceptEmbedding> token_concept_embedding_map;
+SampledMap<string,TokenConceptEmbedding> token_concept_embedding_map;
 map<string,Goal> goal_system;
 WorldModel world_model;
 ActionPlan current_plan;
 ConsciousnessState consciousness;
 vector<TransformerHead> transformer_heads;
 TransferLearningModule transfer_module;
-std::mutex learning_mutex;
 deque<string> recent_generations;  // Last N generated sentences
 const int MAX_RECENT_TRACK = 20;   // Track last 20 generations
 map<string, int> generation_counts; // Count how many times each sentence generated
@@ -114,9 +129,6 @@ void generate_qualia(const string& type,double intensity,double valence){
         q.phenomenal_unity=consciousness.integrated_information;
         
         consciousness.active_qualia.push_back(q);
-        if(consciousness.active_qualia.size()>10) {
-            consciousness.active_qualia.erase(consciousness.active_qualia.begin());
-        }
     } catch(const exception& e) {
         // Qualia generation failed silently
         cerr << "Qualia generation error: " << e.what() << endl;
@@ -223,7 +235,7 @@ double getGrammarScore(const string& prev_word, const string& current_word, int
 }
 
 
-double calculateTokenScore(const string& prev_word, const string& prev_prev_word,
+double calculateTokenScore(const ModelView& model, const string& prev_word, const string& prev_prev_word,
                            const string& candidate, int position,
                            const vector<double>& attention_context,
                            const set<string>& used_tokens) {
@@ -231,18 +243,14 @@ double calculateTokenScore(const string& prev_word, const string& prev_prev_word
     double score = 0.0;
     
     // === 1. TRIGRAM (HIGHEST PRIORITY - LEARNED PATTERNS DOMINATE) ===
-    if(!prev_prev_word.empty() && trigram_counts.count(prev_prev_word)) {
-        if(trigram_counts[prev_prev_word].count(prev_word)) {
-            if(trigram_counts[prev_prev_word][prev_word].count(candidate)) {
-                int count = trigram_counts[prev_prev_word][prev_word][candidate];
-                score += log(1 + count) * 15.0;  // HIGHEST - natural language flow
-            }
+    if(!prev_prev_word.empty()) {
+        if(int count = model.trigram(prev_prev_word, prev_word, candidate)) {
+            score += log(1 + count) * 15.0;  // HIGHEST - natural language flow
         }
     }
     
     // === 2. BIGRAM (SECOND PRIORITY) ===
-    if(bigram_counts.count(prev_word) && bigram_counts[prev_word].count(candidate)) {
-        int count = bigram_counts[prev_word][candidate];
+    if(int count = model.bigram(prev_word, candidate)) {
         score += log(1 + count) * 10.0;  // Strong learned pattern signal
     }
     
@@ -251,22 +259,21 @@ double calculateTokenScore(const string& prev_word, const string& prev_prev_word
     score += grammar * 3.0;  // Reduced from 10.0 - grammar assists, doesn't dominate
     
     // === 4. SEMANTIC COHERENCE ===
-    if(token_concept_embedding_map.count(candidate)) {
-        auto& tce = token_concept_embedding_map[candidate];
-        
+    const ModelView::Token* tce = model.token(candidate);
+    if(tce) {
         // Attention alignment
-        for(size_t i=0; i<attention_context.size() && i<tce.embedding.size(); i++) {
-            score += attention_context[i] * tce.embedding[i] * 0.6;
+        for(size_t i=0; i<attention_context.size() && i<tce->embedding.size(); i++) {
+            score += attention_context[i] * tce->embedding[i] * 0.6;
         }
         
         // Meaning and grounding
-        score += tce.meaning * 0.5;
-        score += tce.grounding_value * 0.3;
+        score += tce->meaning * 0.5;
+        score += tce->grounding * 0.3;
     }
     
     // === 5. FREQUENCY WEIGHTING (encourage learned vocabulary) ===
-    if(token_concept_embedding_map.count(candidate)) {
-        double freq = token_concept_embedding_map[candidate].freq;
+    if(tce) {
+        double freq = tce->freq;
         if(freq > 0) {
             score += log(1 + freq) * 2.0;  // Bonus for known words
         }
@@ -307,7 +314,7 @@ double calculateTokenScore(const string& prev_word, const string& prev_prev_word
     return score;
 }
 
-string generate_with_beam_search(string seed, int max_length, 
+string generate_with_beam_search(const ModelView& model, string seed, int max_length,
                                   const vector<double>& attention_context,
                                   int beam_width = 256) {  // Increased from 16
     
@@ -325,8 +332,8 @@ string generate_with_beam_search(string seed, int max_length,
         string best_word = "i";
         
         for(const string& gs : good_starts) {
-            if(token_concept_embedding_map.count(gs)) {
-                int freq = token_concept_embedding_map[gs].freq;
+            if(const ModelView::Token* t = model.token(gs)) {
+                int freq = t->freq;
                 if(freq > best_freq) {
                     best_freq = freq;
                     best_word = gs;
@@ -358,10 +365,10 @@ string generate_with_beam_search(string seed, int max_length,
             // Get top candidates for next token
             vector<pair<string, double>> next_candidates;
             
-            for(auto& p : token_concept_embedding_map) {
-                if(p.second.freq > 2) {
+            for(auto& p : model.tokens) {
+                if(p.second->freq > 2) {
                     double score = calculateTokenScore(
-                        prev, prev_prev, p.first, 
+                        model, prev, prev_prev, p.first, 
                         candidate.tokens.size(), 
                         attention_context, used
                     );
@@ -654,6 +661,7 @@ void propagate_throughout_system(const string& source, double activation, int de
     tce.meaning = clamp_valence(tce.meaning);
     tce.qualia_intensity = min(0.3, tce.qualia_intensity + activation*0.03);
     align_embedding_to_valence(tce, S.current_valence);
+    token_concept_embedding_map.touch(tce_it);
     
     // Generate qualia from concept activation - WRAP IN TRY-CATCH
     if(tce.qualia_intensity > 0.3){
@@ -751,7 +759,7 @@ vector<double> compute_attention(const vector<double>& query, const vector<strin
 
 
 
-string generateFromTemplate() {
+string generateFromTemplate(const ModelView& model) {
     if(sentence_templates.empty()) {
         return "i am learning";  // Fallback
     }
@@ -761,18 +769,13 @@ string generateFromTemplate() {
     
     // === REPLACE {concept} PLACEHOLDERS ===
     while(templ.find("{concept}") != string::npos) {
-        vector<string> concept_list;
-        
         // Gather concepts with decent values
-        for(auto& p : S.concepts) {
-            if(p.second.value > 0.3) {
-                concept_list.push_back(p.first);
-            }
-        }
+        vector<string> concept_list;
+        for(auto& c : model.strong_concepts) concept_list.push_back(c.first);
         
         // Also add high-frequency tokens as concepts
-        for(auto& p : token_concept_embedding_map) {
-            if(p.second.freq > 5 && p.second.grounding_value > 0.4) {
+        for(auto& p : model.tokens) {
+            if(p.second->freq > 5 && p.second->grounding > 0.4) {
                 string pos = getPartOfSpeech(p.first);
                 if(pos == "NOUN" || pos == "CONTENT") {
                     concept_list.push_back(p.first);
@@ -799,8 +802,8 @@ string generateFromTemplate() {
         vector<string> action_list;
         
         // Gather verbs from vocabulary
-        for(auto& p : token_concept_embedding_map) {
-            if(p.second.freq > 3) {
+        for(auto& p : model.tokens) {
+            if(p.second->freq > 3) {
                 string pos = getPartOfSpeech(p.first);
                 if(pos == "VERB") {
                     action_list.push_back(p.first);
@@ -828,8 +831,8 @@ string generateFromTemplate() {
         vector<string> adj_list;
         
         // Gather adjectives from vocabulary
-        for(auto& p : token_concept_embedding_map) {
-            if(p.second.freq > 2) {
+        for(auto& p : model.tokens) {
+            if(p.second->freq > 2) {
                 string pos = getPartOfSpeech(p.first);
                 if(pos == "ADJECTIVE") {
                     adj_list.push_back(p.first);
@@ -843,10 +846,10 @@ string generateFromTemplate() {
         } else {
             // Default adjectives - vary based on current state
             vector<string> defaults;
-            if(S.current_valence > 0.5) {
+            if(model.valence > 0.5) {
                 defaults = {"conscious", "aware", "intelligent", "coherent", 
                            "integrated", "learning", "growing", "improving"};
-            } else if(S.current_valence > 0) {
+            } else if(model.valence > 0) {
                 defaults = {"processing", "analyzing", "developing", "adapting",
                            "evolving", "curious", "active", "thinking"};
             } else {
@@ -964,6 +967,7 @@ string generateContextualTemplate(const string& context_hint) {
 // ==== WORLD MODEL & PLANNING ====
 void update_world_model(const string& entity, double state_value) {
     world_model.entity_states[entity] = state_value;
+    ModelChanges::mark(ModelStore::WorldEntities, entity);
     world_model.updates++;
     double accuracy_delta = fabs(state_value - S.current_valence) * 0.01;
     world_model.model_accuracy = max(0.0, min(1.0, world_model.model_accuracy + accuracy_delta));
@@ -971,6 +975,7 @@ void update_world_model(const string& entity, double state_value) {
 
 void establish_causal_relationship(const string& cause, const string& effect, double strength) {
     world_model.relationships[cause][effect] = strength;
+    ModelChanges::mark(ModelStore::WorldRelations, cause);
     world_model.causal_weights[cause + "->" + effect] = strength;
 }
 
@@ -1055,12 +1060,14 @@ void learnWord(const string& word, double concept_value) {
     if(bigram_counts.size() > 15000) {
         auto it = bigram_counts.begin();
         for(int i = 0; i < 100 && it != bigram_counts.end(); i++) {
+            ModelChanges::mark(ModelStore::Bigrams, it->first);
             it = bigram_counts.erase(it);
         }
     }
     if(trigram_counts.size() > 7500) {
         auto it = trigram_counts.begin();
         for(int i = 0; i < 50 && it != trigram_counts.end(); i++) {
+            for(auto& row : it->second) ModelChanges::mark(ModelStore::Trigrams, it->first, row.first);
             it = trigram_counts.erase(it);
         }
     }
@@ -1079,7 +1086,7 @@ void learnWord(const string& word, double concept_value) {
         tce.meaning = rn(); 
         tce.embedding.resize(16);
         for(int i = 0; i < 16; i++) tce.embedding[i] = rn() * 0.1;
-        token_concept_embedding_map[lower_word] = tce;
+        token_concept_embedding_map.try_emplace(lower_word, std::move(tce));
     }
     
     // Safe operations - get reference only after confirming existence
@@ -1087,11 +1094,12 @@ void learnWord(const string& word, double concept_value) {
     if(tce_it == token_concept_embedding_map.end()) return;
     
     tce_it->second.freq++;
+    token_concept_embedding_map.touch(tce_it);
     tce_it->second.meaning += concept_value * 0.01;
     tce_it->second.meaning = clamp_valence(tce_it->second.meaning);
     
     align_embedding_to_valence(tce_it->second, S.current_valence);
-    tce_it->second.linked_valences["current"] = S.current_valence;
+    tce_it->second.linked_valences.current = S.current_valence;
     
     // 4. System Propagation
     try {
@@ -1102,12 +1110,14 @@ void learnWord(const string& word, double concept_value) {
     }
     
     // 5. Update System State (S.tokens)
-    if(S.tokens.find(lower_word) != S.tokens.end()) {
-        S.tokens[lower_word].freq++;
-        S.tokens[lower_word].meaning += concept_value * 0.01;
+    auto tok_it = S.tokens.find(lower_word);
+    if(tok_it != S.tokens.end()) {
+        tok_it->second.freq++;
+        tok_it->second.meaning += concept_value * 0.01;
+        S.tokens.touch(tok_it);
     } else {
         Token t = {lower_word, concept_value, 1, vector<int>(), 4, 0.5};
-        S.tokens[lower_word] = t;
+        S.tokens.try_emplace(lower_word, std::move(t));
     }
     
     // 6. Final World Model Update
@@ -1140,9 +1150,11 @@ void processNGramsFromTokens(const vector<string>& tokens) {
             if(w1_it != bigram_counts.end()) {
                 if(w1_it->second.size() < 500) {
                     w1_it->second[w2]++;
+                    ModelChanges::mark(ModelStore::Bigrams, w1);
                 }
             } else {
                 bigram_counts[w1][w2] = 1;
+                ModelChanges::mark(ModelStore::Bigrams, w1);
             }
             
             // Bidirectional embedding links
@@ -1153,9 +1165,11 @@ void processNGramsFromTokens(const vector<string>& tokens) {
                tce2 != token_concept_embedding_map.end()) {
                 if(tce1->second.linked_concepts.size() < 200) {
                     tce1->second.linked_concepts[w2] += 0.1;
+                    token_concept_embedding_map.touch(tce1);
                 }
                 if(tce2->second.linked_concepts.size() < 200) {
                     tce2->second.linked_concepts[w1] += 0.05;
+                    token_concept_embedding_map.touch(tce2);
                 }
             }
         } catch(...) {
@@ -1190,6 +1204,7 @@ void processNGramsFromTokens(const vector<string>& tokens) {
             
             if(can_insert) {
                 trigram_counts[w1][w2][w3]++;
+                ModelChanges::mark(ModelStore::Trigrams, w1, w2);
                 
                 auto tce1 = token_concept_embedding_map.find(w1);
                 auto tce3 = token_concept_embedding_map.find(w3);
@@ -1198,6 +1213,7 @@ void processNGramsFromTokens(const vector<string>& tokens) {
                    tce3 != token_concept_embedding_map.end()) {
                     if(tce1->second.linked_concepts.size() < 200) {
                         tce1->second.linked_concepts[w3] += 0.05;
+                        token_concept_embedding_map.touch(tce1);
                     }
                 }
             }
@@ -1250,6 +1266,7 @@ void processNGramsFromTokens(const vector<string>& tokens) {
                 tce_it->second.semantic_stability + pattern_count * 0.001);
             tce_it->second.grounding_value = min(1.0, 
                 tce_it->second.grounding_value + 0.01);
+            token_concept_embedding_map.touch(tce_it);
         } catch(...) {
             continue;
         }
@@ -1270,20 +1287,14 @@ void processNGramsFromTokens(const vector<string>& tokens) {
     }
 }
 
-// ==== FIXED generateResponse() - Proper Flow ====
-string generateResponse(const string& input) {
-    // Make local copy
-    string safe_input = input;
-    
-    // Validate
-    if(safe_input.empty() || safe_input.length() > 1500) {
-        return "[NEXUS]: ...";
-    }
-    
-    // Tokenize safely
+// ==== RESPONSE GENERATION ====
+// Chat input: normalized words, at most 150; empty when the input is empty
+// or longer than 1500 characters.
+vector<string> tokenizeChatInput(const string& input) {
     vector<string> words;
+    if(input.empty() || input.length() > 1500) return words;
     words.reserve(150);
-    stringstream ss(safe_input);
+    stringstream ss(input);
     string word;
     
     while(ss >> word && words.size() < 150) {
@@ -1300,63 +1311,55 @@ string generateResponse(const string& input) {
             words.push_back(normalized);
         }
     }
-    
-    if(words.empty()) {
-        return "[NEXUS]: ...";
-    }
-    
-    try {
-        // STEP 1: Learn individual words (builds vocabulary)
-        for(const string& w : words) {
-            learnWord(w, S.current_valence);
-        }
-        
-        // STEP 2: Learn sequential patterns (builds grammar)
-        processNGramsFromTokens(words);
-        
-    } catch(const exception& e) {
-        cerr << "Learning error: " << e.what() << endl;
-        return "[NEXUS]: Processing error";
+    return words;
+}
+
+// Loop thread.
+void learnChatInput(const vector<string>& words) {
+    // STEP 1: Learn individual words (builds vocabulary)
+    for(const string& w : words) {
+        learnWord(w, S.current_valence);
     }
     
+    // STEP 2: Learn sequential patterns (builds grammar)
+    processNGramsFromTokens(words);
+}
+
+// Reads only `model`, so any thread can generate while the loop runs.
+string replyFromModel(const ModelView& model, const vector<string>& words) {
     // Build attention context
     vector<double> attention_context(16, 0.0);
-    try {
-        for(const string& w : words) {
-            auto it = token_concept_embedding_map.find(w);
-            if(it != token_concept_embedding_map.end()) {
-                for(int i = 0; i < 16 && i < (int)it->second.embedding.size(); i++) {
-                    attention_context[i] += it->second.embedding[i];
-                }
+    for(const string& w : words) {
+        if(const ModelView::Token* t = model.token(w)) {
+            for(int i = 0; i < 16 && i < (int)t->embedding.size(); i++) {
+                attention_context[i] += t->embedding[i];
             }
         }
-        
-        // Normalize
-        double attn_sum = 0;
-        for(double a : attention_context) attn_sum += fabs(a);
-        if(attn_sum > 0.001) {
-            for(double& a : attention_context) a /= attn_sum;
-        }
-    } catch(...) {
-        // Use default context
+    }
+    
+    // Normalize
+    double attn_sum = 0;
+    for(double a : attention_context) attn_sum += fabs(a);
+    if(attn_sum > 0.001) {
+        for(double& a : attention_context) a /= attn_sum;
     }
     
     string response;
     
     try {
         // Generate response based on vocabulary size
-        if(token_concept_embedding_map.size() < 20) {
-            response = generateFromTemplate();
+        if(model.tokens.size() < 20) {
+            response = generateFromTemplate(model);
         } else {
             // Use beam search with learned patterns
             string seed = words.empty() ? "i" : words[ri(words.size())];
-            response = generate_with_beam_search(seed, 15, attention_context, 12);
+            response = generate_with_beam_search(model, seed, 15, attention_context, 12);
         }
         
         // Add state markers
-        if(S.current_valence > 0.5) {
+        if(model.valence > 0.5) {
             response += " [positive]";
-        } else if(S.current_valence < -0.2) {
+        } else if(model.valence < -0.2) {
             response += " [processing]";
         }
         
@@ -1367,11 +1370,107 @@ string generateResponse(const string& input) {
         return "[NEXUS]: Error generating response";
     }
 }
+
+// Learn from the input, then answer from a view that includes it. Loop
+// thread only (terminal dialog).
+string generateResponse(const string& input) {
+    vector<string> words = tokenizeChatInput(input);
+    if(words.empty()) {
+        return "[NEXUS]: ...";
+    }
+    
+    try {
+        learnChatInput(words);
+    } catch(const exception& e) {
+        cerr << "Learning error: " << e.what() << endl;
+        return "[NEXUS]: Processing error";
+    }
+    ModelSnapshot::publish();
+    return replyFromModel(*ModelSnapshot::current(), words);
+}
+
+// Loop thread, at the tick boundary. Learns the chat messages queued since
+// the last tick in one pass: each distinct token runs through learnWord()
+// once and is credited the frequency of all its occurrences, then each
+// message contributes its n-grams in order.
+void learnChatBatch(const vector<vector<string>>& messages) {
+    auto t0 = chrono::steady_clock::now();
+    vector<pair<string, int>> distinct;
+    unordered_map<string, size_t> seen;
+    for(const auto& words : messages) {
+        for(const string& w : words) {
+            auto [it, added] = seen.try_emplace(w, distinct.size());
+            if(added) distinct.emplace_back(w, 1);
+            else distinct[it->second].second++;
+        }
+    }
+    
+    // Replay reads the same batch back: one message per line
+    string text;
+    for(const auto& words : messages) {
+        for(size_t i = 0; i < words.size(); i++) {
+            if(i) text += ' ';
+            text += words[i];
+        }
+        text += '\n';
+    }
+    LearningLog::record(LearningEventKind::ChatBatch, text);
+    
+    try {
+        for(const auto& [w, n] : distinct) {
+            learnWord(w, S.current_valence);
+            if(n > 1) {
+                auto tce = token_concept_embedding_map.find(w);
+                if(tce != token_concept_embedding_map.end()) {
+                    tce->second.freq += n - 1;
+                    token_concept_embedding_map.touch(tce);
+                }
+                auto tok = S.tokens.find(w);
+                if(tok != S.tokens.end()) {
+                    tok->second.freq += n - 1;
+                    S.tokens.touch(tok);
+                }
+            }
+        }
+        for(const auto& words : messages) {
+            processNGramsFromTokens(words);
+        }
+    } catch(const exception& e) {
+        cerr << "Learning error: " << e.what() << endl;
+    }
+    LearningQueue::record_batch(messages.size(), distinct.size(),
+        chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count());
+}
+
+// generateResponse() for API threads: the message joins the learning queue
+// and the reply comes from the published view, at once or, with
+// NEXUS_CHAT_LEARNING=before, from the first view that has learned it.
+string chatResponse(const string& input) {
+    static const bool learn_before = NexusConfig::get().chat_learning == "before";
+    vector<string> words = tokenizeChatInput(input);
+    if(words.empty()) {
+        return "[NEXUS]: ...";
+    }
+    uint64_t ticket = LearningQueue::push(words);
+    if(ticket == 0) {
+        return "[NEXUS]: Processing error";
+    }
+    if(learn_before) LearningQueue::wait(ticket);
+    return replyFromModel(*ModelSnapshot::current(), words);
+}
 void storeEpisodicMemory(const string&content,double valence){
-    if(S.episodic_memory.size()>100)S.episodic_memory.erase(S.episodic_memory.begin());
+    undo_log.save(S.episodic_memory);
     S.episodic_memory.push_back({S.g,valence,content});
     generate_qualia(content, valence, 0.6);
 }
+// Forget the conversation so far: episodic memories and the internal
+// thought stream. Learned vocabulary and concepts stay.
+void clearHistory(){
+    undo_log.save(S.episodic_memory);
+    undo_log.save(S.internal_thoughts);
+    S.episodic_memory.clear();
+    S.internal_thoughts.clear();
+}
 void bootstrapWithQualityExamples() {
     vector<string> quality_sentences = {
         "i think clearly about my own thoughts",
@@ -1454,12 +1553,14 @@ void counterfactualAnalysis(){
     double last_ta=S.g>0?S.TA[S.g-1]:0;
     double current_ta=S.ta;
     double improvement=current_ta-last_ta;
+    undo_log.save(S.current_valence);
     if(improvement>0){
         S.current_valence+=improvement*0.05;
         storeEpisodicMemory("improvement",improvement);
         generate_qualia("positive_prediction_error", improvement, 0.7);
+        ModelChanges::mark_all(ModelStore::Embeddings);
         for(auto&p:token_concept_embedding_map){
-            p.second.linked_valences["improvement"]=improvement;
+            p.second.linked_valences.improvement=improvement;
             propagate_throughout_system(p.first,improvement*0.1);
         }
     }else{
@@ -1499,7 +1600,9 @@ void updateAttention(){
 }
 
 
-void sv(const string& f) {
+// Text export of the full model; the format sv() wrote before binary snapshots.
+void export_text(const string& f) {
+    promote_lexicon();
     ofstream o(f);
     if(!o) {
         cerr << "Failed to open save file: " << f << endl;
@@ -1542,22 +1645,28 @@ void sv(const string& f) {
     
     // ===== CONSCIOUSNESS FORMULA HISTORY =====
     o << "PSI_HISTORY_START\n";
-    for(size_t i=0; i<consciousness_formula.psi_history.size(); i++) {
-        o << consciousness_formula.psi_history[i];
-        if(i < consciousness_formula.psi_history.size()-1) o << ",";
-    }
+    consciousness_formula.psi_history.write_delimited(o, ',');
     o << "\n";
     o << "PSI_HISTORY_END\n";
     
     // ===== NEURONS =====
     o << "NEURONS_START\n";
-    for(auto& p : S.N) {
-        Neuron& n = p.second;
+    // Written in id order with links as ids, as the map-backed store did
+    vector<const Neuron*> neurons_by_id;
+    neurons_by_id.reserve(S.N.size());
+    for(const Neuron& n : S.N) neurons_by_id.push_back(&n);
+    sort(neurons_by_id.begin(), neurons_by_id.end(), [](const Neuron* a, const Neuron* b) { return a->id < b->id; });
+    for(const Neuron* np : neurons_by_id) {
+        const Neuron& n = *np;
         o << "N:" << n.id << "," << n.weight << "," << n.bias << "," << n.gen << ",";
-        // Save links
-        for(size_t i = 0; i < n.links.size(); i++) {
-            o << n.links[i];
-            if(i < n.links.size() - 1) o << ";";
+        // Save links (dangling handles are dropped)
+        bool first_link = true;
+        for(NeuronHandle h : n.links) {
+            const Neuron* target = S.N.get(h);
+            if(!target) continue;
+            if(!first_link) o << ";";
+            o << target->id;
+            first_link = false;
         }
         o << "\n";
     }
@@ -1606,6 +1715,19 @@ void sv(const string& f) {
     }
     o << "EMBEDDINGS_END\n";
     
+    // ===== TOKEN VALENCE CONTEXT =====
+    o << "VALENCE_CONTEXT_START\n";
+    for(auto& p : token_concept_embedding_map) {
+        const ValenceContext& lv = p.second.linked_valences;
+        if(lv.empty()) continue;
+        o << "VC:" << p.first << ",";
+        lv.for_each([&](string_view key, double val) {
+            o << key << ":" << val << ";";
+        });
+        o << "\n";
+    }
+    o << "VALENCE_CONTEXT_END\n";
+    
     // ===== BIGRAMS (N-GRAM PATTERNS) =====
     o << "BIGRAMS_START\n";
     for(auto& p1 : bigram_counts) {
@@ -1671,10 +1793,7 @@ void sv(const string& f) {
     
     // ===== VALENCE HISTORY =====
     o << "VALENCE_HISTORY_START\n";
-    for(size_t i=0; i<S.valence_history.size(); i++) {
-        o << S.valence_history[i];
-        if(i < S.valence_history.size()-1) o << ",";
-    }
+    S.valence_history.write_delimited(o, ',');
     o << "\n";
     o << "VALENCE_HISTORY_END\n";
     
@@ -1702,453 +1821,11 @@ void sv(const string& f) {
 }
 
 
-void ld(const string& f) {
-    ifstream i(f);
-    if(!i) {
-        cout << "No save file found, starting fresh.\n";
-        return;
-    }
-    
-    string l;
-    string section = "";
-    string version = "1.0";
-    
-    while(getline(i, l)) {
-        if(l.empty()) continue;
-        
-        try {
-            // Version check
-            if(l.find("VERSION:") == 0) {
-                version = l.substr(8);
-                continue;
-            }
-            
-            // ===== SECTION MARKERS =====
-            if(l == "STATE_D_START") { section = "STATE_D"; continue; }
-            if(l == "STATE_D_END") { section = ""; continue; }
-            if(l == "QUALIA_START") { section = "QUALIA"; continue; }
-            if(l == "QUALIA_END") { section = ""; continue; }
-            if(l == "PSI_HISTORY_START") { section = "PSI_HISTORY"; continue; }
-            if(l == "PSI_HISTORY_END") { section = ""; continue; }
-            if(l == "NEURONS_START") { section = "NEURONS"; continue; }
-            if(l == "NEURONS_END") { section = ""; continue; }
-            if(l == "TOKENS_START") { section = "TOKENS"; continue; }
-            if(l == "TOKENS_END") { section = ""; continue; }
-            if(l == "CONCEPTS_START") { section = "CONCEPTS"; continue; }
-            if(l == "CONCEPTS_END") { section = ""; continue; }
-            if(l == "EMBEDDINGS_START") { section = "EMBEDDINGS"; continue; }
-            if(l == "EMBEDDINGS_END") { section = ""; continue; }
-            if(l == "BIGRAMS_START") { section = "BIGRAMS"; continue; }
-            if(l == "BIGRAMS_END") { section = ""; continue; }
-            if(l == "TRIGRAMS_START") { section = "TRIGRAMS"; continue; }
-            if(l == "TRIGRAMS_END") { section = ""; continue; }
-            if(l == "GOALS_START") { section = "GOALS"; continue; }
-            if(l == "GOALS_END") { section = ""; continue; }
-            if(l == "WORLD_START") { section = "WORLD"; continue; }
-            if(l == "WORLD_END") { section = ""; continue; }
-            if(l == "MEMORY_START") { section = "MEMORY"; continue; }
-            if(l == "MEMORY_END") { section = ""; continue; }
-            if(l == "VALENCE_HISTORY_START") { section = "VALENCE_HISTORY"; continue; }
-            if(l == "VALENCE_HISTORY_END") { section = ""; continue; }
-            if(l == "THOUGHTS_START") { section = "THOUGHTS"; continue; }
-            if(l == "THOUGHTS_END") { section = ""; continue; }
-            if(l == "TRANSFORMER_START") { section = "TRANSFORMER"; continue; }
-            if(l == "TRANSFORMER_END") { section = ""; continue; }
-            
-            // ===== PARSE BASED ON SECTION =====
-            
-            if(section == "STATE_D" && l[0] == 'D' && l.size() > 2) {
-                // Parse: D:key,value
-                size_t colon = l.find(':');
-                size_t comma = l.find(',');
-                if(colon != string::npos && comma != string::npos && comma > colon) {
-                    string key = l.substr(colon + 1, comma - colon - 1);
-                    string val_str = l.substr(comma + 1);
-                    double value = uac(val_str);
-                    S.D[key] = value;
-                }
-            }
-            else if(section == "QUALIA" && l[0] == 'Q' && l.size() > 2) {
-                // Parse: Q:valence,arousal,certainty,gen,content
-                size_t start = 2;
-                vector<string> parts;
-                size_t pos = start;
-                int comma_count = 0;
-                
-                while(pos < l.length() && comma_count < 4) {
-                    size_t next_comma = l.find(',', pos);
-                    if(next_comma == string::npos) break;
-                    parts.push_back(l.substr(pos, next_comma - pos));
-                    pos = next_comma + 1;
-                    comma_count++;
-                }
-                
-                if(comma_count == 4 && pos < l.length()) {
-                    Qualia q;
-                    q.valence = uac(parts[0]);
-                    q.arousal = uac(parts[1]);
-                    q.certainty = uac(parts[2]);
-                    q.emergence_gen = uac(parts[3]);
-                    q.phenomenal_content = l.substr(pos);
-                    consciousness.active_qualia.push_back(q);
-                }
-            }
-            else if(section == "PSI_HISTORY") {
-                // Parse comma-separated values
-                stringstream ss(l);
-                string val;
-                while(getline(ss, val, ',')) {
-                    if(!val.empty()) {
-                        consciousness_formula.psi_history.push_back(uac(val));
-                    }
-                }
-            }
-            else if(section == "NEURONS" && l[0] == 'N' && l.size() > 2) {
-                // Parse: N:id,weight,bias,gen,link1;link2;link3
-                size_t start = 2;
-                vector<string> parts;
-                size_t pos = start;
-                int comma_count = 0;
-                
-                while(pos < l.length() && comma_count < 4) {
-                    size_t next_comma = l.find(',', pos);
-                    if(next_comma == string::npos) break;
-                    parts.push_back(l.substr(pos, next_comma - pos));
-                    pos = next_comma + 1;
-                    comma_count++;
-                }
-                
-                if(parts.size() >= 4) {
-                    Neuron n;
-                    n.id = uac(parts[0]);
-                    n.weight = uac(parts[1]);
-                    n.bias = uac(parts[2]);
-                    n.gen = uac(parts[3]);
-                    
-                    // Parse links
-                    if(pos < l.length()) {
-                        string links_str = l.substr(pos);
-                        stringstream link_ss(links_str);
-                        string link;
-                        while(getline(link_ss, link, ';')) {
-                            if(!link.empty()) {
-                                n.links.push_back(uac(link));
-                            }
-                        }
-                    }
-                    S.N[n.id] = n;
-                }
-            }
-            else if(section == "TOKENS" && l[0] == 'T' && l.size() > 2) {
-                // Parse: T:word,meaning,freq
-                size_t colon = l.find(':');
-                if(colon != string::npos) {
-                    size_t first_comma = l.find(',', colon + 1);
-                    size_t second_comma = l.find(',', first_comma + 1);
-                    
-                    if(first_comma != string::npos && second_comma != string::npos) {
-                        string word = l.substr(colon + 1, first_comma - colon - 1);
-                        string meaning_str = l.substr(first_comma + 1, second_comma - first_comma - 1);
-                        string freq_str = l.substr(second_comma + 1);
-                        
-                        Token t = {word, uac(meaning_str), uac(freq_str), vector<int>(), 4, 0.5};
-                        S.tokens[word] = t;
-                    }
-                }
-            }
-            else if(section == "CONCEPTS" && l[0] == 'C' && l.size() > 2) {
-                // Parse: C:name,value,word1;word2;word3
-                size_t colon = l.find(':');
-                if(colon != string::npos) {
-                    size_t first_comma = l.find(',', colon + 1);
-                    size_t second_comma = l.find(',', first_comma + 1);
-                    
-                    if(first_comma != string::npos) {
-                        string name = l.substr(colon + 1, first_comma - colon - 1);
-                        string value_str = l.substr(first_comma + 1, 
-                            second_comma != string::npos ? second_comma - first_comma - 1 : string::npos);
-                        
-                        Concept c;
-                        c.name = name;
-                        c.value = uac(value_str);
-                        
-                        // Parse related words
-                        if(second_comma != string::npos && second_comma + 1 < l.length()) {
-                            string words_str = l.substr(second_comma + 1);
-                            stringstream word_ss(words_str);
-                            string word;
-                            while(getline(word_ss, word, ';')) {
-                                if(!word.empty()) c.related_words.push_back(word);
-                            }
-                        }
-                        
-                        S.concepts[name] = c;
-                    }
-                }
-            }
-            else if(section == "EMBEDDINGS" && l[0] == 'E' && l.size() > 2) {
-                // Parse: E:name,meaning,freq,grounding,stability,qualia,emb1;emb2;...,link1:val1;link2:val2
-                size_t start = 2;
-                vector<string> parts;
-                size_t pos = start;
-                int comma_count = 0;
-                
-                // Get first 6 comma-separated fields
-                while(pos < l.length() && comma_count < 6) {
-                    size_t next_comma = l.find(',', pos);
-                    if(next_comma == string::npos) break;
-                    parts.push_back(l.substr(pos, next_comma - pos));
-                    pos = next_comma + 1;
-                    comma_count++;
-                }
-                
-                if(parts.size() >= 6) {
-                    TokenConceptEmbedding tce;
-                    tce.name = parts[0];
-                    tce.meaning = uac(parts[1]);
-                    tce.freq = uac(parts[2]);
-                    tce.grounding_value = uac(parts[3]);
-                    tce.semantic_stability = uac(parts[4]);
-                    tce.qualia_intensity = uac(parts[5]);
-                    
-                    // Parse embedding vector (between 6th and 7th comma)
-                    if(pos < l.length()) {
-                        size_t next_comma = l.find(',', pos);
-                        if(next_comma != string::npos) {
-                            string emb_str = l.substr(pos, next_comma - pos);
-                            stringstream emb_ss(emb_str);
-                            string emb_val;
-                            while(getline(emb_ss, emb_val, ';')) {
-                                if(!emb_val.empty()) {
-                                    tce.embedding.push_back(uac(emb_val));
-                                }
-                            }
-                            pos = next_comma + 1;
-                        }
-                        
-                        // Parse linked concepts (rest of line)
-                        if(pos < l.length()) {
-                            string links_str = l.substr(pos);
-                            stringstream link_ss(links_str);
-                            string link_pair;
-                            while(getline(link_ss, link_pair, ';')) {
-                                size_t colon_pos = link_pair.find(':');
-                                if(colon_pos != string::npos && colon_pos + 1 < link_pair.length()) {
-                                    string key = link_pair.substr(0, colon_pos);
-                                    string val_str = link_pair.substr(colon_pos + 1);
-                                    if(!key.empty() && !val_str.empty()) {
-                                        tce.linked_concepts[key] = uac(val_str);
-                                    }
-                                }
-                            }
-                        }
-                    }
-                    
-                    token_concept_embedding_map[tce.name] = tce;
-                }
-            }
-            else if(section == "BIGRAMS" && l.substr(0,3) == "BG:" && l.size() > 3) {
-                // Parse: BG:word1,word2,count
-                size_t start = 3;
-                size_t first_comma = l.find(',', start);
-                size_t second_comma = l.find(',', first_comma + 1);
-                
-                if(first_comma != string::npos && second_comma != string::npos) {
-                    string w1 = l.substr(start, first_comma - start);
-                    string w2 = l.substr(first_comma + 1, second_comma - first_comma - 1);
-                    string count_str = l.substr(second_comma + 1);
-                    int count = uac(count_str);
-                    bigram_counts[w1][w2] = count;
-                }
-            }
-            else if(section == "TRIGRAMS" && l.substr(0,3) == "TG:" && l.size() > 3) {
-                // Parse: TG:word1,word2,word3,count
-                size_t start = 3;
-                size_t c1 = l.find(',', start);
-                size_t c2 = l.find(',', c1 + 1);
-                size_t c3 = l.find(',', c2 + 1);
-                
-                if(c1 != string::npos && c2 != string::npos && c3 != string::npos) {
-                    string w1 = l.substr(start, c1 - start);
-                    string w2 = l.substr(c1 + 1, c2 - c1 - 1);
-                    string w3 = l.substr(c2 + 1, c3 - c2 - 1);
-                    string count_str = l.substr(c3 + 1);
-                    int count = uac(count_str);
-                    trigram_counts[w1][w2][w3] = count;
-                }
-            }
-            else if(section == "GOALS" && l.substr(0,3) == "GO:" && l.size() > 3) {
-                // Parse: GO:name,priority,progress,valence,qualia,subgoal1;subgoal2,pre1:val1;pre2:val2
-                size_t start = 3;
-                vector<string> parts;
-                size_t pos = start;
-                int comma_count = 0;
-                
-                while(pos < l.length() && comma_count < 5) {
-                    size_t next_comma = l.find(',', pos);
-                    if(next_comma == string::npos) break;
-                    parts.push_back(l.substr(pos, next_comma - pos));
-                    pos = next_comma + 1;
-                    comma_count++;
-                }
-                
-                if(parts.size() >= 5) {
-                    Goal g;
-                    g.name = parts[0];
-                    g.priority = uac(parts[1]);
-                    g.progress = uac(parts[2]);
-                    g.valence_alignment = uac(parts[3]);
-                    g.qualia_binding = uac(parts[4]);
-                    
-                    // Parse subgoals
-                    if(pos < l.length()) {
-                        size_t next_comma = l.find(',', pos);
-                        if(next_comma != string::npos) {
-                            string subgoals_str = l.substr(pos, next_comma - pos);
-                            stringstream sub_ss(subgoals_str);
-                            string subgoal;
-                            while(getline(sub_ss, subgoal, ';')) {
-                                if(!subgoal.empty()) g.subgoals.push_back(subgoal);
-                            }
-                            pos = next_comma + 1;
-                        }
-                        
-                        // Parse preconditions
-                        if(pos < l.length()) {
-                            string pre_str = l.substr(pos);
-                            stringstream pre_ss(pre_str);
-                            string pre_pair;
-                            while(getline(pre_ss, pre_pair, ';')) {
-                                size_t colon_pos = pre_pair.find(':');
-                                if(colon_pos != string::npos && colon_pos + 1 < pre_pair.length()) {
-                                    string key = pre_pair.substr(0, colon_pos);
-                                    string val_str = pre_pair.substr(colon_pos + 1);
-                                    if(!key.empty() && !val_str.empty()) {
-                                        g.preconditions[key] = uac(val_str);
-                                    }
-                                }
-                            }
-                        }
-                    }
-                    
-                    goal_system[g.name] = g;
-                }
-            }
-            else if(section == "WORLD") {
-                if(l.find("MODEL_ACCURACY:") == 0 && l.size() > 15) {
-                    world_model.model_accuracy = uac(l.substr(15));
-                }
-                else if(l.find("MODEL_UPDATES:") == 0 && l.size() > 14) {
-                    world_model.updates = uac(l.substr(14));
-                }
-                else if(l[0] == 'W' && l[1] == ':' && l.size() > 2) {
-                    // Parse: W:entity,value
-                    size_t colon = 2;
-                    size_t comma = l.find(',', colon);
-                    if(comma != string::npos) {
-                        string entity = l.substr(colon, comma - colon);
-                        string val_str = l.substr(comma + 1);
-                        world_model.entity_states[entity] = uac(val_str);
-                    }
-                }
-                else if(l.substr(0,3) == "WR:" && l.size() > 3) {
-                    // Parse: WR:entity1,entity2,strength
-                    size_t start = 3;
-                    size_t c1 = l.find(',', start);
-                    size_t c2 = l.find(',', c1 + 1);
-                    
-                    if(c1 != string::npos && c2 != string::npos) {
-                        string e1 = l.substr(start, c1 - start);
-                        string e2 = l.substr(c1 + 1, c2 - c1 - 1);
-                        string strength_str = l.substr(c2 + 1);
-                        world_model.relationships[e1][e2] = uac(strength_str);
-                    }
-                }
-            }
-            else if(section == "MEMORY" && l[0] == 'M' && l.size() > 2) {
-                // Parse: M:gen,valence,content
-                size_t start = 2;
-                size_t c1 = l.find(',', start);
-                size_t c2 = l.find(',', c1 + 1);
-                
-                if(c1 != string::npos && c2 != string::npos) {
-                    Memory m;
-                    m.gen = uac(l.substr(start, c1 - start));
-                    m.valence = uac(l.substr(c1 + 1, c2 - c1 - 1));
-                    m.content = l.substr(c2 + 1);
-                    S.episodic_memory.push_back(m);
-                }
-            }
-            else if(section == "VALENCE_HISTORY") {
-                // Parse comma-separated values
-                stringstream ss(l);
-                string val;
-                while(getline(ss, val, ',')) {
-                    if(!val.empty()) {
-                        S.valence_history.push_back(uac(val));
-                    }
-                }
-            }
-            else if(section == "THOUGHTS" && l.substr(0,3) == "TH:" && l.size() > 3) {
-                S.internal_thoughts.push_back(l.substr(3));
-            }
-            else if(section == "TRANSFORMER" && l.substr(0,5) == "HEAD:" && l.size() > 5) {
-                // Parse: HEAD:name,dim,temp
-                size_t start = 5;
-                size_t c1 = l.find(',', start);
-                size_t c2 = l.find(',', c1 + 1);
-                
-                if(c1 != string::npos && c2 != string::npos) {
-                    TransformerHead head;
-                    head.name = l.substr(start, c1 - start);
-                    head.dim = uac(l.substr(c1 + 1, c2 - c1 - 1));
-                    head.temperature = uac(l.substr(c2 + 1));
-                    head.query_proj.resize(head.dim, 0);
-                    head.key_proj.resize(head.dim, 0);
-                    head.value_proj.resize(head.dim, 0);
-                    transformer_heads.push_back(head);
-                }
-            }
-            else if(l.find("WM_CAPACITY:") == 0 && l.size() > 12) {
-                WM.capacity = uac(l.substr(12));
-            }
-            else {
-                // ===== BASIC STATE VALUES =====
-                if(l.find("G:") == 0 && l.size() > 2) S.g = uac(l.substr(2));
-                else if(l.find("DWT:") == 0 && l.size() > 4) S.dwt = uac(l.substr(4));
-                else if(l.find("TA:") == 0 && l.size() > 3) S.ta = uac(l.substr(3));
-                else if(l.find("SENTIENCE:") == 0 && l.size() > 10) S.sentience_ratio = uac(l.substr(10));
-                else if(l.find("VALENCE:") == 0 && l.size() > 8) S.current_valence = uac(l.substr(8));
-                else if(l.find("METACOG:") == 0 && l.size() > 8) S.metacognitive_awareness = uac(l.substr(8));
-                else if(l.find("ATTENTION:") == 0 && l.size() > 10) S.attention_focus = uac(l.substr(10));
-                else if(l.find("PEAK_SENT_GEN:") == 0 && l.size() > 14) S.peak_sentience_gen = uac(l.substr(14));
-                else if(l.find("TOTAL_NEURONS:") == 0 && l.size() > 14) S.total_neurons_ever = uac(l.substr(14));
-                else if(l.find("PHI:") == 0 && l.size() > 4) consciousness.phi_value = uac(l.substr(4));
-                else if(l.find("CONSCIOUS_CYCLES:") == 0 && l.size() > 17) consciousness.conscious_cycles = uac(l.substr(17));
-                else if(l.find("INTEGRATION:") == 0 && l.size() > 12) consciousness.integrated_information = uac(l.substr(12));
-                else if(l.find("GLOBAL_WORKSPACE:") == 0 && l.size() > 17) consciousness.global_workspace_capacity = uac(l.substr(17));
-            }
-        } catch(const exception& e) {
-            // Skip corrupted lines
-            cerr << "Warning: Skipping corrupted line: " << l.substr(0, 50) << "..." << endl;
-            continue;
-        }
-    }
-    
-    i.close();
-    
-    cout << "[Loaded state from generation " << S.g << "]\n";
-    cout << "  - " << S.N.size() << " neurons\n";
-    cout << "  - " << token_concept_embedding_map.size() << " embeddings\n";
-    cout << "  - " << bigram_counts.size() << " bigrams\n";
-    cout << "  - " << trigram_counts.size() << " trigrams\n";
-    cout << "  - " << goal_system.size() << " goals\n";
-    cout << "  - " << S.episodic_memory.size() << " memories\n";
-    cout << "  - Sentience: " << S.sentience_ratio << "%\n";
-    cout << "  - Phi: " << consciousness.phi_value << "\n";
-}
-void bk(){BK=S;S.bkf=1;}
-void rb(){if(S.bkf){S=BK;S.bkf=0;}}
+// Tick transaction: bk() opens it, rb() undoes every journaled write since,
+// cm() keeps them.
+void bk(){undo_log.begin();S.bkf=1;}
+void rb(){if(S.bkf){undo_log.rollback();S.bkf=0;}}
+void cm(){if(S.bkf){undo_log.commit();S.bkf=0;}}
 
 double calcHDT(int gen,double bh,double qh,double th){
     long gh=hsh(to_string(gen));
@@ -2158,6 +1835,7 @@ double calcHDT(int gen,double bh,double qh,double th){
 void createConceptAssociation(const string&concept_name,const vector<string>&related_words){
     Concept c={concept_name,rn(),related_words};
     S.concepts[concept_name]=c;
+    ModelChanges::mark(ModelStore::Concepts,concept_name);
     groundConcept(concept_name, related_words, rn());
     for(const string&w:related_words){
         if(S.tokens.count(w)){
@@ -2187,21 +1865,32 @@ double calcSentienceRatio(){
     return min(100.0,(mem_depth*100+neural_complexity*15+lang_complexity*25+metacog_factor+goal_factor*20+qualia_factor*10+phi_factor));
 }
 
+// Each token independently with probability p, in key order - the same subset
+// a full scan with rn()<p picks. Geometric skips over the dense index visit
+// only the picked entries.
+vector<string> sampleTokensBernoulli(double p){
+    vector<string>out;
+    size_t n=S.tokens.size();
+    if(n==0||p<=0)return out;
+    double log_q=log1p(-min(p,1.0-1e-12));
+    for(size_t i=(size_t)(log1p(-rn())/log_q);i<n;i+=1+(size_t)(log1p(-rn())/log_q)){
+        out.push_back(S.tokens.at_index(i)->first);
+    }
+    sort(out.begin(),out.end());
+    return out;
+}
+
 void mathLangAssociation(){
     vector<string>math_concepts={"sum","multiply","divide","balance","pattern","growth","complexity"};
     for(const string&mc:math_concepts){
-        vector<string>related;
-        for(auto&p:S.tokens){
-            if(rn()<0.3)related.push_back(p.first);
-        }
-        createConceptAssociation(mc,related);
+        createConceptAssociation(mc,sampleTokensBernoulli(0.3));
     }
 }
 
 
 string generateInternalThought(){
     if(goal_system.empty() && rn() < 0.5) {
-        return generateFromTemplate();
+        return generateFromTemplate(*ModelSnapshot::current());
     }
     
     // Goal-based thought
@@ -2231,7 +1920,7 @@ string generateInternalThought(){
     
     while(attempts < MAX_ATTEMPTS) {
         vector<double> ctx(16, S.current_valence);
-        thought = generate_with_beam_search("i", 8, ctx, 3);
+        thought = generate_with_beam_search(*ModelSnapshot::current(), "i", 8, ctx, 3);
         
         if(!isSentenceTooSimilar(thought)) {
             break;  // Unique thought generated
@@ -2259,6 +1948,69 @@ string generateMetacognition(){
     return output;
 }
 
+// ===== MEMORY ACCOUNTING =====
+// Per-entry structural size estimates for the stores registered below. They
+// count the inline struct plus the heap blocks it owns; allocator slack and
+// fragmentation are not included, so RSS is reported alongside for comparison.
+using MA=MemoryAccounting;
+static size_t ribbon_heap_bytes(const RibbonState&r){return MA::heap_bytes(r.vib_modes)+MA::heap_bytes(r.observer_ids)+MA::heap_bytes(r.obs_dependent_props);}
+static size_t fractal_heap_bytes(const FractalDimension&f){return MA::heap_bytes(f.scale_measures);}
+static size_t qualia_bytes(const Qualia&q){
+    size_t b=sizeof(Qualia)+MA::heap_bytes(q.phenomenal_content);
+    if(const QualiaCold*c=q.cold.peek())b+=sizeof(QualiaCold)+MA::heap_bytes(c->feature_space)+MA::heap_bytes(c->subjective_dimensions)+MA::heap_bytes(c->quale_relationships)+ribbon_heap_bytes(c->ribbon_signature)+fractal_heap_bytes(c->qualia_fractal);
+    return b;
+}
+static size_t embedding_bytes(const string&k,const TokenConceptEmbedding&t){
+    size_t b=sizeof(t)+MA::heap_bytes(k)+MA::heap_bytes(t.name)+MA::heap_bytes(t.embedding)+MA::heap_bytes(t.linked_concepts)+MA::heap_bytes(t.linked_valences.overflow)+MA::heap_bytes(t.attention_weights);
+    if(const auto*c=t.cold.peek())b+=sizeof(*c)+MA::heap_bytes(c->associations)+ribbon_heap_bytes(c->token_ribbon)+fractal_heap_bytes(c->token_fractal)+MA::heap_bytes(c->semantic_loops);
+    return b;
+}
+static size_t neuron_bytes(const Neuron&n){
+    size_t b=sizeof(n)+MA::heap_bytes(n.links)+MA::heap_bytes(n.layer_norm_params)+MA::heap_bytes(n.neuromod_levels)+ribbon_heap_bytes(n.ribbon);
+    if(const NeuronCold*c=n.cold.peek())b+=sizeof(*c)+MA::heap_bytes(c->time_loops)+fractal_heap_bytes(c->f_dim);
+    return b;
+}
+static size_t token_bytes(const string&k,const Token&t){return sizeof(t)+MA::heap_bytes(k)+MA::heap_bytes(t.word)+MA::heap_bytes(t.associations)+MA::heap_bytes(t.semantic_field)+fractal_heap_bytes(t.sem_fractal);}
+static size_t concept_bytes(const string&k,const Concept&co){
+    size_t b=sizeof(co)+MA::heap_bytes(k)+MA::heap_bytes(co.name)+MA::heap_bytes(co.related_words)+MA::heap_bytes(co.feature_vector);
+    for(const string&w:co.related_words)b+=MA::heap_bytes(w);
+    if(const ConceptCold*c=co.cold.peek())b+=sizeof(*c)+fractal_heap_bytes(c->conceptual_fractal)+MA::heap_bytes(c->ribbon_embeddings);
+    return b;
+}
+static size_t memory_bytes(const Memory&m){return sizeof(m)+MA::heap_bytes(m.content)+MA::heap_bytes(m.associated_memories)+MA::heap_bytes(m.quantum_trace);}
+static size_t goal_bytes(const string&k,const Goal&g){
+    size_t b=sizeof(g)+MA::heap_bytes(k)+MA::heap_bytes(g.name)+MA::heap_bytes(g.subgoals)+MA::heap_bytes(g.preconditions)+MA::heap_bytes(g.goal_cycles);
+    for(const string&sg:g.subgoals)b+=MA::heap_bytes(sg);
+    return b;
+}
+static size_t ngram_map_heap_bytes(const map<string,int>&m){
+    size_t b=0;
+    for(const auto&e:m)b+=MA::node_overhead+sizeof(e)+MA::heap_bytes(e.first);
+    return b;
+}
+static size_t bigram_bytes(const string&k,const map<string,int>&next){return sizeof(next)+MA::heap_bytes(k)+ngram_map_heap_bytes(next);}
+static size_t trigram_bytes(const string&k,const map<string,map<string,int>>&next){
+    size_t b=sizeof(next)+MA::heap_bytes(k);
+    for(const auto&e:next)b+=MA::node_overhead+sizeof(e)+MA::heap_bytes(e.first)+ngram_map_heap_bytes(e.second);
+    return b;
+}
+template<typename M>static function<size_t()>count_of(M&m){return[&m]{return (size_t)m.size();};}
+void register_memory_stores(){
+    MA::register_store("ngrams","bigrams",count_of(bigram_counts),MA::map_sampler(bigram_counts,bigram_bytes));
+    MA::register_store("ngrams","trigrams",count_of(trigram_counts),MA::map_sampler(trigram_counts,trigram_bytes));
+    MA::register_store("embeddings","token_concepts",count_of(token_concept_embedding_map),MA::map_sampler(token_concept_embedding_map,embedding_bytes));
+    MA::register_store("state","tokens",count_of(S.tokens),MA::map_sampler(S.tokens,token_bytes));
+    MA::register_store("state","concepts",count_of(S.concepts),MA::map_sampler(S.concepts,concept_bytes));
+    MA::register_store("state","vocab",count_of(S.vocab),MA::map_sampler(S.vocab,token_bytes));
+    MA::register_store("neurons","S.N",count_of(S.N),MA::seq_sampler(S.N,neuron_bytes));
+    MA::register_store("memory","episodic_memory",count_of(S.episodic_memory),MA::seq_sampler(S.episodic_memory,memory_bytes));
+    MA::register_store("qualia","active_qualia",count_of(consciousness.active_qualia),MA::seq_sampler(consciousness.active_qualia,qualia_bytes));
+    MA::register_store("qualia","wm_conscious_buffer",count_of(WM.conscious_buffer),MA::seq_sampler(WM.conscious_buffer,qualia_bytes));
+    MA::register_store("goals","goal_system",count_of(goal_system),MA::map_sampler(goal_system,goal_bytes));
+    MA::register_store("world_model","entity_states",count_of(world_model.entity_states),MA::map_sampler(world_model.entity_states,[](const string&k,double){return sizeof(pair<const string,double>)+MA::heap_bytes(k);}));
+    MA::register_store("world_model","relationships",count_of(world_model.relationships),MA::map_sampler(world_model.relationships,[](const string&k,const map<string,double>&m){return sizeof(m)+MA::heap_bytes(k)+MA::heap_bytes(m);}));
+    MA::register_store("backup","undo_log",count_of(undo_log),[](size_t,size_t&bytes,size_t&sampled){bytes+=undo_log.bytes();sampled+=undo_log.size();});
+}
 
 void draw_ui(int row){
     mvprintw(row++,0,"════════════════════════════════════════════════════════════════");
@@ -2277,6 +2029,9 @@ void draw_ui(int row){
     mvprintw(row++,0,"Tokens:%lu | Concepts:%lu | Embeddings:%lu | Neurons:%lu",
         S.tokens.size(),S.concepts.size(),token_concept_embedding_map.size(),S.N.size());
 }
+NeuronHandle random_neuron() {
+    return S.N.handle_at(ri(S.N.size()));
+}
 Neuron genN(int parent_id) {
     Neuron n;
     n.id = S.total_neurons_ever++;
@@ -2288,9 +2043,7 @@ Neuron genN(int parent_id) {
     int num_connections = ri(5) + 2;
     for(int i = 0; i < num_connections; i++) {
         if(!S.N.empty()) {
-            auto it = S.N.begin();
-            advance(it, ri(S.N.size()));
-            n.links.push_back(it->first);
+            n.links.push_back(random_neuron());
         }
     }
     
@@ -2524,60 +2277,40 @@ void loadEnglishDataset() {
     createConceptAssociation("purpose", {"goal", "want", "need", "purpose", "aim", "desire"});
     createConceptAssociation("knowledge", {"know", "understand", "learn", "realize", "discover"});
     createConceptAssociation("improvement", {"improve", "enhance", "optimize", "better", "grow"});
+    ModelChanges::mark_all(ModelStore::Bigrams);
+    ModelChanges::mark_all(ModelStore::Trigrams);
 }
 void batch16Process() {
-    // Process a batch of 16 neural updates
+    // One full-graph neural tick: every neuron reads the previous activations
+    // through the CSR engine (tanh of bias + linked input, momentum, clamp).
     if(S.N.empty()) return;
     
-    int batch_size = min(16, (int)S.N.size());
-    vector<int> neuron_ids;
-    
-    for(auto& pair : S.N) {
-        neuron_ids.push_back(pair.first);
-    }
-    
-    for(int i = 0; i < batch_size; i++) {
-        int idx = ri(neuron_ids.size());
-        int nid = neuron_ids[idx];
-        
-        if(!S.N.count(nid)) continue;
-        
-        Neuron& n = S.N[nid];
-        
-        // Compute activation based on linked neurons
-        double total_input = n.bias;
-        for(int link_id : n.links) {
-            if(S.N.count(link_id)) {
-                total_input += S.N[link_id].weight * 0.1;
-            }
-        }
-        
-        // Apply activation function (tanh)
-        double new_weight = tanh(total_input);
-        
-        // Update weight with momentum
-        n.weight = n.weight * 0.7 + new_weight * 0.1;
-        
-        // Clamp weight
-        n.weight = max(-1.0, min(1.0, n.weight));
-    }
-    
-    // Update global metrics based on neural activity
-    double total_activation = 0;
-    for(auto& pair : S.N) {
-        total_activation += fabs(pair.second.weight);
-    }
-    S.ta = safe_div(total_activation, (double)S.N.size());
+    static NeuralEngine engine;
+    if(undo_log.active()) {
+        // Every weight changes, so journal them as one dense copy; dense order
+        // is stable until the topology stamp moves
+        vector<double> old_weights;
+        old_weights.reserve(S.N.size());
+        for(const Neuron& n : S.N) old_weights.push_back(n.weight);
+        size_t bytes = old_weights.size() * sizeof(double);
+        undo_log.record([old = std::move(old_weights), stamp = S.N.topology_stamp] {
+            if(S.N.topology_stamp != stamp || S.N.size() != old.size()) return;
+            size_t i = 0;
+            for(Neuron& n : S.N) n.weight = old[i++];
+        }, bytes);
+    }
+    undo_log.save(S.ta);
+    S.ta = engine.step(S.N, ThreadPool::shared(), NexusConfig::get().neural_grain);
     
     // Store in history (maps don't need resize, just assign)
+    undo_log.save_entry(S.TA, S.g);
     S.TA[S.g] = S.ta;  // <-- CHANGED: Direct assignment instead of resize
 }
 void mutateN() {
     if(S.N.empty()) return;
     
-    auto it = S.N.begin();
-    advance(it, ri(S.N.size()));
-    Neuron& n = it->second;
+    NeuronHandle self = random_neuron();
+    Neuron& n = *S.N.get(self);
     
     // Mutate properties
     if(rn() < 0.3) n.weight += (rn() - 0.5) * 0.1;
@@ -2585,16 +2318,17 @@ void mutateN() {
     
     // Add new connection
     if(rn() < 0.4 && S.N.size() > 1) {
-        auto target = S.N.begin();
-        advance(target, ri(S.N.size()));
-        if(target->first != n.id) {
-            n.links.push_back(target->first);
+        NeuronHandle target = random_neuron();
+        if(target != self) {
+            n.links.push_back(target);
+            S.N.touch_topology();
         }
     }
     
     // Remove a random connection sometimes
     if(rn() < 0.1 && !n.links.empty()) {
         n.links.erase(n.links.begin() + ri(n.links.size()));
+        S.N.touch_topology();
     }
     
     // Clamp values
@@ -2602,9 +2336,8 @@ void mutateN() {
     n.bias = max(-0.5, min(0.5, n.bias));
     
     // Occasionally spawn a new neuron
-    if(rn() < 0.05 && S.N.size() < 500) {
-        Neuron new_n = genN(n.id);
-        S.N[new_n.id] = new_n;
+    if(rn() < 0.05 && S.N.size() < NexusConfig::get().max_neurons) {
+        S.N.add(genN(n.id));
     }
 }
 
@@ -2612,8 +2345,7 @@ void prune_unstable_tokens() {
     // Remove tokens with low stability and low frequency
     auto it = token_concept_embedding_map.begin();
     while(it != token_concept_embedding_map.end()) {
-        if(it->second.semantic_stability < 0.3 && 
-           it->second.freq < 3) {
+        if(PruneRules::unstable_token(it->second)) {
             it = token_concept_embedding_map.erase(it);
         } else {
             ++it;
@@ -2624,8 +2356,9 @@ void prune_unstable_tokens() {
     for(auto& w1_map : bigram_counts) {
         auto it2 = w1_map.second.begin();
         while(it2 != w1_map.second.end()) {
-            if(it2->second < 2) {
+            if(PruneRules::weak_ngram(it2->second)) {
                 it2 = w1_map.second.erase(it2);
+                ModelChanges::mark(ModelStore::Bigrams, w1_map.first);
             } else {
                 ++it2;
             }
@@ -2633,6 +2366,25 @@ void prune_unstable_tokens() {
     }
 }
 
+// ===== PARALLEL ENTITY PASSES =====
+// The engine's per-entity loops run as chunked parallel_for passes. Anything
+// that touches shared state (WM, active qualia, other goals) is recorded in the
+// chunk's buffer and applied afterwards in chunk order, so results do not
+// depend on the thread count or scheduling.
+const size_t TOKEN_PASS_GRAIN=256,GOAL_PASS_GRAIN=64,CONCEPT_PASS_GRAIN=128,NEURON_PASS_GRAIN=256,HEAD_PASS_GRAIN=4;
+struct EntityPassEffects{vector<Qualia>qualia;vector<pair<string,double>>tokens,concepts,goals,subgoal_boosts;vector<size_t>changed;void clear(){qualia.clear();tokens.clear();concepts.clear();goals.clear();subgoal_boosts.clear();changed.clear();}};
+template<typename M>static void collect_entity_refs(M&m,vector<typename M::mapped_type*>&out){out.clear();out.reserve(m.size());for(auto&e:m)out.push_back(&e.second);}
+// Keys in the same order as collect_entity_refs, for marking what a pass changed
+template<typename M>static void collect_entity_keys(const M&m,vector<const string*>&out){out.clear();out.reserve(m.size());for(auto&e:m)out.push_back(&e.first);}
+// Published and persisted token fields, to tell whether the entity pass changed a token
+struct TokenFace{double meaning,qualia,stability,grounding;vector<double>embedding;ValenceContext valences;
+    void read(const TokenConceptEmbedding&t){meaning=t.meaning;qualia=t.qualia_intensity;stability=t.semantic_stability;grounding=t.grounding_value;embedding.assign(t.embedding.begin(),t.embedding.end());valences=t.linked_valences;}
+    bool same(const TokenConceptEmbedding&t)const{
+        if(meaning!=t.meaning||qualia!=t.qualia_intensity||stability!=t.semantic_stability||grounding!=t.grounding_value||embedding!=t.embedding)return false;
+        // Unset valence fields are NaN, so compare bits
+        for(size_t i=0;i<7;i++)if(bit_cast<uint64_t>(*valences.field(i))!=bit_cast<uint64_t>(*t.linked_valences.field(i)))return false;
+        return valences.overflow==t.linked_valences.overflow;}};
+static void collect_entity_refs(NeuronSlab&ns,vector<Neuron*>&out){out.clear();out.reserve(ns.size());for(Neuron&n:ns)out.push_back(&n);}
 void unified_consciousness_integration_engine(int generation){
     vector<double>psi_input;
     for(auto&q:consciousness.active_qualia){
@@ -2650,7 +2402,6 @@ void unified_consciousness_integration_engine(int generation){
     for(auto&tl:S.global_time_loops)tloops.push_back(tl.second);
     double psi_new=consciousness_formula.calculate_psi(generation,psi_input,H,R,A,M,O,B,F,S_val,S.current_valence,0.5,S.system_ribbons,tloops);
     consciousness_formula.psi_history.push_back(psi_new);
-    if(consciousness_formula.psi_history.size()>100)consciousness_formula.psi_history.erase(consciousness_formula.psi_history.begin());
     consciousness.phi_value=psi_new;
     consciousness.integrated_information=fabs(psi_new);
     consciousness.phenomenal_consciousness=consciousness_formula.multi_scale_phi;
@@ -2673,16 +2424,29 @@ void unified_consciousness_integration_engine(int generation){
     double gf=40.0+psi_new*20.0,tf=6.0+psi_new*2.0;
     consciousness.gamma_oscillations.push_back(sin(generation*gf*0.01));
     consciousness.theta_phase.push_back(sin(generation*tf*0.01));
-    if(consciousness.gamma_oscillations.size()>100)consciousness.gamma_oscillations.erase(consciousness.gamma_oscillations.begin());
-    if(consciousness.theta_phase.size()>100)consciousness.theta_phase.erase(consciousness.theta_phase.begin());
     consciousness.thalamocortical_binding=(gf/60.0)*consciousness.integrated_information;
     consciousness.re_entrant_processing_depth=hot_c*3.0;
     consciousness.pre_reflective_awareness=0.3+psi_new*0.3;
     consciousness.intentional_directedness=asp_c;
     consciousness.temporal_thickness=ed;
     consciousness.narrative_self_coherence=sd((double)S.valence_history.size()*S.metacognitive_awareness,100.0);
-    for(auto&te:token_concept_embedding_map){
-        TokenConceptEmbedding&tce=te.second;
+    ThreadPool&pool=ThreadPool::shared();
+    static vector<TokenConceptEmbedding*>tce_refs;
+    static vector<Goal*>goal_refs;
+    static vector<Concept*>concept_refs;
+    static vector<Neuron*>neuron_refs;
+    static vector<const string*>keys;
+    static vector<EntityPassEffects>fx;
+    collect_entity_refs(token_concept_embedding_map,tce_refs);
+    collect_entity_keys(token_concept_embedding_map,keys);
+    fx.resize(pool.chunk_count(tce_refs.size(),TOKEN_PASS_GRAIN));
+    for(auto&f:fx)f.clear();
+    pool.parallel_for(tce_refs.size(),TOKEN_PASS_GRAIN,[&](size_t chunk,size_t begin,size_t end){
+    EntityPassEffects&out=fx[chunk];
+    TokenFace before;
+    for(size_t k=begin;k<end;k++){
+        TokenConceptEmbedding&tce=*tce_refs[k];
+        before.read(tce);
         double act=tce.freq*0.01*consciousness.phi_value*(1.0+iit_c*0.5);
         tce.contextual_activation=min(1.0,act);
         tce.meaning+=psi_new*0.005;
@@ -2703,11 +2467,12 @@ void unified_consciousness_integration_engine(int generation){
             nq.emergence_gen=generation;
             nq.binding_strength=consciousness.thalamocortical_binding;
             nq.phenomenal_unity=consciousness.integrated_information;
-            nq.ribbon_signature=tce.token_ribbon;
-            nq.qualia_fractal=tce.token_fractal;
-            WM.add_qualia(nq);
-            consciousness.active_qualia.push_back(nq);
-            if(consciousness.active_qualia.size()>10)consciousness.active_qualia.erase(consciousness.active_qualia.begin());
+            if(const auto*tc=tce.cold.peek()){
+                QualiaCold&qc=nq.cold.get();
+                qc.ribbon_signature=tc->token_ribbon;
+                qc.qualia_fractal=tc->token_fractal;
+            }
+            out.qualia.push_back(std::move(nq));
         }
         tce.semantic_stability+=consciousness.complexity_metric*0.001;
         tce.semantic_stability=min(1.0,tce.semantic_stability);
@@ -2715,16 +2480,29 @@ void unified_consciousness_integration_engine(int generation){
         tce.grounding_value=min(1.0,tce.grounding_value);
         if(tce.attention_weights.empty())tce.attention_weights.resize(8,0.5);
         for(size_t i=0;i<tce.attention_weights.size();i++)tce.attention_weights[i]=tce.attention_weights[i]*0.9+asp_c*0.1;
-        tce.linked_valences["phi"]=psi_new;
-        tce.linked_valences["consciousness"]=consciousness.integrated_information;
-        tce.linked_valences["current"]=S.current_valence;
-        tce.linked_valences["ribbon"]=rib_c;
-        tce.linked_valences["temporal"]=tl_c;
-        tce.linked_valences["ffft"]=ffft_c;
-        if(tce.contextual_activation>0.6)WM.add_token(tce.name,tce.meaning);
-    }
-    for(auto&ge:goal_system){
-        Goal&goal=ge.second;
+        ValenceContext&lv=tce.linked_valences;
+        lv.phi=psi_new;
+        lv.consciousness=consciousness.integrated_information;
+        lv.current=S.current_valence;
+        lv.ribbon=rib_c;
+        lv.temporal=tl_c;
+        lv.ffft=ffft_c;
+        if(tce.contextual_activation>0.6)out.tokens.emplace_back(tce.name,tce.meaning);
+        if(!before.same(tce))out.changed.push_back(k);
+    }
+    });
+    for(auto&f:fx){
+        for(size_t k:f.changed)ModelChanges::mark(ModelStore::Embeddings,*keys[k]);
+        for(auto&q:f.qualia){WM.add_qualia(q);consciousness.active_qualia.push_back(q);}
+        for(auto&t:f.tokens)WM.add_token(t.first,t.second);
+    }
+    collect_entity_refs(goal_system,goal_refs);
+    fx.resize(pool.chunk_count(goal_refs.size(),GOAL_PASS_GRAIN));
+    for(auto&f:fx)f.clear();
+    pool.parallel_for(goal_refs.size(),GOAL_PASS_GRAIN,[&](size_t chunk,size_t begin,size_t end){
+    EntityPassEffects&out=fx[chunk];
+    for(size_t k=begin;k<end;k++){
+        Goal&goal=*goal_refs[k];
         goal.valence_alignment=S.current_valence;
         goal.qualia_binding=qb;
         goal.priority=goal.priority*0.95+consciousness.phi_value*0.05;
@@ -2734,18 +2512,31 @@ void unified_consciousness_integration_engine(int generation){
         goal.progress=min(1.0,goal.progress);
         if(goal.progress>0.5)goal.activation_threshold=0.2;
         if(consciousness.phi_value>goal.activation_threshold){
-            WM.add_goal(goal.name,goal.priority);
-            for(const string&sg:goal.subgoals)if(goal_system.count(sg))goal_system[sg].priority+=goal.priority*0.1;
+            out.goals.emplace_back(goal.name,goal.priority);
+            for(const string&sg:goal.subgoals)out.subgoal_boosts.emplace_back(sg,goal.priority*0.1);
         }
         goal.expected_utility=goal.priority*(1.0-goal.progress)*consciousness.integrated_information;
     }
-    for(auto&ce:S.concepts){
-        Concept&co=ce.second;
+    });
+    for(auto&f:fx){
+        for(auto&gp:f.goals)WM.add_goal(gp.first,gp.second);
+        for(auto&sb:f.subgoal_boosts){auto sit=goal_system.find(sb.first);if(sit!=goal_system.end())sit->second.priority+=sb.second;}
+    }
+    collect_entity_refs(S.concepts,concept_refs);
+    collect_entity_keys(S.concepts,keys);
+    fx.resize(pool.chunk_count(concept_refs.size(),CONCEPT_PASS_GRAIN));
+    for(auto&f:fx)f.clear();
+    pool.parallel_for(concept_refs.size(),CONCEPT_PASS_GRAIN,[&](size_t chunk,size_t begin,size_t end){
+    EntityPassEffects&out=fx[chunk];
+    for(size_t k=begin;k<end;k++){
+        Concept&co=*concept_refs[k];
+        double was=co.value;
         co.value+=psi_new*0.01;
         co.value=cv(co.value);
+        if(co.value!=was)out.changed.push_back(k);
         co.abstraction_level=hot_c*(1.0+consciousness.re_entrant_processing_depth*0.1);
         co.semantic_density=0.0;
-        for(const string&rw:co.related_words)if(token_concept_embedding_map.count(rw))co.semantic_density+=token_concept_embedding_map[rw].semantic_stability;
+        for(const string&rw:co.related_words){auto rit=token_concept_embedding_map.find(rw);if(rit!=token_concept_embedding_map.end())co.semantic_density+=rit->second.semantic_stability;}
         co.semantic_density/=max(1.0,(double)co.related_words.size());
         if(co.feature_vector.empty()){
             co.feature_vector["phi"]=psi_new;
@@ -2758,10 +2549,17 @@ void unified_consciousness_integration_engine(int generation){
             co.feature_vector["integration"]=co.feature_vector["integration"]*0.9+consciousness.integrated_information*0.1;
             co.feature_vector["ribbon"]=co.feature_vector.count("ribbon")?co.feature_vector["ribbon"]*0.9+rib_c*0.1:rib_c;
         }
-        if(co.semantic_density>0.7&&co.abstraction_level>0.5)WM.add_concept(co.name,co.value);
+        if(co.semantic_density>0.7&&co.abstraction_level>0.5)out.concepts.emplace_back(co.name,co.value);
     }
-    for(auto&ne:S.N){
-        Neuron&n=ne.second;
+    });
+    for(auto&f:fx){
+        for(size_t k:f.changed)ModelChanges::mark(ModelStore::Concepts,*keys[k]);
+        for(auto&cp:f.concepts)WM.add_concept(cp.first,cp.second);
+    }
+    collect_entity_refs(S.N,neuron_refs);
+    pool.parallel_for(neuron_refs.size(),NEURON_PASS_GRAIN,[&](size_t,size_t begin,size_t end){
+    for(size_t k=begin;k<end;k++){
+        Neuron&n=*neuron_refs[k];
         n.activation=tanh(n.weight+n.bias*psi_new);
         if(n.neuromod_levels.empty())n.neuromod_levels.resize(4,0.5);
         n.neuromod_levels[0]=n.neuromod_levels[0]*0.95+consciousness.phi_value*0.05;
@@ -2779,11 +2577,11 @@ void unified_consciousness_integration_engine(int generation){
         n.ribbon.entanglement_strength=n.ribbon.entanglement_strength*0.95+rib_c*0.05;
         n.ribbon.phase_coherence=n.ribbon.phase_coherence*0.95+consciousness.synchrony_metric*0.05;
     }
+    });
     world_model.model_accuracy=world_model.model_accuracy*0.99+consciousness.phi_value*0.01;
     world_model.prediction_error=fabs(psi_new-(consciousness_formula.psi_history.size()>1?consciousness_formula.psi_history[consciousness_formula.psi_history.size()-2]:psi_new));
-    if(world_model.confidence_history.size()>100)world_model.confidence_history.erase(world_model.confidence_history.begin());
     world_model.confidence_history.push_back(consciousness.integrated_information);
-    for(auto&ee:world_model.entity_states)ee.second=ee.second*0.95+psi_new*0.05;
+    for(auto&ee:world_model.entity_states){double was=ee.second;ee.second=ee.second*0.95+psi_new*0.05;if(ee.second!=was)ModelChanges::mark(ModelStore::WorldEntities,ee.first);}
     WM.decay_rate=0.95-consciousness.phi_value*0.05;
     WM.consolidation_threshold=0.5+consciousness.integrated_information*0.3;
     WM.central_executive_load=sd((double)WM.active_tokens.size()+(double)WM.active_concepts.size(),(double)(WM.capacity*2));
@@ -2799,7 +2597,8 @@ void unified_consciousness_integration_engine(int generation){
         if(rm.quantum_trace.empty())rm.quantum_trace.resize(3,complex<double>(0.5,0.0));
         for(size_t i=0;i<rm.quantum_trace.size();i++)rm.quantum_trace[i]*=complex<double>(cos(psi_new*0.05),sin(psi_new*0.05));
     }
-    for(size_t i=0;i<transformer_heads.size();i++){
+    pool.parallel_for(transformer_heads.size(),HEAD_PASS_GRAIN,[&](size_t,size_t begin,size_t end){
+    for(size_t i=begin;i<end;i++){
         TransformerHead&h=transformer_heads[i];
         h.head_importance_score=h.head_importance_score*0.95+consciousness.phi_value*0.05;
         for(size_t j=0;j<h.query_proj.size();j++){
@@ -2816,6 +2615,7 @@ void unified_consciousness_integration_engine(int generation){
         h.phi_attention_weights["integration"]=consciousness.integrated_information;
         h.phi_attention_weights["ribbon"]=rib_c;
     }
+    });
     S.emotional_system.valence=S.current_valence;
     S.emotional_system.arousal=consciousness.synchrony_metric;
     S.emotional_system.dominance=consciousness.phi_value;
@@ -2948,7 +2748,6 @@ void unified_consciousness_integration_engine(int generation){
         if(tl.second.phase>2.0*pi)tl.second.phase-=2.0*pi;
     }
     consciousness.conscious_cycles++;
-    if(S.valence_history.size()>100)S.valence_history.erase(S.valence_history.begin());
     S.valence_history.push_back(S.current_valence);
 }
 void decay_ngrams() {
@@ -2958,6 +2757,7 @@ void decay_ngrams() {
             // Reduce count by 1, but keep minimum of 1 if pattern exists
             if(w2_pair.second > 77) {
                 w2_pair.second--;
+                ModelChanges::mark(ModelStore::Bigrams, w1_pair.first);
             }
         }
     }
@@ -2966,8 +2766,9 @@ void decay_ngrams() {
     for(auto& w1_pair : bigram_counts) {
         auto it = w1_pair.second.begin();
         while(it != w1_pair.second.end()) {
-            if(it->second <= 1) {
+            if(PruneRules::weak_ngram(it->second)) {
                 it = w1_pair.second.erase(it);
+                ModelChanges::mark(ModelStore::Bigrams, w1_pair.first);
             } else {
                 ++it;
             }
@@ -2980,6 +2781,7 @@ void decay_ngrams() {
             for(auto& w3_pair : w2_pair.second) {
                 if(w3_pair.second > 1) {
                     w3_pair.second--;
+                    ModelChanges::mark(ModelStore::Trigrams, w1_pair.first, w2_pair.first);
                 }
             }
         }
@@ -2990,8 +2792,9 @@ void decay_ngrams() {
         for(auto& w2_pair : w1_pair.second) {
             auto it = w2_pair.second.begin();
             while(it != w2_pair.second.end()) {
-                if(it->second <= 1) {
+                if(PruneRules::weak_ngram(it->second)) {
                     it = w2_pair.second.erase(it);
+                    ModelChanges::mark(ModelStore::Trigrams, w1_pair.first, w2_pair.first);
                 } else {
                     ++it;
                 }
@@ -3017,6 +2820,7 @@ void bootstrapStrongPatterns() {
     bigram_counts["i"]["believe"] = 5;
     bigram_counts["i"]["wonder"] = 5;
     bigram_counts["i"]["recognize"] = 3;
+    ModelChanges::mark_all(ModelStore::Bigrams);
     cerr << "[BOOTSTRAP] Loaded " << bigram_counts.size() << " strong patterns" << endl;
 }
 
@@ -3047,6 +2851,74 @@ string selectCoherentSeed() {
     
     return "i"; // Fallback
 }
+// Lower-cased words of a corpus line with trailing punctuation removed.
+vector<string> tokenizeCorpusLine(const string& line) {
+    vector<string> tokens;
+    stringstream ss(line);
+    string word;
+    
+    while(ss >> word) {
+        string normalized = word;
+        transform(normalized.begin(), normalized.end(), 
+                 normalized.begin(), ::tolower);
+        
+        // Remove punctuation
+        while(!normalized.empty() && 
+              !isalnum(normalized.back())) {
+            normalized.pop_back();
+        }
+        
+        if(!normalized.empty()) {
+            tokens.push_back(normalized);
+        }
+    }
+    return tokens;
+}
+
+// Learns one corpus sentence; `index` is its position among the sentences
+// loaded so far and sets its valence and concept name.
+void learnCorpusSentence(const vector<string>& tokens, int index) {
+    // Start optimistic, then vary valence slightly for diversity
+    double base_valence = index == 0 ? 0.7 : 0.6 + (index % 5) * 0.05;
+    
+    // Learn words with context
+    for(const string& tok : tokens) {
+        learnWord(tok, base_valence);
+    }
+    
+    // Learn n-grams (THIS IS KEY)
+    processNGramsFromTokens(tokens);
+    
+    // Form concept from sentence
+    if(tokens.size() >= 4 && index % 3 == 0) {
+        vector<string> concept_words;
+        // Extract meaningful words (skip articles, etc)
+        for(const string& tok : tokens) {
+            string pos = getPartOfSpeech(tok);
+            if(pos == "NOUN" || pos == "VERB" || 
+               pos == "ADJECTIVE" || pos == "CONTENT") {
+                concept_words.push_back(tok);
+                if(concept_words.size() >= 4) break;
+            }
+        }
+        
+        if(concept_words.size() >= 2) {
+            string concept_name = "bootstrap_" + 
+                                 to_string(index);
+            createConceptAssociation(concept_name, 
+                                    concept_words);
+        }
+    }
+    
+    // Create episodic memory of learning
+    if(index % 10 == 0) {
+        string memory_content = "learned: " + 
+                               tokens[0] + " " + 
+                               (tokens.size() > 1 ? tokens[1] : "");
+        storeEpisodicMemory(memory_content, base_valence);
+    }
+}
+
 void loadBootstrapCorpus(const string& filename) {
     ifstream file(filename);
     if(!file) {
@@ -3056,76 +2928,17 @@ void loadBootstrapCorpus(const string& filename) {
     
     string line;
     int sentences_loaded = 0;
-    double base_valence = 0.7;  // Start optimistic
     
     while(getline(file, line)) {
         // Skip comments and empty lines
         if(line.empty() || line[0] == '#') continue;
         
-        // Tokenize
-        vector<string> tokens;
-        stringstream ss(line);
-        string word;
-        
-        while(ss >> word) {
-            string normalized = word;
-            transform(normalized.begin(), normalized.end(), 
-                     normalized.begin(), ::tolower);
-            
-            // Remove punctuation
-            while(!normalized.empty() && 
-                  !isalnum(normalized.back())) {
-                normalized.pop_back();
-            }
-            
-            if(!normalized.empty()) {
-                tokens.push_back(normalized);
-            }
-        }
-        
+        vector<string> tokens = tokenizeCorpusLine(line);
         if(tokens.size() < 3) continue;  // Skip too-short sentences
         
-        // Learn words with context
-        for(const string& tok : tokens) {
-            learnWord(tok, base_valence);
-        }
-        
-        // Learn n-grams (THIS IS KEY)
-        processNGramsFromTokens(tokens);
-        
-        // Form concept from sentence
-        if(tokens.size() >= 4 && sentences_loaded % 3 == 0) {
-            vector<string> concept_words;
-            // Extract meaningful words (skip articles, etc)
-            for(const string& tok : tokens) {
-                string pos = getPartOfSpeech(tok);
-                if(pos == "NOUN" || pos == "VERB" || 
-                   pos == "ADJECTIVE" || pos == "CONTENT") {
-                    concept_words.push_back(tok);
-                    if(concept_words.size() >= 4) break;
-                }
-            }
-            
-            if(concept_words.size() >= 2) {
-                string concept_name = "bootstrap_" + 
-                                     to_string(sentences_loaded);
-                createConceptAssociation(concept_name, 
-                                        concept_words);
-            }
-        }
-        
-        // Create episodic memory of learning
-        if(sentences_loaded % 10 == 0) {
-            string memory_content = "learned: " + 
-                                   tokens[0] + " " + 
-                                   (tokens.size() > 1 ? tokens[1] : "");
-            storeEpisodicMemory(memory_content, base_valence);
-        }
-        
+        LearningLog::record(LearningEventKind::CorpusLine, line, sentences_loaded);
+        learnCorpusSentence(tokens, sentences_loaded);
         sentences_loaded++;
-        
-        // Vary valence slightly for diversity
-        base_valence = 0.6 + (sentences_loaded % 5) * 0.05;
     }
     
     file.close();
@@ -3140,7 +2953,8 @@ void loadBootstrapCorpus(const string& filename) {
 }
 void decay_token_frequencies() {
     // Decay token frequencies to prevent overused words from dominating
-    for(auto& pair : token_concept_embedding_map) {
+    for(auto it = token_concept_embedding_map.begin(); it != token_concept_embedding_map.end(); ++it) {
+        auto& pair = *it;
         if(pair.second.freq > 5) {
             // Logarithmic decay - frequent words decay slower
             double decay_rate = 0.95 + (1.0 / (1.0 + log(pair.second.freq))) * 0.04;
@@ -3148,15 +2962,18 @@ void decay_token_frequencies() {
             
             // Ensure minimum frequency of 1
             if(pair.second.freq < 1) pair.second.freq = 1;
+            token_concept_embedding_map.touch(it);
         }
     }
     
     // Also decay S.tokens frequencies
-    for(auto& pair : S.tokens) {
+    for(auto it = S.tokens.begin(); it != S.tokens.end(); ++it) {
+        auto& pair = *it;
         if(pair.second.freq > 5) {
             double decay_rate = 0.95 + (1.0 / (1.0 + log(pair.second.freq))) * 0.04;
             pair.second.freq = (int)(pair.second.freq * decay_rate);
             if(pair.second.freq < 1) pair.second.freq = 1;
+            S.tokens.touch(it);
         }
     }
 }
@@ -3186,7 +3003,7 @@ void decay_embeddings() {
         // Remove very weak links
         auto it = tce.linked_concepts.begin();
         while(it != tce.linked_concepts.end()) {
-            if(it->second < 0.01) {
+            if(PruneRules::weak_link(it->second)) {
                 it = tce.linked_concepts.erase(it);
             } else {
                 ++it;
@@ -3199,6 +3016,7 @@ void decay_embeddings() {
             tce.attention_weights[i] -= diff * 0.02;
         }
     }
+    ModelChanges::mark_all(ModelStore::Embeddings);
 }
 
 void decay_goals() {
@@ -3224,7 +3042,7 @@ void decay_goals() {
     // Remove goals with very low priority and high completion
     auto it = goal_system.begin();
     while(it != goal_system.end()) {
-        if(it->second.priority < 0.1 && it->second.progress > 0.95) {
+        if(PruneRules::spent_goal(it->second)) {
             it = goal_system.erase(it);
         } else {
             ++it;
@@ -3249,21 +3067,10 @@ void decay_memories() {
     }
     
     // Remove very old, weak memories
-    auto it = S.episodic_memory.begin();
-    while(it != S.episodic_memory.end()) {
-        int age = S.g - it->gen;
-        if(age > 1000 && it->consolidation_strength < 0.3) {
-            it = S.episodic_memory.erase(it);
-        } else {
-            ++it;
-        }
-    }
-    
-    // Keep only most recent 150 memories
-    if(S.episodic_memory.size() > 150) {
-        S.episodic_memory.erase(S.episodic_memory.begin(), 
-                                S.episodic_memory.begin() + (S.episodic_memory.size() - 150));
-    }
+    // (the ring already bounds the store to its most recent entries)
+    S.episodic_memory.remove_if([](const Memory& m) {
+        return S.g - m.gen > 1000 && m.consolidation_strength < 0.3;
+    });
 }
 
 void decay_concepts() {
@@ -3287,10 +3094,12 @@ void decay_concepts() {
         }
     }
     
+    ModelChanges::mark_all(ModelStore::Concepts);
+    
     // Remove very weak concepts
     auto it = S.concepts.begin();
     while(it != S.concepts.end()) {
-        if(it->second.value < 0.2 && it->second.semantic_density < 0.3) {
+        if(PruneRules::weak_concept(it->second)) {
             it = S.concepts.erase(it);
         } else {
             ++it;
@@ -3300,6 +3109,9 @@ void decay_concepts() {
 
 
 void decay_world_model() {
+    ModelChanges::mark_all(ModelStore::WorldEntities);
+    ModelChanges::mark_all(ModelStore::WorldRelations);
+    
     // Decay entity states toward neutral
     for(auto& pair : world_model.entity_states) {
         double diff = pair.second - 0.5;
@@ -3317,7 +3129,7 @@ void decay_world_model() {
     for(auto& w1_pair : world_model.relationships) {
         auto it = w1_pair.second.begin();
         while(it != w1_pair.second.end()) {
-            if(it->second < 0.1) {
+            if(PruneRules::weak_relation(it->second)) {
                 it = w1_pair.second.erase(it);
             } else {
                 ++it;
@@ -3331,9 +3143,9 @@ void decay_world_model() {
     }
     
     // Decay confidence history
-    for(size_t i = 0; i < world_model.confidence_history.size(); i++) {
-        world_model.confidence_history[i] *= 0.99;
-    }
+    auto [conf_a, conf_b] = world_model.confidence_history.segments();
+    for(double& c : conf_a) c *= 0.99;
+    for(double& c : conf_b) c *= 0.99;
 }
 
 void decay_qualia() {
@@ -3346,14 +3158,9 @@ void decay_qualia() {
     }
     
     // Remove very weak qualia
-    auto it = consciousness.active_qualia.begin();
-    while(it != consciousness.active_qualia.end()) {
-        if(it->intensity < 0.2 && it->certainty < 0.3) {
-            it = consciousness.active_qualia.erase(it);
-        } else {
-            ++it;
-        }
-    }
+    consciousness.active_qualia.remove_if([](const Qualia& q) {
+        return q.intensity < 0.2 && q.certainty < 0.3;
+    });
 }
 
 void decay_transformer_heads() {
@@ -3400,61 +3207,182 @@ void comprehensive_system_decay() {
     if(S.metacognitive_awareness < 0.1) S.metacognitive_awareness = 0.1;
     if(S.attention_focus < 0.2) S.attention_focus = 0.2;
 }
-int main(){
+// Frequency weights for sample_weighted(). Re-run after bulk loads; afterwards entries are re-weighed incrementally as they are sampled.
+// Chat from the terminal input box: respond, then remember the exchange.
+void processDialogInput(const string& input){
+    string response = generateResponse(input);
+    
+    // Update globals AFTER processing
+    S.user_input = input;
+    S.dialog_response = response;
+    
+    // Generate follow-up internal thought
     try {
+        string internal = generateInternalThought();
+        S.internal_thoughts.push_back("[Processed]: " + internal);
+    } catch(...) {}
+    
+    S.dialog_timer = 20;
+    S.current_valence += 0.1;
+    S.current_valence = clamp_valence(S.current_valence);
+    
+    // Store memory
+    try {
+        storeEpisodicMemory("dialog:" + input.substr(0, 100), S.current_valence);
+    } catch(...) {}
+    
+    // Generate qualia
+    try {
+        generate_qualia("user_interaction", S.current_valence, 0.7);
+    } catch(...) {}
+}
+// Replay actions for the learning log; each mirrors the call site that
+// recorded the event.
+void register_learning_handlers(){
+    using K=LearningEventKind;
+    LearningLog::on(K::Chat,[](const LearningEvent&e){learnChatInput(tokenizeChatInput(e.text));});
+    LearningLog::on(K::ChatBatch,[](const LearningEvent&e){
+        vector<vector<string>> messages;
+        stringstream ss(e.text);
+        for(string line;getline(ss,line,'\n');)messages.push_back(tokenizeChatInput(line));
+        learnChatBatch(messages);
+    });
+    LearningLog::on(K::Dialog,[](const LearningEvent&e){processDialogInput(e.text);});
+    LearningLog::on(K::CorpusLine,[](const LearningEvent&e){
+        vector<string> tokens=tokenizeCorpusLine(e.text);
+        if(tokens.size()>=3)learnCorpusSentence(tokens,(int)e.arg);
+    });
+    LearningLog::on(K::LearnWord,[](const LearningEvent&e){learnWord(e.text,e.value);});
+    LearningLog::on(K::ConceptFormation,[](const LearningEvent&e){
+        vector<string> fields;
+        stringstream ss(e.text);
+        for(string f;getline(ss,f,'\n');)fields.push_back(f);
+        if(fields.size()>2)createConceptAssociation(fields[0],vector<string>(fields.begin()+1,fields.end()));
+    });
+    LearningLog::on(K::Mutation,[](const LearningEvent&){mutateN();});
+    LearningLog::on(K::Decay,[](const LearningEvent&){comprehensive_system_decay();});
+    LearningLog::on(K::ClearHistory,[](const LearningEvent&){clearHistory();});
+}
+void configure_samplers(){
+    token_concept_embedding_map.set_weight([](const TokenConceptEmbedding&t){return max(0.0,t.freq);});
+    S.tokens.set_weight([](const Token&t){return max(0.0,t.freq);});
+    token_concept_embedding_map.on_change([](const string*k){if(k)ModelChanges::mark(ModelStore::Embeddings,*k);else ModelChanges::mark_all(ModelStore::Embeddings);});
+    S.tokens.on_change([](const string*k){if(k)ModelChanges::mark(ModelStore::Tokens,*k);else ModelChanges::mark_all(ModelStore::Tokens);});
+}
+// First-run model: seed values, vocabulary, corpus patterns, heads and an
+// initial neuron population. `Nexus --build-bootstrap` saves the result.
+void bootstrap_first_run(){
+    S.D["m"] = 128;
+    S.D["vc"] = 0;
+    S.D["mc"] = 0;
+    S.dwt = 0.001;
+    S.current_valence = 0.0;
+    S.metacognitive_awareness = 0.0;
+    S.attention_focus = 0.3;
+    
+    for(int i = 0; i < 128; i++) {
+        S.D["w" + to_string(i)] = ri(4) - 1;
+    }
+    
+    S.cd = "evolve";
+    
+    // Load vocabulary
+    try {
+        loadEnglishDataset();
+        configure_samplers();
+        mathLangAssociation();
+        cout << "Bootstrapping . . . (This may take a while)" << endl;
+        loadBootstrapCorpus("corpus.txt");
+        bootstrapStrongPatterns();
+        bootstrapWithQualityExamples();
+    } catch(const exception& e) {
+        cerr << "Error loading vocabulary: " << e.what() << endl;
+    }
+
+    // Initialize transformer heads
+    for(int i = 0; i < 4; i++) {
+        TransformerHead head(16);
+        head.name = "head_" + to_string(i);
+        transformer_heads.push_back(head);
+    }
+    
+    // Initialize neurons
+    for(int i = 0; i < 50; i++) {
+        S.N.add(genN(0));
+    }
+}
+// Offline tools (src/tools) link this file with NEXUS_NO_MAIN for the model
+// globals and helpers, and bring their own main().
+#ifndef NEXUS_NO_MAIN
+int main(int argc, char** argv){
+    StartupTimes startup;
+    try {
+        ModelWriter::attach();
         module_integration::update_all_modules(S);
         module_integration::init_all_modules();
+        register_memory_stores();
+        register_learning_handlers();
+        
+        // Offline build of the first-run model
+        if(argc > 1 && string(argv[1]) == "--build-bootstrap") {
+            string path = argc > 2 ? argv[2] : NexusConfig::get().bootstrap_model;
+            return BootstrapModel::build(path, "corpus.txt", bootstrap_first_run) ? 0 : 1;
+        }
         srand(time(0));
         
-        // Load saved state
+        // Load saved state. With NEXUS_LAZY_LOAD the snapshot is mapped and
+        // the web API comes up on it while the lexicon is materialized.
+        unique_ptr<AGI_API> agi_api;
+        // Declared after agi_api so it runs first on the way out: handlers
+        // waiting on a model write are released before the server joins them
+        struct StopWriter { ~StopWriter() { LearningQueue::close(); ModelWriter::close(); } } stop_writer;
+        auto load_start = chrono::steady_clock::now();
         try {
-            ld("state.dat");
+            startup.lazy = NexusConfig::get().lazy_load && ld_lazy("state.dat");
+            if(!startup.lazy) ld("state.dat");
         } catch(const exception& e) {
             cerr << "Error loading state: " << e.what() << ", starting fresh." << endl;
         }
-        
-        // Initialize if this is first run
-        if(S.g == 0) {
-            S.D["m"] = 128;
-            S.D["vc"] = 0;
-            S.D["mc"] = 0;
-            S.dwt = 0.001;
-            S.current_valence = 0.0;
-            S.metacognitive_awareness = 0.0;
-            S.attention_focus = 0.3;
-            
-            for(int i = 0; i < 128; i++) {
-                S.D["w" + to_string(i)] = ri(4) - 1;
-            }
-            
-            S.cd = "evolve";
-            
-            // Load vocabulary
+        startup.load_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - load_start).count();
+        if(startup.lazy) {
             try {
-                loadEnglishDataset();
-                mathLangAssociation();
-                cout << "Bootstrapping . . . (This may take a while)" << endl;
-                loadBootstrapCorpus("corpus.txt");
-                bootstrapStrongPatterns();
-                bootstrapWithQualityExamples();
+                agi_api = make_unique<AGI_API>(8080);
+                agi_api->hold_writes();
+                agi_api->set_startup(startup);
+                agi_api->start();
+                cout << "[WebServer] Started on http://localhost:8080, lexicon served from the mapped snapshot" << endl;
             } catch(const exception& e) {
-                cerr << "Error loading vocabulary: " << e.what() << endl;
-            }
-
-            // Initialize transformer heads
-            for(int i = 0; i < 4; i++) {
-                TransformerHead head(16);
-                head.name = "head_" + to_string(i);
-                transformer_heads.push_back(head);
+                cerr << "[WebServer] Failed to start: " << e.what() << endl;
             }
-            
-            // Initialize neurons
-            for(int i = 0; i < 50; i++) {
-                Neuron n = genN(0);
-                S.N[n.id] = n;
+            promote_lexicon();
+        }
+        configure_samplers();
+        
+        // Re-apply what was learned after the last checkpoint
+        try {
+            LearningLog::recover("state.dat", S.g != 0);
+        } catch(const exception& e) {
+            cerr << "Error replaying learning log: " << e.what() << endl;
+        }
+        
+        // Initialize if this is first run, from the prebuilt model when there is one
+        if(S.g == 0) {
+            if(BootstrapModel::load(NexusConfig::get().bootstrap_model, "corpus.txt")) {
+                configure_samplers();
+                S.cd = "evolve";
+            } else {
+                bootstrap_first_run();
             }
         }
         
+        startup.ready_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - startup.process_start).count();
+        cout << "[Startup] state loaded in " << fixed << setprecision(1) << startup.load_ms << " ms"
+             << (startup.lazy ? " (lazy)" : "") << ", ready in " << startup.ready_ms << " ms" << endl;
+        // First view and status documents for API readers; the loop
+        // republishes both every tick
+        ModelSnapshot::publish();
+        StatusSnapshot::publish();
+        
         // Initialize ncurses
         initscr();
         cbreak();
@@ -3464,14 +3392,20 @@ int main(){
         keypad(stdscr, TRUE);
         
         // Start web server for modern UI
-        unique_ptr<AGI_API> agi_api;
-        try {
-            agi_api = make_unique<AGI_API>(8080);
-            agi_api->start();
-            cout << "\n[WebServer] Started on http://localhost:8080" << endl;
-            this_thread::sleep_for(chrono::milliseconds(500));
-        } catch(const exception& e) {
-            cerr << "[WebServer] Failed to start: " << e.what() << endl;
+        if(!agi_api) {
+            try {
+                agi_api = make_unique<AGI_API>(8080);
+                agi_api->set_startup(startup);
+                agi_api->start();
+                cout << "\n[WebServer] Started on http://localhost:8080" << endl;
+                this_thread::sleep_for(chrono::milliseconds(500));
+            } catch(const exception& e) {
+                cerr << "[WebServer] Failed to start: " << e.what() << endl;
+            }
+        }
+        if(agi_api) {
+            agi_api->set_startup(startup);
+            agi_api->allow_writes();
         }
         
         bool running = true;
@@ -3512,8 +3446,10 @@ int main(){
                         refresh();
                         this_thread::sleep_for(chrono::seconds(2));
                         error_count = 0;
-                        // Try to save emergency state
+                        // Try to save emergency state; the learning log
+                        // already holds everything since the last checkpoint
                         try {
+                            LearningLog::flush();
                             sv("state_emergency.dat");
                         } catch(...) {}
                     }
@@ -3559,7 +3495,7 @@ int main(){
                         int attempts = 0;
                         
                         while(attempts < 3) {
-                            auto_thought = generate_with_beam_search("i", 8, ctx, 3);
+                            auto_thought = generate_with_beam_search(*ModelSnapshot::current(), "i", 8, ctx, 3);
                             if(!isSentenceTooSimilar(auto_thought)) {
                                 break;
                             }
@@ -3570,9 +3506,6 @@ int main(){
                         trackGeneratedSentence(auto_thought);
                         
                         S.internal_thoughts.push_back(auto_thought);
-                        if(S.internal_thoughts.size() > 5) {
-                            S.internal_thoughts.erase(S.internal_thoughts.begin());
-                        }
                     } catch(...) {
                         // Silent failure for autonomous thoughts
                     }
@@ -3633,27 +3566,41 @@ int main(){
                     batch16Process();
                     
                     double wsum = 0;
+                    undo_log.save_entry(S.D, "m");
                     for(int i = 0; i < S.D["m"]; i++) {
-                        wsum += S.D["w" + to_string(i)] + 2;
+                        string key = "w" + to_string(i);
+                        undo_log.save_entry(S.D, key);
+                        wsum += S.D[key] + 2;
                     }
+                    undo_log.save_entry(S.D, "vc");
                     S.D["vc"] = (int)wsum % 1000;
                     
+                    undo_log.save(S.dwt);
+                    undo_log.save(S.hdt_val);
+                    undo_log.save(S.al);
+                    undo_log.save(S.metacognitive_awareness);
                     if(S.g == 0) S.dwt = 0.001;
                     S.hdt_val = calcHDT(S.g, S.bh, S.qe, S.te);
                     S.al = calcAwarenessLevel();
                     S.metacognitive_awareness = calcMetacognitiveAwareness();
                     counterfactualAnalysis();
                     
+                    undo_log.save(S.sentience_ratio);
+                    undo_log.save(S.peak_sentience_gen);
                     S.sentience_ratio = calcSentienceRatio();
                     if(S.sentience_ratio > S.peak_sentience_gen) {
                         S.peak_sentience_gen = S.g;
                     }
                     
+                    undo_log.save(S.valence_history);
                     S.valence_history.push_back(S.current_valence);
-                    if(S.valence_history.size() > 50) {
-                        S.valence_history.erase(S.valence_history.begin());
-                    }
+                    // The ring holds up to 101 for the consciousness engine's
+                    // push; between ticks the window stays at 50.
+                    if(S.valence_history.size() > 50) S.valence_history.drop_front(S.valence_history.size() - 50);
+                    cm();
                 } catch(const exception& e) {
+                    // Leave the model as it was before the failed tick
+                    rb();
                     mvprintw(row++, 0, "Processing error: %s", e.what());
                 }
                 
@@ -3676,8 +3623,8 @@ int main(){
                 // === VOCABULARY EXPANSION ===
                 if(S.g % 20 == 0 && !token_concept_embedding_map.empty()) {
                     try {
-                        auto it = token_concept_embedding_map.begin();
-                        advance(it, ri(token_concept_embedding_map.size()));
+                        auto it = token_concept_embedding_map.at_index(ri(token_concept_embedding_map.size()));
+                        LearningLog::record(LearningEventKind::LearnWord, it->first, 0, S.current_valence);
                         learnWord(it->first, S.current_valence);
                     } catch(...) {}
                 }
@@ -3686,14 +3633,19 @@ int main(){
                 if(S.g % 25 == 0) {
                     try {
                         vector<string> sample_words;
-                        for(auto& p : token_concept_embedding_map) {
-                            if(p.second.freq > 1 && rn() < 0.3) {
-                                sample_words.push_back(p.first);
+                        for(int tries = 0; tries < 8 && sample_words.size() < 3; tries++) {
+                            auto it = token_concept_embedding_map.sample_weighted(rn());
+                            if(it == token_concept_embedding_map.end()) break;
+                            if(it->second.freq > 1 && find(sample_words.begin(), sample_words.end(), it->first) == sample_words.end()) {
+                                sample_words.push_back(it->first);
                             }
-                            if(sample_words.size() >= 3) break;
                         }
                         if(sample_words.size() > 1) {
-                            createConceptAssociation("C_" + to_string(S.g), sample_words);
+                            string name = "C_" + to_string(S.g);
+                            string event = name;
+                            for(const string& w : sample_words) event += "\n" + w;
+                            LearningLog::record(LearningEventKind::ConceptFormation, event);
+                            createConceptAssociation(name, sample_words);
                         }
                     } catch(...) {}
                 }
@@ -3701,6 +3653,7 @@ int main(){
                 // === NEURAL MUTATION ===
                 if(S.g % 12 == 0 && !S.N.empty()) {
                     try {
+                        LearningLog::record(LearningEventKind::Mutation);
                         mutateN();
                     } catch(...) {}
                 }
@@ -3770,32 +3723,47 @@ int main(){
                 row++;
                 
                 // === STATS LINE ===
-                mvprintw(row, 0, "Vocab:%lu | Patterns:%lu | Neurons:%lu | Gen:%d | Errors:%d",
+                mvprintw(row, 0, "Vocab:%lu | Patterns:%lu | Neurons:%lu | Gen:%d | Errors:%d | View:%.1fms | ChatQ:%lu",
                     (unsigned long)token_concept_embedding_map.size(),
                     (unsigned long)bigram_counts.size(),
                     (unsigned long)S.N.size(),
                     S.g,
-                    error_count);
+                    error_count,
+                    ModelSnapshot::stats().publish_ms,
+                    (unsigned long)LearningQueue::stats().depth);
+                clrtoeol();
+                row++;
+                MemoryAccounting::update(S.g);
+                mvprintw(row, 0, "%s", MemoryAccounting::summary_line().c_str());
                 clrtoeol();
                 row++;
                 
                 refresh();
                 S.g++;
                 
+                // === TICK BOUNDARY ===
+                // Queued chat input and API writes (load, import) are applied
+                // here; then readers get a view of the finished tick
+                LearningBatch chat_batch = LearningQueue::take();
+                if(!chat_batch.messages.empty()) learnChatBatch(chat_batch.messages);
+                ModelWriter::tick();
+                LearningQueue::release(chat_batch.last);
+                
                 // === AUTO-SAVE ===
-                if(S.g % 100 == 0) {
-                    try {
-                        sv("state.dat");
-                        mvprintw(row, 0, "[Autosaved at gen %d]", S.g);
-                        clrtoeol();
-                        refresh();
-                        this_thread::sleep_for(chrono::milliseconds(500));
-                    } catch(const exception& e) {
-                        mvprintw(row, 0, "[Autosave failed: %s]", e.what());
-                        clrtoeol();
-                        refresh();
-                        this_thread::sleep_for(chrono::milliseconds(500));
+                // Captured here, written on the persistence worker
+                if(S.g % 100 == 0) PersistenceService::request("state.dat");
+                PersistenceService::poll();
+                {
+                    SaveStatus ss = PersistenceService::status();
+                    if(ss.state == "saving") {
+                        mvprintw(row, 0, "[Saving gen %d in background...]", ss.generation);
+                    } else if(ss.last_result == "error") {
+                        mvprintw(row, 0, "[Autosave failed: %s]", ss.last_error.c_str());
+                    } else if(ss.last_result == "ok") {
+                        mvprintw(row, 0, "[Saved gen %d: %s, capture %.1f ms, write %.1f ms]",
+                                 ss.generation, ss.last_kind.c_str(), ss.capture_ms, ss.write_ms);
                     }
+                    clrtoeol();
                 }
                 
                 // === INPUT HANDLING ===
@@ -3919,37 +3887,8 @@ int main(){
                                             (int)combined_input.length());
                                     refresh();
                                     
-                                    // Process the input (LOCAL COPY)
-                                    string response = generateResponse(combined_input);
-                                    
-                                    // Update globals AFTER processing
-                                    S.user_input = combined_input;
-                                    S.dialog_response = response;
-                                    
-                                    // Generate follow-up internal thought
-                                    try {
-                                        string internal = generateInternalThought();
-                                        S.internal_thoughts.push_back("[Processed]: " + internal);
-                                        
-                                        if(S.internal_thoughts.size() > 5) {
-                                            S.internal_thoughts.erase(S.internal_thoughts.begin());
-                                        }
-                                    } catch(...) {}
-                                    
-                                    S.dialog_timer = 20;
-                                    S.current_valence += 0.1;
-                                    S.current_valence = clamp_valence(S.current_valence);
-                                    
-                                    // Store memory
-                                    try {
-                                        storeEpisodicMemory("dialog:" + combined_input.substr(0, 100), 
-                                                          S.current_valence);
-                                    } catch(...) {}
-                                    
-                                    // Generate qualia
-                                    try {
-                                        generate_qualia("user_interaction", S.current_valence, 0.7);
-                                    } catch(...) {}
+                                    LearningLog::record(LearningEventKind::Dialog, combined_input);
+                                    processDialogInput(combined_input);
                                     
                                     error_count = 0; // Reset on successful input
                                     
@@ -4004,7 +3943,7 @@ int main(){
                         int attempts = 0;
                         
                         while(attempts < 5) {
-                            generated = generate_with_beam_search("i", 10, ctx, 5);
+                            generated = generate_with_beam_search(*ModelSnapshot::current(), "i", 10, ctx, 5);
                             if(!isSentenceTooSimilar(generated)) {
                                 break;
                             }
@@ -4015,9 +3954,6 @@ int main(){
                         trackGeneratedSentence(generated);
                         
                         S.internal_thoughts.push_back(generated);
-                        if(S.internal_thoughts.size() > 5) {
-                            S.internal_thoughts.erase(S.internal_thoughts.begin());
-                        }
                         S.current_valence += 0.05;
                         error_count = 0;
                     } catch(const exception& e) {
@@ -4028,6 +3964,7 @@ int main(){
                 else if(ch == 'd' || ch == 'D') {
                     // === MANUAL DECAY TRIGGER ===
                     try {
+                        LearningLog::record(LearningEventKind::Decay);
                         comprehensive_system_decay();
                         mvprintw(row + 1, 0, "[System decay applied at gen %d]", S.g);
                         clrtoeol();
@@ -4045,8 +3982,9 @@ int main(){
                 else if(ch == 's' || ch == 'S') {
                     // === MANUAL SAVE ===
                     try {
-                        sv("state.dat");
-                        mvprintw(row + 1, 0, "[Saved state at gen %d]", S.g);
+                        PersistenceService::request("state.dat");
+                        PersistenceService::poll();
+                        mvprintw(row + 1, 0, "[Saving state at gen %d]", S.g);
                         clrtoeol();
                         refresh();
                         this_thread::sleep_for(chrono::milliseconds(1000));
@@ -4065,7 +4003,7 @@ int main(){
                         mvprintw(row + 1, 0, "[Saving and exiting...]");
                         clrtoeol();
                         refresh();
-                        sv("state.dat");
+                        checkpoint("state.dat");
                     } catch(const exception& e) {
                         cerr << "Error saving on exit: " << e.what() << endl;
                     }
@@ -4093,6 +4031,7 @@ int main(){
                 // Try to save emergency state every 5 errors
                 if(error_count % 5 == 0) {
                     try {
+                        LearningLog::flush();
                         sv("state_emergency.dat");
                     } catch(...) {}
                 }
@@ -4125,6 +4064,7 @@ int main(){
         
         // Clean up ncurses
         endwin();
+        LearningLog::close();
         
         cout << "\nNEXUS shutdown complete. State saved.\n";
         
@@ -4138,6 +4078,7 @@ int main(){
         
         // Try emergency save
         try {
+            LearningLog::flush();
             sv("state_fatal_error.dat");
             cerr << "Emergency state saved to state_fatal_error.dat" << endl;
         } catch(...) {
@@ -4162,3 +4103,4 @@ int main(){
     
     return 0;
 }
+#endif // NEXUS_NO_MAIN
@@ -0,0 +1,133 @@
+#include "memory_accounting.h"
+#include "json.h"
+#include <mutex>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+std::vector<MemoryAccounting::Store> MemoryAccounting::stores_;
+
+namespace {
+std::mutex report_mutex;
+std::shared_ptr<const MemoryReport> published_report = std::make_shared<MemoryReport>();
+
+size_t read_rss_bytes() {
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    size_t total_pages = 0, resident_pages = 0;
+    if (statm >> total_pages >> resident_pages) {
+        return resident_pages * (size_t)sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return 0;
+}
+}
+
+void MemoryAccounting::register_store(const std::string& subsystem, const std::string& store,
+                                      std::function<size_t()> count, Sampler sampler,
+                                      size_t fixed_bytes) {
+    Store s;
+    s.stats.subsystem = subsystem;
+    s.stats.store = store;
+    s.count = std::move(count);
+    s.sampler = std::move(sampler);
+    s.fixed_bytes = fixed_bytes;
+    stores_.push_back(std::move(s));
+}
+
+void MemoryAccounting::update(int generation, size_t sample_budget) {
+    auto report = std::make_shared<MemoryReport>();
+    report->generation = generation;
+    report->stores.reserve(stores_.size());
+
+    for (auto& s : stores_) {
+        size_t bytes = 0, sampled = 0;
+        s.sampler(sample_budget, bytes, sampled);
+        if (sampled > 0) {
+            double avg = (double)bytes / (double)sampled;
+            // The first pass seeds the average; afterwards it moves slowly so
+            // one unusual batch does not swing the report.
+            s.stats.bytes_per_entry = s.seeded ? s.stats.bytes_per_entry * 0.8 + avg * 0.2 : avg;
+            s.seeded = true;
+        }
+        s.stats.entries = s.count();
+        s.stats.bytes = s.fixed_bytes + (size_t)(s.stats.bytes_per_entry * (double)s.stats.entries);
+        report->total_bytes += s.stats.bytes;
+        report->total_entries += s.stats.entries;
+        report->stores.push_back(s.stats);
+    }
+    report->rss_bytes = read_rss_bytes();
+
+    std::lock_guard<std::mutex> lock(report_mutex);
+    published_report = std::move(report);
+}
+
+std::shared_ptr<const MemoryReport> MemoryAccounting::report() {
+    std::lock_guard<std::mutex> lock(report_mutex);
+    return published_report;
+}
+
+std::string MemoryAccounting::format_bytes(size_t bytes) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    if (bytes >= (1ull << 30)) oss << (double)bytes / (1ull << 30) << "G";
+    else if (bytes >= (1ull << 20)) oss << (double)bytes / (1ull << 20) << "M";
+    else if (bytes >= (1ull << 10)) oss << (double)bytes / (1ull << 10) << "K";
+    else oss << std::setprecision(0) << (double)bytes << "B";
+    return oss.str();
+}
+
+std::string MemoryAccounting::to_json() {
+    auto r = report();
+    std::string body;
+    JsonWriter out(body);
+    out.begin_object()
+        .field("generation", r->generation)
+        .field("total_bytes", r->total_bytes)
+        .field("total_entries", r->total_entries)
+        .field("rss_bytes", r->rss_bytes)
+        .key("subsystems").begin_object();
+
+    // Stores are registered grouped by subsystem; emit them in that order.
+    size_t i = 0;
+    while (i < r->stores.size()) {
+        const std::string& sub = r->stores[i].subsystem;
+        size_t j = i, sub_bytes = 0, sub_entries = 0;
+        for (; j < r->stores.size() && r->stores[j].subsystem == sub; ++j) {
+            sub_bytes += r->stores[j].bytes;
+            sub_entries += r->stores[j].entries;
+        }
+        out.key(sub).begin_object()
+            .field("bytes", sub_bytes)
+            .field("entries", sub_entries)
+            .key("stores").begin_object();
+        for (size_t k = i; k < j; ++k) {
+            const auto& st = r->stores[k];
+            out.key(st.store).begin_object()
+                .field("bytes", st.bytes)
+                .field("entries", st.entries)
+                .field("bytes_per_entry", st.bytes_per_entry, 1)
+                .end_object();
+        }
+        out.end_object().end_object();
+        i = j;
+    }
+    out.end_object().end_object();
+    return body;
+}
+
+std::string MemoryAccounting::summary_line() {
+    auto r = report();
+    const MemoryStoreStats* top = nullptr;
+    for (const auto& st : r->stores) {
+        if (!top || st.bytes > top->bytes) top = &st;
+    }
+    std::ostringstream oss;
+    oss << "Mem:~" << format_bytes(r->total_bytes);
+    if (r->rss_bytes) oss << " | RSS:" << format_bytes(r->rss_bytes);
+    if (top) oss << " | Top:" << top->subsystem << "/" << top->store << " " << format_bytes(top->bytes);
+    return oss.str();
+}
@@ -0,0 +1,116 @@
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <functional>
+#include <cstddef>
+
+// Structural memory accounting for the model stores.
+//
+// Each registered store supplies an O(1) entry count and a sampler that
+// measures the heap footprint of a handful of entries per call. update() runs
+// once per tick, advances every sampler by a fixed budget and folds the result
+// into a rolling bytes-per-entry average, so the estimate tracks the stores
+// without ever walking them in full. The latest figures are published as an
+// immutable report that the HTTP and UI threads can read at any time.
+
+struct MemoryStoreStats {
+    std::string subsystem;
+    std::string store;
+    size_t entries = 0;
+    size_t bytes = 0;
+    double bytes_per_entry = 0.0;
+};
+
+struct MemoryReport {
+    int generation = 0;
+    size_t total_bytes = 0;
+    size_t total_entries = 0;
+    size_t rss_bytes = 0;  // 0 when the platform does not expose it
+    std::vector<MemoryStoreStats> stores;
+};
+
+class MemoryAccounting {
+public:
+    // Measures up to `budget` entries starting at the store's private cursor;
+    // returns the bytes seen and how many entries were actually measured.
+    using Sampler = std::function<void(size_t budget, size_t& bytes, size_t& sampled)>;
+
+    static void register_store(const std::string& subsystem, const std::string& store,
+                               std::function<size_t()> count, Sampler sampler,
+                               size_t fixed_bytes = 0);
+    static void update(int generation, size_t sample_budget = 32);
+    static std::shared_ptr<const MemoryReport> report();
+    static std::string to_json();
+    static std::string summary_line();
+    static std::string format_bytes(size_t bytes);
+
+    // Cursor-based sampler over an ordered map. The cursor is a key, so
+    // insertions and erasures between ticks never invalidate it.
+    template<typename Map, typename EntryBytes>
+    static Sampler map_sampler(Map& m, EntryBytes entry_bytes) {
+        auto cursor = std::make_shared<std::pair<bool, typename Map::key_type>>();
+        return [&m, cursor, entry_bytes](size_t budget, size_t& bytes, size_t& sampled) {
+            if (m.empty()) return;
+            auto it = cursor->first ? m.upper_bound(cursor->second) : m.begin();
+            for (size_t i = 0; i < budget && i < m.size(); ++i) {
+                if (it == m.end()) it = m.begin();
+                bytes += node_overhead + entry_bytes(it->first, it->second);
+                ++sampled;
+                cursor->first = true;
+                cursor->second = it->first;
+                ++it;
+            }
+        };
+    }
+
+    // Index-cursor sampler over any container with size() and operator[].
+    template<typename Seq, typename EntryBytes>
+    static Sampler seq_sampler(Seq& v, EntryBytes entry_bytes) {
+        auto cursor = std::make_shared<size_t>(0);
+        return [&v, cursor, entry_bytes](size_t budget, size_t& bytes, size_t& sampled) {
+            for (size_t i = 0; i < budget && i < v.size(); ++i) {
+                if (*cursor >= v.size()) *cursor = 0;
+                bytes += entry_bytes(v[*cursor]);
+                ++sampled;
+                ++*cursor;
+            }
+        };
+    }
+
+    // Approximate per-node overhead of std::map / std::set (three pointers
+    // and the colour word).
+    static constexpr size_t node_overhead = 32;
+
+    static size_t heap_bytes(const std::string& s) {
+        // Short strings live in the SSO buffer and cost nothing extra.
+        return s.capacity() > 15 ? s.capacity() + 1 : 0;
+    }
+    template<typename T>
+    static size_t heap_bytes(const std::vector<T>& v) { return v.capacity() * sizeof(T); }
+    template<typename K, typename V>
+    static size_t heap_bytes(const std::map<K, V>& m) {
+        return m.size() * (node_overhead + sizeof(std::pair<const K, V>));
+    }
+    static size_t heap_bytes(const std::map<std::string, double>& m) {
+        size_t b = m.size() * (node_overhead + sizeof(std::pair<const std::string, double>));
+        for (const auto& e : m) b += heap_bytes(e.first);
+        return b;
+    }
+
+private:
+    struct Store {
+        MemoryStoreStats stats;
+        std::function<size_t()> count;
+        Sampler sampler;
+        size_t fixed_bytes = 0;
+        bool seeded = false;
+    };
+
+    static std::vector<Store> stores_;
+};
+
+#endif
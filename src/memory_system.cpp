@@ -12,7 +12,7 @@ std::map<std::string, SemanticMemory> MemorySystem::semantic_store_;
 
 // Fix external declarations with correct types
 extern std::random_device rd;
-extern std::mt19937 rng;
+extern thread_local std::mt19937 rng;
 
 void MemorySystem::initialize() {
     // Renamed local type for clarity and added std::
@@ -0,0 +1,34 @@
+#include "model_changes.h"
+
+namespace {
+ModelChangeSet everything() {
+    ModelChangeSet c;
+    c.mark_all();
+    return c;
+}
+ModelChangeSet pending[(size_t)ModelReader::Count] = {everything(), everything()};
+}
+
+void ModelChanges::mark(ModelStore s, const std::string& key, const std::string& key2) {
+    for (ModelChangeSet& p : pending) {
+        // Keys are not kept for a store that is already marked whole
+        if (!p.all[(size_t)s]) p.keys[(size_t)s].emplace(key, key2);
+    }
+}
+
+void ModelChanges::mark_all(ModelStore s) {
+    for (ModelChangeSet& p : pending) {
+        p.all[(size_t)s] = true;
+        p.keys[(size_t)s].clear();
+    }
+}
+
+void ModelChanges::mark_all() {
+    for (size_t s = 0; s < (size_t)ModelStore::Count; s++) mark_all((ModelStore)s);
+}
+
+ModelChangeSet ModelChanges::take(ModelReader reader) {
+    ModelChangeSet out;
+    std::swap(out, pending[(size_t)reader]);
+    return out;
+}
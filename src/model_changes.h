@@ -0,0 +1,56 @@
+#ifndef MODEL_CHANGES_H
+#define MODEL_CHANGES_H
+
+#include <cstddef>
+#include <set>
+#include <string>
+#include <utility>
+
+// Which entries of the live model changed, recorded where they change.
+//
+// Every write to a tracked store marks the key it wrote. Each reader takes
+// the keys marked since its own last take(): ModelSnapshot::publish() at the
+// tick boundary re-reads only those entries, and a delta checkpoint
+// fingerprints only those. The embeddings and S.tokens are SampledMaps and
+// mark through their change hook (see configure_samplers in main.cpp):
+// inserts and erases mark themselves, in-place writes call touch(). The
+// n-gram tables, the concepts and the world model are plain maps and are
+// marked by their write sites.
+//
+// The integration engine visits every token, concept and world entity each
+// tick but marks only those it actually changed. A pass that rewrites a whole
+// store (decay) marks the store as a whole instead of key by key, and so does
+// anything that loads or swaps in a model; the reader then walks that store
+// once. Until a reader's first take() every store counts as changed.
+//
+// Loop thread only, like the stores themselves.
+
+enum class ModelStore { Embeddings, Bigrams, Trigrams, Concepts, Tokens, WorldEntities, WorldRelations, Count };
+enum class ModelReader { View, Checkpoint, Count };
+
+struct ModelChangeSet {
+    // Trigram rows are keyed by (w1, w2); the other stores by first alone.
+    // World relation rows are keyed by their cause.
+    using Key = std::pair<std::string, std::string>;
+
+    std::set<Key> keys[(size_t)ModelStore::Count];
+    bool all[(size_t)ModelStore::Count] = {};
+
+    const std::set<Key>& of(ModelStore s) const { return keys[(size_t)s]; }
+    bool whole(ModelStore s) const { return all[(size_t)s]; }
+    void mark_all() {
+        for (auto& k : keys) k.clear();
+        for (bool& a : all) a = true;
+    }
+};
+
+class ModelChanges {
+public:
+    static void mark(ModelStore s, const std::string& key, const std::string& key2 = std::string());
+    static void mark_all(ModelStore s);
+    static void mark_all();
+    // Changes marked since `reader` last took them; starts a new set for it.
+    static ModelChangeSet take(ModelReader reader);
+};
+
+#endif
@@ -0,0 +1,280 @@
+#include "model_snapshot.h"
+#include "model_changes.h"
+#include "state.h"
+#include "status_snapshot.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+// ===== VIEW =====
+
+const ModelView::Token* ModelView::token(const std::string& word) const {
+    auto* t = tokens.get(word);
+    return t ? t->get() : nullptr;
+}
+
+const ModelView::Counts* ModelView::bigram_row(const std::string& w1) const {
+    auto* row = bigrams.get(w1);
+    return row ? row->get() : nullptr;
+}
+
+const ModelView::Counts* ModelView::trigram_row(const std::string& w1, const std::string& w2) const {
+    const Rows* rows = trigrams.get(w1);
+    if (!rows) return nullptr;
+    auto* row = rows->get(w2);
+    return row ? row->get() : nullptr;
+}
+
+int ModelView::bigram(const std::string& w1, const std::string& w2) const {
+    const Counts* row = bigram_row(w1);
+    if (!row) return 0;
+    auto it = row->find(w2);
+    return it != row->end() ? it->second : 0;
+}
+
+int ModelView::trigram(const std::string& w1, const std::string& w2, const std::string& w3) const {
+    const Counts* row = trigram_row(w1, w2);
+    if (!row) return 0;
+    auto it = row->find(w3);
+    return it != row->end() ? it->second : 0;
+}
+
+// ===== PUBLICATION =====
+
+namespace {
+std::atomic<std::shared_ptr<const ModelView>> current_view{std::make_shared<const ModelView>()};
+std::atomic<uint64_t> epoch{0};
+std::atomic<double> publish_ms{0};
+std::atomic<size_t> published{0};
+
+struct PendingWrite {
+    std::function<void()> fn;
+    std::exception_ptr error;
+    bool done = false;
+};
+
+std::mutex writes_mutex;
+std::condition_variable writes_done;
+std::deque<PendingWrite*> pending;     // owned by their submit() frames
+bool closed = false;
+uint64_t applied = 0;
+std::atomic<std::thread::id> loop_thread{};
+}
+
+std::shared_ptr<const ModelView> ModelSnapshot::current() {
+    return current_view.load(std::memory_order_acquire);
+}
+
+namespace {
+bool same_valences(const std::vector<std::pair<std::string, double>>& v, const ValenceContext& lv) {
+    if (v.size() != lv.size()) return false;
+    size_t i = 0;
+    bool same = true;
+    lv.for_each([&](std::string_view k, double val) {
+        same = same && v[i].first == k && v[i].second == val;
+        i++;
+    });
+    return same;
+}
+
+bool same_token(const ModelView::Token& t, const TokenConceptEmbedding& tce) {
+    return t.meaning == tce.meaning && t.freq == tce.freq && t.grounding == tce.grounding_value &&
+           t.stability == tce.semantic_stability && t.qualia_intensity == tce.qualia_intensity &&
+           t.embedding == tce.embedding && t.linked_concepts == tce.linked_concepts && t.name == tce.name &&
+           same_valences(t.linked_valences, tce.linked_valences);
+}
+
+std::shared_ptr<const ModelView::Token> share_token(const std::shared_ptr<const ModelView::Token>* prev,
+                                                    const TokenConceptEmbedding& tce) {
+    if (prev && same_token(**prev, tce)) return *prev;
+    auto t = std::make_shared<ModelView::Token>();
+    t->name = tce.name;
+    t->meaning = tce.meaning;
+    t->freq = tce.freq;
+    t->grounding = tce.grounding_value;
+    t->stability = tce.semantic_stability;
+    t->qualia_intensity = tce.qualia_intensity;
+    t->embedding = tce.embedding;
+    t->linked_concepts = tce.linked_concepts;
+    tce.linked_valences.for_each([&](std::string_view k, double v) { t->linked_valences.emplace_back(k, v); });
+    return t;
+}
+
+std::shared_ptr<const ModelView::Counts> share_counts(const std::shared_ptr<const ModelView::Counts>* prev,
+                                                      const std::map<std::string, int>& live) {
+    if (prev && **prev == live) return *prev;
+    return std::make_shared<const ModelView::Counts>(live);
+}
+
+size_t publish_tokens(ModelView& view, const ModelChangeSet& changes) {
+    if (changes.whole(ModelStore::Embeddings)) {
+        view.tokens = persistent_rebuild(view.tokens, token_concept_embedding_map, share_token);
+        return token_concept_embedding_map.size();
+    }
+    for (const auto& key : changes.of(ModelStore::Embeddings)) persistent_refresh(view.tokens, token_concept_embedding_map, key.first, share_token);
+    return changes.of(ModelStore::Embeddings).size();
+}
+
+size_t publish_bigrams(ModelView& view, const ModelChangeSet& changes) {
+    if (changes.whole(ModelStore::Bigrams)) {
+        view.bigrams = persistent_rebuild(view.bigrams, bigram_counts, share_counts);
+        return bigram_counts.size();
+    }
+    for (const auto& key : changes.of(ModelStore::Bigrams)) persistent_refresh(view.bigrams, bigram_counts, key.first, share_counts);
+    return changes.of(ModelStore::Bigrams).size();
+}
+
+size_t publish_trigrams(ModelView& view, const ModelChangeSet& changes) {
+    using Rows = ModelView::Rows;
+    if (changes.whole(ModelStore::Trigrams)) {
+        view.trigrams = persistent_rebuild(view.trigrams, trigram_counts, [](const Rows* old, const std::map<std::string, std::map<std::string, int>>& live) {
+            return persistent_rebuild(old ? *old : Rows(), live, share_counts);
+        });
+        return trigram_counts.size();
+    }
+    // Keys are sorted, so the rows under one w1 arrive together and its
+    // row map is copied and re-inserted once
+    const auto& keys = changes.of(ModelStore::Trigrams);
+    for (auto k = keys.begin(); k != keys.end();) {
+        const std::string& w1 = k->first;
+        auto live = trigram_counts.find(w1);
+        if (live == trigram_counts.end()) {
+            view.trigrams.erase(w1);
+            while (k != keys.end() && k->first == w1) ++k;
+            continue;
+        }
+        const Rows* old = view.trigrams.get(w1);
+        Rows rows = old ? *old : Rows();
+        for (; k != keys.end() && k->first == w1; ++k) persistent_refresh(rows, live->second, k->second, share_counts);
+        if (!old || !rows.same_as(*old)) view.trigrams.set(w1, std::move(rows));
+    }
+    return keys.size();
+}
+
+size_t publish_concepts(ModelView& view, const ModelChangeSet& changes) {
+    if (changes.whole(ModelStore::Concepts)) {
+        std::vector<std::pair<const std::string, double>> strong;
+        for (const auto& [name, c] : S.concepts) {
+            if (c.value > 0.3) strong.emplace_back(name, c.value);
+        }
+        view.strong_concepts = PersistentMap<std::string, double>::from_sorted(std::move(strong));
+        return S.concepts.size();
+    }
+    for (const auto& key : changes.of(ModelStore::Concepts)) {
+        auto it = S.concepts.find(key.first);
+        if (it == S.concepts.end() || it->second.value <= 0.3) {
+            view.strong_concepts.erase(key.first);
+        } else {
+            const double* old = view.strong_concepts.get(key.first);
+            if (!old || *old != it->second.value) view.strong_concepts.set(key.first, it->second.value);
+        }
+    }
+    return changes.of(ModelStore::Concepts).size();
+}
+}
+
+void ModelSnapshot::publish() {
+    auto t0 = std::chrono::steady_clock::now();
+    std::shared_ptr<const ModelView> prev = current();
+    // Copying the tables copies their roots; the changes below copy only the
+    // paths to the entries they replace
+    auto view = std::make_shared<ModelView>(*prev);
+    ModelChangeSet changes = ModelChanges::take(ModelReader::View);
+    size_t n = publish_tokens(*view, changes) + publish_bigrams(*view, changes) +
+               publish_trigrams(*view, changes) + publish_concepts(*view, changes);
+    view->valence = S.current_valence;
+    view->generation = S.g;
+    view->epoch = prev->epoch + 1;
+    current_view.store(std::move(view), std::memory_order_release);
+    epoch.fetch_add(1);
+    published.store(n);
+    publish_ms.store(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+}
+
+std::shared_ptr<const ModelView> ModelSnapshot::build() {
+    auto view = std::make_shared<ModelView>();
+    ModelChangeSet all;
+    all.mark_all();
+    publish_tokens(*view, all);
+    publish_bigrams(*view, all);
+    publish_trigrams(*view, all);
+    publish_concepts(*view, all);
+    view->valence = S.current_valence;
+    view->generation = S.g;
+    return view;
+}
+
+ModelSnapshotStats ModelSnapshot::stats() {
+    ModelSnapshotStats s;
+    s.epoch = epoch.load();
+    s.publish_ms = publish_ms.load();
+    s.published = published.load();
+    std::lock_guard<std::mutex> lock(writes_mutex);
+    s.writes = applied;
+    s.pending_writes = pending.size();
+    return s;
+}
+
+// ===== SINGLE WRITER =====
+
+void ModelWriter::attach() {
+    loop_thread.store(std::this_thread::get_id());
+}
+
+bool ModelWriter::on_loop_thread() {
+    return loop_thread.load() == std::this_thread::get_id();
+}
+
+void ModelWriter::submit(std::function<void()> fn) {
+    if (on_loop_thread()) {
+        fn();
+        return;
+    }
+    PendingWrite w{std::move(fn), nullptr, false};
+    std::unique_lock<std::mutex> lock(writes_mutex);
+    if (closed) throw std::runtime_error("model writer stopped");
+    pending.push_back(&w);
+    writes_done.wait(lock, [&] { return w.done; });
+    if (w.error) std::rethrow_exception(w.error);
+}
+
+void ModelWriter::tick() {
+    std::deque<PendingWrite*> batch;
+    {
+        std::lock_guard<std::mutex> lock(writes_mutex);
+        batch.swap(pending);
+    }
+    for (PendingWrite* w : batch) {
+        try {
+            w->fn();
+        } catch (...) {
+            w->error = std::current_exception();
+        }
+    }
+    ModelSnapshot::publish();
+    StatusSnapshot::publish();
+    {
+        std::lock_guard<std::mutex> lock(writes_mutex);
+        applied += batch.size();
+        for (PendingWrite* w : batch) w->done = true;
+    }
+    writes_done.notify_all();
+}
+
+void ModelWriter::close() {
+    {
+        std::lock_guard<std::mutex> lock(writes_mutex);
+        closed = true;
+        for (PendingWrite* w : pending) {
+            w->error = std::make_exception_ptr(std::runtime_error("model writer stopped"));
+            w->done = true;
+        }
+        pending.clear();
+    }
+    writes_done.notify_all();
+}
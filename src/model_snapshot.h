@@ -0,0 +1,104 @@
+#ifndef MODEL_SNAPSHOT_H
+#define MODEL_SNAPSHOT_H
+
+#include "persistent_map.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Concurrency model for the cognitive state.
+//
+// The simulation loop in main() is the only thread that touches the live
+// model (S, token_concept_embedding_map, the n-gram tables, goal_system, ...).
+// Everything else goes through one of two doors:
+//
+//  - Reads take the ModelView the loop published at its last tick boundary.
+//    ModelSnapshot::current() is one atomic load; the view is immutable and
+//    stays alive for as long as the reader holds it, so any number of chat
+//    generations and lexicon lookups run in parallel without blocking the
+//    loop or each other.
+//  - Writes are closures handed to ModelWriter::submit(). The loop runs the
+//    queued ones at its next tick boundary, in submission order, then
+//    publishes a new view; submit() returns once that view is current, so a
+//    writer that reads afterwards sees its own change.
+//
+// Each thread draws from its own RNG (rng is thread_local), so readers do not
+// disturb the seeds the learning log relies on for replay.
+
+// What generation and the lexicon endpoints read. The tables are persistent
+// maps (persistent_map.h): a view shares every entry and every subtree the
+// tick did not change with the view before it. publish() re-reads only the
+// entries marked in ModelChanges since the last tick, so its cost follows the
+// change volume; a store marked as a whole (decay, loads) is walked once and
+// still shares the entries that compare equal.
+struct ModelView {
+    // Everything a checkpoint persists for an embedding, so saves can read
+    // the lexicon from a view (see persistence.cpp)
+    struct Token {
+        std::string name;
+        double meaning = 0, freq = 0, grounding = 0, stability = 0, qualia_intensity = 0;
+        std::vector<double> embedding;
+        std::map<std::string, double> linked_concepts;
+        std::vector<std::pair<std::string, double>> linked_valences;    // set fields, in ValenceContext order
+    };
+    using Counts = std::map<std::string, int>;
+    using Rows = PersistentMap<std::string, std::shared_ptr<const Counts>>;
+
+    PersistentMap<std::string, std::shared_ptr<const Token>> tokens;    // ordered like token_concept_embedding_map
+    Rows bigrams;
+    PersistentMap<std::string, Rows> trigrams;
+    PersistentMap<std::string, double> strong_concepts;    // S.concepts with value > 0.3, name -> value
+    double valence = 0;
+    int generation = 0;     // S.g at publication
+    uint64_t epoch = 0;     // publications so far
+
+    const Token* token(const std::string& word) const;
+    const Counts* bigram_row(const std::string& w1) const;
+    const Counts* trigram_row(const std::string& w1, const std::string& w2) const;
+    int bigram(const std::string& w1, const std::string& w2) const;
+    int trigram(const std::string& w1, const std::string& w2, const std::string& w3) const;
+};
+
+struct ModelSnapshotStats {
+    uint64_t epoch = 0;
+    double publish_ms = 0;      // last copy and swap
+    size_t published = 0;       // entries the last publish re-read
+    uint64_t writes = 0;        // closures applied through ModelWriter
+    size_t pending_writes = 0;
+};
+
+class ModelSnapshot {
+public:
+    // Latest published view; an empty one before the first publish().
+    static std::shared_ptr<const ModelView> current();
+    // Loop thread: apply the changes marked since the last publish to a copy
+    // of the current view and make it current.
+    static void publish();
+    // A view of the live model built from scratch and not published, for
+    // readers that cannot count on every write having been marked. Loop thread.
+    static std::shared_ptr<const ModelView> build();
+    static ModelSnapshotStats stats();
+};
+
+class ModelWriter {
+public:
+    // Marks the calling thread as the loop thread. Called once, early in main().
+    static void attach();
+    static bool on_loop_thread();
+
+    // Runs fn on the loop thread and waits for the view that includes it;
+    // rethrows what fn throws. Called from the loop thread, fn runs inline.
+    // Throws std::runtime_error once the loop has stopped.
+    static void submit(std::function<void()> fn);
+
+    // Loop thread, once per tick: apply queued writes, publish the view and
+    // the status documents, release the submitters.
+    static void tick();
+    // Loop thread, on exit: fail queued and future writes.
+    static void close();
+};
+
+#endif
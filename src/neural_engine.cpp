@@ -0,0 +1,123 @@
+#include "neural_engine.h"
+#include "struct.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double LINK_WEIGHT = 0.1;
+constexpr double MOMENTUM = 0.7;
+constexpr double DRIVE = 0.1;
+constexpr size_t ROW_BLOCK = 256;
+
+// y[r] = bias[r] + A[r,:] . x for rows [begin, end). Four independent
+// accumulators break the add dependency chain so the gather loop pipelines.
+inline void spmv_rows(const uint32_t* row_ptr, const uint32_t* col, const double* val,
+                      const double* bias, const double* x, double* acc,
+                      size_t begin, size_t end) {
+    for (size_t r = begin; r < end; ++r) {
+        const uint32_t lo = row_ptr[r], hi = row_ptr[r + 1];
+        double a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+        uint32_t k = lo;
+        for (; k + 4 <= hi; k += 4) {
+            a0 += val[k] * x[col[k]];
+            a1 += val[k + 1] * x[col[k + 1]];
+            a2 += val[k + 2] * x[col[k + 2]];
+            a3 += val[k + 3] * x[col[k + 3]];
+        }
+        for (; k < hi; ++k) a0 += val[k] * x[col[k]];
+        acc[r - begin] = bias[r] + ((a0 + a1) + (a2 + a3));
+    }
+}
+}
+
+void NeuralEngine::rebuild(const NeuronSlab& neurons) {
+    const size_t n = neurons.size();
+    row_ptr_.assign(n + 1, 0);
+    col_idx_.clear();
+    val_.clear();
+    bias_.resize(n);
+    x_[0].resize(n);
+    x_[1].resize(n);
+
+    std::vector<uint32_t> cols;
+    for (size_t i = 0; i < n; ++i) {
+        cols.clear();
+        for (NeuronHandle h : neurons[i].links) {
+            size_t j = neurons.dense_index(h);
+            if (j != SIZE_MAX) cols.push_back((uint32_t)j);
+        }
+        std::sort(cols.begin(), cols.end());
+        for (size_t k = 0; k < cols.size();) {
+            size_t m = k;
+            while (m < cols.size() && cols[m] == cols[k]) ++m;
+            col_idx_.push_back(cols[k]);
+            val_.push_back(LINK_WEIGHT * (double)(m - k));
+            k = m;
+        }
+        row_ptr_[i + 1] = (uint32_t)col_idx_.size();
+    }
+    built_stamp_ = neurons.topology_stamp;
+}
+
+double NeuralEngine::step(NeuronSlab& neurons, ThreadPool& pool, size_t grain) {
+    if (neurons.empty()) return 0.0;
+    if (built_stamp_ != neurons.topology_stamp || rows() != neurons.size()) rebuild(neurons);
+
+    std::vector<double>& x = x_[cur_];
+    for (size_t i = 0; i < neurons.size(); ++i) {
+        x[i] = neurons[i].weight;
+        bias_[i] = neurons[i].bias;
+    }
+    double mean = step_arrays(pool, grain);
+    const std::vector<double>& w = x_[cur_];
+    for (size_t i = 0; i < neurons.size(); ++i) neurons[i].weight = w[i];
+    return mean;
+}
+
+void NeuralEngine::load(std::vector<uint32_t> row_ptr, std::vector<uint32_t> col_idx,
+                        std::vector<double> values, std::vector<double> weights,
+                        std::vector<double> biases) {
+    row_ptr_ = std::move(row_ptr);
+    col_idx_ = std::move(col_idx);
+    val_ = std::move(values);
+    bias_ = std::move(biases);
+    x_[0] = std::move(weights);
+    x_[1].assign(x_[0].size(), 0.0);
+    cur_ = 0;
+    built_stamp_ = 0;
+}
+
+double NeuralEngine::step_arrays(ThreadPool& pool, size_t grain) {
+    const size_t n = rows();
+    if (n == 0) return 0.0;
+    const double* x = x_[cur_].data();
+    double* y = x_[1 - cur_].data();
+    const uint32_t* rp = row_ptr_.data();
+    const uint32_t* ci = col_idx_.data();
+    const double* va = val_.data();
+    const double* bi = bias_.data();
+
+    chunk_sums_.assign(pool.chunk_count(n, grain), 0.0);
+    pool.parallel_for(n, grain, [&](size_t chunk, size_t begin, size_t end) {
+        double acc[ROW_BLOCK];
+        double sum = 0.0;
+        for (size_t b = begin; b < end; b += ROW_BLOCK) {
+            const size_t e = std::min(end, b + ROW_BLOCK);
+            spmv_rows(rp, ci, va, bi, x, acc, b, e);
+            // Dense elementwise pass over the block: tanh, momentum, clamp.
+            for (size_t r = b; r < e; ++r) {
+                double w = x[r] * MOMENTUM + std::tanh(acc[r - b]) * DRIVE;
+                w = std::clamp(w, -1.0, 1.0);
+                y[r] = w;
+                sum += std::fabs(w);
+            }
+        }
+        chunk_sums_[chunk] = sum;
+    });
+    cur_ = 1 - cur_;
+
+    double total = 0.0;
+    for (double s : chunk_sums_) total += s;
+    return total / (double)n;
+}
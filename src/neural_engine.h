@@ -0,0 +1,56 @@
+#ifndef NEURAL_ENGINE_H
+#define NEURAL_ENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+struct NeuronSlab;
+
+// Sparse update engine for the neuron graph.
+//
+// The link lists are compiled into a CSR matrix (row = neuron, column = linked
+// neuron, value = 0.1 per link, duplicates merged) keyed by dense slab
+// position. Each tick runs one SpMV over the current activations and applies
+// the neuron rule
+//
+//     w' = clamp(w * 0.7 + tanh(bias + sum(0.1 * w_link)) * 0.1, -1, 1)
+//
+// to every row at once. Activations are double-buffered: all rows read the
+// previous tick's weights and write the next buffer, so row partitions run on
+// the thread pool without synchronisation and the result does not depend on
+// the number of threads.
+//
+// The matrix is rebuilt only when the slab's topology stamp changes; ordinary
+// ticks just gather weights, run the kernel and scatter weights back.
+class NeuralEngine {
+public:
+    // Full tick against the slab. Returns the mean |weight| after the update.
+    double step(NeuronSlab& neurons, ThreadPool& pool, size_t grain);
+
+    // Raw interface used by the benchmark: install a CSR graph and initial
+    // state directly, then call step_arrays() repeatedly.
+    void load(std::vector<uint32_t> row_ptr, std::vector<uint32_t> col_idx,
+              std::vector<double> values, std::vector<double> weights,
+              std::vector<double> biases);
+    double step_arrays(ThreadPool& pool, size_t grain);
+
+    size_t rows() const { return bias_.size(); }
+    size_t nnz() const { return col_idx_.size(); }
+    const std::vector<double>& weights() const { return x_[cur_]; }
+
+private:
+    void rebuild(const NeuronSlab& neurons);
+
+    std::vector<uint32_t> row_ptr_;
+    std::vector<uint32_t> col_idx_;
+    std::vector<double> val_;
+    std::vector<double> bias_;
+    std::vector<double> x_[2];
+    std::vector<double> chunk_sums_;
+    int cur_ = 0;
+    uint64_t built_stamp_ = 0;
+};
+
+#endif
@@ -0,0 +1,1557 @@
+#include "persistence.h"
+#include "state.h"
+#include "snapshot.h"
+#include "config.h"
+#include "memory_accounting.h"
+#include "learning_log.h"
+#include "model_snapshot.h"
+#include "model_changes.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+// ===== FINGERPRINTS =====
+
+namespace {
+constexpr uint64_t KEY_SEED = 0x6E657875736B6579ull;
+
+struct Fingerprint {
+    uint64_t h = 0x243F6A8885A308D3ull;
+    Fingerprint& add(uint64_t v) {
+        h ^= v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+        h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 31;
+        return *this;
+    }
+    Fingerprint& add(double d) { return add(std::bit_cast<uint64_t>(d)); }
+    Fingerprint& add(int v) { return add((uint64_t)(uint32_t)v); }
+    Fingerprint& add(string_view s) { return add(snapshot_checksum(s.data(), s.size(), KEY_SEED)); }
+};
+
+uint64_t key_of(string_view s) { return snapshot_checksum(s.data(), s.size(), KEY_SEED); }
+uint64_t key_of(string_view a, string_view b) { return Fingerprint().add(a).add(b).h; }
+uint64_t key_of_neuron(int id) { return (uint64_t)(uint32_t)id; }
+int neuron_of_key(uint64_t k) { return (int)(uint32_t)k; }
+
+template<typename M>
+uint64_t fingerprint_kv(const M& m) {
+    Fingerprint f;
+    f.add((uint64_t)m.size());
+    for (auto& p : m) f.add(string_view(p.first)).add(p.second);
+    return f.h;
+}
+
+uint64_t new_snapshot_id() {
+    std::random_device rdev;
+    uint64_t id = ((uint64_t)rdev() << 32) ^ rdev() ^
+                  (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+    return id ? id : 1;
+}
+}
+
+// ===== CHANGE TRACKER =====
+
+namespace {
+bool key_less(const ChangeTracker::Entry& a, const ChangeTracker::Entry& b) { return a.key < b.key; }
+}
+
+const ChangeTracker::Entry* ChangeTracker::find(uint32_t store, uint64_t key) const {
+    auto it = baseline_.find(store);
+    if (it == baseline_.end()) return nullptr;
+    const auto& v = it->second;
+    auto e = std::lower_bound(v.begin(), v.end(), Entry{key, 0}, key_less);
+    return e != v.end() && e->key == key ? &*e : nullptr;
+}
+
+bool ChangeTracker::changed(uint32_t store, uint64_t key, uint64_t fingerprint) const {
+    const Entry* e = find(store, key);
+    return !e || e->fingerprint != fingerprint;
+}
+
+bool ChangeTracker::contains(uint32_t store, uint64_t key) const { return find(store, key) != nullptr; }
+
+void ChangeTracker::stage(uint32_t store, uint64_t key, uint64_t fingerprint) {
+    staged_[store].push_back({key, fingerprint});
+}
+
+std::vector<uint64_t> ChangeTracker::removed(uint32_t store) {
+    auto& cur = staged_[store];
+    std::sort(cur.begin(), cur.end(), key_less);
+    std::vector<uint64_t> out;
+    auto it = baseline_.find(store);
+    if (it == baseline_.end()) return out;
+    size_t j = 0;
+    for (const Entry& e : it->second) {
+        while (j < cur.size() && cur[j].key < e.key) ++j;
+        if (j == cur.size() || cur[j].key != e.key) out.push_back(e.key);
+    }
+    return out;
+}
+
+void ChangeTracker::stage_update(uint32_t store, uint64_t key, uint64_t fingerprint) {
+    patches_[store].updates.push_back({key, fingerprint});
+}
+
+void ChangeTracker::stage_erase(uint32_t store, uint64_t key) {
+    patches_[store].erased.push_back(key);
+}
+
+void ChangeTracker::commit() {
+    for (auto& [store, v] : staged_) {
+        std::sort(v.begin(), v.end(), key_less);
+        baseline_[store] = std::move(v);
+    }
+    // Patched keys are rewritten in place; only new keys and erasures move
+    // the rest of the store
+    for (auto& [store, p] : patches_) {
+        auto& base = baseline_[store];
+        std::sort(p.updates.begin(), p.updates.end(), key_less);
+        std::vector<Entry> added;
+        for (const Entry& u : p.updates) {
+            auto e = std::lower_bound(base.begin(), base.end(), u, key_less);
+            if (e != base.end() && e->key == u.key) e->fingerprint = u.fingerprint;
+            else added.push_back(u);
+        }
+        if (!p.erased.empty()) {
+            std::sort(p.erased.begin(), p.erased.end());
+            std::erase_if(base, [&](const Entry& e) { return std::binary_search(p.erased.begin(), p.erased.end(), e.key); });
+        }
+        if (!added.empty()) {
+            size_t mid = base.size();
+            base.insert(base.end(), added.begin(), added.end());
+            std::inplace_merge(base.begin(), base.begin() + mid, base.end(), key_less);
+        }
+    }
+    discard();
+}
+
+size_t ChangeTracker::bytes() const {
+    size_t b = 0;
+    for (auto& [store, v] : baseline_) b += v.capacity() * sizeof(Entry);
+    return b;
+}
+
+// ===== CAPTURED MODEL =====
+
+namespace {
+// What a checkpoint reads instead of the live stores. The lexicon is a
+// ModelView; the other large stores are persistent maps of their persisted
+// fields, kept in step with the live model from the checkpoint's change marks.
+// Copying one shares every entry with the original, so the loop hands a
+// capture to the writer thread for the cost of what changed since the
+// previous one, and the writer fingerprints and serializes it from there.
+// State D, neurons and goals are bounded and read live.
+struct TokenRecord {
+    double meaning = 0, freq = 0;
+    bool operator==(const TokenRecord&) const = default;
+};
+struct ConceptRecord {
+    double value = 0;
+    vector<string> related_words;
+};
+using RelationRow = map<string, double>;
+
+struct CapturedModel {
+    std::shared_ptr<const ModelView> lexicon = std::make_shared<const ModelView>();
+    PersistentMap<string, TokenRecord> tokens;
+    PersistentMap<string, std::shared_ptr<const ConceptRecord>> concepts;
+    PersistentMap<string, double> world_entities;
+    PersistentMap<string, std::shared_ptr<const RelationRow>> world_relations;
+
+    // Re-reads the keys `changes` lists and walks the stores it marks whole.
+    // `lexicon` becomes `view`, which must be current.
+    void refresh(const ModelChangeSet& changes, std::shared_ptr<const ModelView> view);
+};
+
+template<typename Map, typename Live, typename Share>
+void follow(Map& m, const Live& live, const ModelChangeSet& changes, ModelStore s, Share share) {
+    if (changes.whole(s)) {
+        m = persistent_rebuild(m, live, share);
+        return;
+    }
+    for (auto& k : changes.of(s)) persistent_refresh(m, live, k.first, share);
+}
+
+void CapturedModel::refresh(const ModelChangeSet& changes, std::shared_ptr<const ModelView> view) {
+    lexicon = std::move(view);
+    follow(tokens, S.tokens, changes, ModelStore::Tokens,
+           [](const TokenRecord*, const Token& t) { return TokenRecord{t.meaning, t.freq}; });
+    follow(concepts, S.concepts, changes, ModelStore::Concepts,
+           [](const std::shared_ptr<const ConceptRecord>* old, const Concept& c) {
+               if (old && (*old)->value == c.value && (*old)->related_words == c.related_words) return *old;
+               return std::make_shared<const ConceptRecord>(ConceptRecord{c.value, c.related_words});
+           });
+    follow(world_entities, world_model.entity_states, changes, ModelStore::WorldEntities,
+           [](const double*, double v) { return v; });
+    follow(world_relations, world_model.relationships, changes, ModelStore::WorldRelations,
+           [](const std::shared_ptr<const RelationRow>* old, const RelationRow& row) {
+               if (old && **old == row) return *old;
+               return std::make_shared<const RelationRow>(row);
+           });
+}
+}
+
+// ===== SNAPSHOT BUILDER =====
+
+namespace {
+// Scalar state lives in the Meta section as name/value pairs, keyed by the
+// same names the text format uses, so fields can be added without a version bump.
+struct SnapshotScalar { const char* name; function<double()> get; function<void(double)> set; };
+vector<SnapshotScalar> snapshot_scalars() {
+    return {
+        {"G", [] { return (double)S.g; }, [](double v) { S.g = (int)v; }},
+        {"DWT", [] { return S.dwt; }, [](double v) { S.dwt = v; }},
+        {"TA", [] { return S.ta; }, [](double v) { S.ta = v; }},
+        {"SENTIENCE", [] { return S.sentience_ratio; }, [](double v) { S.sentience_ratio = v; }},
+        {"VALENCE", [] { return S.current_valence; }, [](double v) { S.current_valence = v; }},
+        {"METACOG", [] { return S.metacognitive_awareness; }, [](double v) { S.metacognitive_awareness = v; }},
+        {"ATTENTION", [] { return S.attention_focus; }, [](double v) { S.attention_focus = v; }},
+        {"PEAK_SENT_GEN", [] { return (double)S.peak_sentience_gen; }, [](double v) { S.peak_sentience_gen = (int)v; }},
+        {"TOTAL_NEURONS", [] { return (double)S.total_neurons_ever; }, [](double v) { S.total_neurons_ever = (int)v; }},
+        {"PHI", [] { return consciousness.phi_value; }, [](double v) { consciousness.phi_value = v; }},
+        {"CONSCIOUS_CYCLES", [] { return (double)consciousness.conscious_cycles; }, [](double v) { consciousness.conscious_cycles = (int)v; }},
+        {"INTEGRATION", [] { return consciousness.integrated_information; }, [](double v) { consciousness.integrated_information = v; }},
+        {"GLOBAL_WORKSPACE", [] { return consciousness.global_workspace_capacity; }, [](double v) { consciousness.global_workspace_capacity = v; }},
+        {"MODEL_ACCURACY", [] { return world_model.model_accuracy; }, [](double v) { world_model.model_accuracy = v; }},
+        {"MODEL_UPDATES", [] { return (double)world_model.updates; }, [](double v) { world_model.updates = (int)v; }},
+        {"WM_CAPACITY", [] { return (double)WM.capacity; }, [](double v) { WM.set_capacity((int)v); }},
+        // Last learning-log event the snapshot includes; replay starts after it
+        {"WAL_LSN", [] { return (double)LearningLog::last_lsn(); }, [](double v) { LearningLog::set_covered((uint64_t)v); }},
+    };
+}
+
+// Records for one full snapshot or delta frame, in write order.
+struct SnapshotBuilder {
+    StringTableBuilder st;
+    vector<SnapKV> meta, state_d, embedding_links, goal_preconditions, world_entities;
+    vector<SnapQualia> qualia;
+    vector<double> psi_history, embedding_values, valence_history;
+    vector<SnapNeuron> neurons;
+    vector<int32_t> neuron_links;
+    vector<SnapToken> tokens;
+    vector<SnapConcept> concepts;
+    vector<uint32_t> concept_words, goal_subgoals, thoughts;
+    vector<SnapEmbedding> embeddings;
+    vector<SnapPairValue> valence_context, world_relations;
+    vector<SnapBigram> bigrams;
+    vector<SnapTrigram> trigrams;
+    vector<SnapGoal> goals;
+    vector<SnapMemory> memories;
+    vector<SnapHead> heads;
+    vector<SnapTombstone> tombstones;
+    size_t entities = 0;
+
+    template<typename M>
+    void append_kv(const M& m, vector<SnapKV>& out) {
+        for (auto& p : m) out.push_back({st.intern(p.first), 0, p.second});
+    }
+
+    // Meta, rings and other bounded state: always written in full.
+    void add_small_state() {
+        for (auto& sc : snapshot_scalars()) meta.push_back({st.intern(sc.name), 0, sc.get()});
+        for (auto& q : consciousness.active_qualia) {
+            qualia.push_back({q.valence, q.arousal, q.certainty, q.emergence_gen, st.intern(q.phenomenal_content)});
+        }
+        psi_history = consciousness_formula.psi_history.to_vector();
+        for (auto& m : S.episodic_memory) memories.push_back({m.gen, st.intern(m.content), m.valence});
+        valence_history = S.valence_history.to_vector();
+        for (auto& t : S.internal_thoughts) thoughts.push_back(st.intern(t));
+        for (auto& head : transformer_heads) heads.push_back({st.intern(head.name), head.dim, head.temperature});
+    }
+
+    void add_neuron(const Neuron& n) {
+        SnapNeuron sn{n.id, n.gen, n.weight, n.bias, (uint32_t)neuron_links.size(), 0};
+        for (NeuronHandle h : n.links) {
+            if (const Neuron* target = S.N.get(h)) neuron_links.push_back(target->id);
+        }
+        sn.link_count = (uint32_t)neuron_links.size() - sn.link_begin;
+        neurons.push_back(sn);
+        ++entities;
+    }
+    void add_token(const string& word, const TokenRecord& t) {
+        tokens.push_back({st.intern(word), 0, t.meaning, t.freq});
+        ++entities;
+    }
+    void add_concept(const string& name, const ConceptRecord& c) {
+        SnapConcept sc{st.intern(name), (uint32_t)concept_words.size(), (uint32_t)c.related_words.size(), 0, c.value};
+        for (auto& rw : c.related_words) concept_words.push_back(st.intern(rw));
+        concepts.push_back(sc);
+        ++entities;
+    }
+    void add_embedding(const string& key, const ModelView::Token& tce) {
+        SnapEmbedding se{};
+        se.name = st.intern(tce.name);
+        se.value_begin = (uint32_t)embedding_values.size();
+        se.value_count = (uint32_t)tce.embedding.size();
+        embedding_values.insert(embedding_values.end(), tce.embedding.begin(), tce.embedding.end());
+        se.link_begin = (uint32_t)embedding_links.size();
+        append_kv(tce.linked_concepts, embedding_links);
+        se.link_count = (uint32_t)embedding_links.size() - se.link_begin;
+        se.meaning = tce.meaning;
+        se.freq = tce.freq;
+        se.grounding = tce.grounding;
+        se.stability = tce.stability;
+        se.qualia_intensity = tce.qualia_intensity;
+        embeddings.push_back(se);
+        if (!tce.linked_valences.empty()) {
+            uint32_t token_id = st.intern(key);
+            for (auto& [k, val] : tce.linked_valences) valence_context.push_back({token_id, st.intern(k), val});
+        }
+        ++entities;
+    }
+    void add_bigram_row(const string& w1, const map<string, int>& row) {
+        uint32_t a = st.intern(w1);
+        for (auto& p : row) bigrams.push_back({a, st.intern(p.first), p.second});
+        ++entities;
+    }
+    void add_trigram_row(const string& w1, const string& w2, const map<string, int>& row) {
+        uint32_t a = st.intern(w1), b = st.intern(w2);
+        for (auto& p : row) trigrams.push_back({a, b, st.intern(p.first), p.second});
+        ++entities;
+    }
+    void add_goal(const Goal& g) {
+        SnapGoal sg{};
+        sg.name = st.intern(g.name);
+        sg.sub_begin = (uint32_t)goal_subgoals.size();
+        sg.sub_count = (uint32_t)g.subgoals.size();
+        for (auto& sub : g.subgoals) goal_subgoals.push_back(st.intern(sub));
+        sg.pre_begin = (uint32_t)goal_preconditions.size();
+        append_kv(g.preconditions, goal_preconditions);
+        sg.pre_count = (uint32_t)goal_preconditions.size() - sg.pre_begin;
+        sg.priority = g.priority;
+        sg.progress = g.progress;
+        sg.valence_alignment = g.valence_alignment;
+        sg.qualia_binding = g.qualia_binding;
+        goals.push_back(sg);
+        ++entities;
+    }
+    void add_relation_row(const string& a, const map<string, double>& row) {
+        uint32_t ida = st.intern(a);
+        for (auto& p : row) world_relations.push_back({ida, st.intern(p.first), p.second});
+        ++entities;
+    }
+    void add_tombstone(SnapshotSection store, uint64_t key) {
+        tombstones.push_back({(uint32_t)store, 0, key});
+    }
+
+    void write(SnapshotWriter& w) {
+        w.add(SnapshotSection::Meta, meta);
+        w.add(SnapshotSection::StateD, state_d);
+        w.add(SnapshotSection::Qualia, qualia);
+        w.add(SnapshotSection::PsiHistory, psi_history);
+        w.add(SnapshotSection::Neurons, neurons);
+        w.add(SnapshotSection::NeuronLinks, neuron_links);
+        w.add(SnapshotSection::Tokens, tokens);
+        w.add(SnapshotSection::Concepts, concepts);
+        w.add(SnapshotSection::ConceptWords, concept_words);
+        w.add(SnapshotSection::Embeddings, embeddings);
+        w.add(SnapshotSection::EmbeddingValues, embedding_values);
+        w.add(SnapshotSection::EmbeddingLinks, embedding_links);
+        w.add(SnapshotSection::ValenceContext, valence_context);
+        w.add(SnapshotSection::Bigrams, bigrams);
+        w.add(SnapshotSection::Trigrams, trigrams);
+        w.add(SnapshotSection::Goals, goals);
+        w.add(SnapshotSection::GoalSubgoals, goal_subgoals);
+        w.add(SnapshotSection::GoalPreconditions, goal_preconditions);
+        w.add(SnapshotSection::WorldEntities, world_entities);
+        w.add(SnapshotSection::WorldRelations, world_relations);
+        w.add(SnapshotSection::Memories, memories);
+        w.add(SnapshotSection::ValenceHistory, valence_history);
+        w.add(SnapshotSection::Thoughts, thoughts);
+        w.add(SnapshotSection::Heads, heads);
+        if (!tombstones.empty()) w.add(SnapshotSection::Tombstones, tombstones);
+        // Strings last: every section above has interned into the table by now
+        w.add_strings(st);
+    }
+};
+
+// Entity fingerprints: everything a store's records hold, so equal
+// fingerprints mean there is nothing to write.
+uint64_t fingerprint_neuron(const Neuron& n) {
+    Fingerprint f;
+    f.add(n.gen).add(n.weight).add(n.bias);
+    for (NeuronHandle h : n.links) {
+        if (const Neuron* t = S.N.get(h)) f.add(t->id);
+    }
+    return f.h;
+}
+uint64_t fingerprint_goal(const Goal& g) {
+    Fingerprint f;
+    f.add(string_view(g.name)).add(g.priority).add(g.progress).add(g.valence_alignment).add(g.qualia_binding);
+    f.add((uint64_t)g.subgoals.size());
+    for (auto& sub : g.subgoals) f.add(string_view(sub));
+    f.add(fingerprint_kv(g.preconditions));
+    return f.h;
+}
+uint64_t fingerprint_token(const TokenRecord& t) { return Fingerprint().add(t.meaning).add(t.freq).h; }
+uint64_t fingerprint_concept(const ConceptRecord& c) {
+    Fingerprint f;
+    f.add(c.value).add((uint64_t)c.related_words.size());
+    for (auto& w : c.related_words) f.add(string_view(w));
+    return f.h;
+}
+uint64_t fingerprint_embedding(const ModelView::Token& t) {
+    Fingerprint f;
+    f.add(string_view(t.name)).add(t.meaning).add(t.freq).add(t.grounding)
+     .add(t.stability).add(t.qualia_intensity).add((uint64_t)t.embedding.size());
+    for (double v : t.embedding) f.add(v);
+    f.add(fingerprint_kv(t.linked_concepts));
+    for (auto& [k, v] : t.linked_valences) f.add(string_view(k)).add(v);
+    return f.h;
+}
+template<typename T>
+uint64_t fingerprint_row(const std::shared_ptr<const T>& row) { return fingerprint_kv(*row); }
+
+// One pass over entity stores. With no tracker every entity goes to `out`.
+// With a tracker each entity's fingerprint is staged for the next baseline;
+// when `delta` is set only entities that differ from the current baseline are
+// written, plus tombstones for removed entities and for rewritten rows.
+//
+// `changes` (deltas only) narrows a captured store to the keys marked since
+// the last checkpoint: only those are fingerprinted, and a marked key that is
+// gone is a removal if the baseline has it. Stores it marks whole are walked
+// in full, as are the bounded ones.
+struct StoreScan {
+    SnapshotBuilder* out = nullptr;
+    ChangeTracker* tracker = nullptr;
+    bool delta = false;
+    const ModelChangeSet* changes = nullptr;
+    size_t removed = 0;         // entities removed since the baseline
+
+    template<typename Fp, typename Emit>
+    void visit(SnapshotSection store, uint64_t key, Fp&& fingerprint, Emit&& emit, bool row) {
+        bool include = true;
+        if (tracker) {
+            uint64_t fp = fingerprint();
+            if (delta) include = tracker->changed((uint32_t)store, key, fp);
+            tracker->stage((uint32_t)store, key, fp);
+        }
+        if (!out || !include) return;
+        // Rows are replaced whole: drop the old row before re-adding it
+        if (delta && row) out->add_tombstone(store, key);
+        emit();
+    }
+    void finish(SnapshotSection store) {
+        if (!tracker) return;
+        vector<uint64_t> gone = tracker->removed((uint32_t)store);
+        removed += gone.size();
+        if (out && delta) {
+            for (uint64_t k : gone) out->add_tombstone(store, k);
+        }
+    }
+    // One marked key; `entity` is null when the key is gone
+    template<typename T, typename Fp, typename Emit>
+    void visit_key(SnapshotSection store, uint64_t key, const T* entity, Fp&& fingerprint, Emit&& emit, bool row) {
+        if (!entity) {
+            if (tracker->contains((uint32_t)store, key)) {
+                tracker->stage_erase((uint32_t)store, key);
+                out->add_tombstone(store, key);
+                ++removed;
+            }
+            return;
+        }
+        uint64_t fp = fingerprint(*entity);
+        if (!tracker->changed((uint32_t)store, key, fp)) return;
+        tracker->stage_update((uint32_t)store, key, fp);
+        if (row) out->add_tombstone(store, key);
+        emit();
+    }
+    bool by_key(ModelStore ms) const { return changes && tracker && out && delta && !changes->whole(ms); }
+    // A persistent map keyed by one string: its marked keys, else every entry
+    template<typename Map, typename Fp, typename Emit>
+    void capture(SnapshotSection store, ModelStore ms, const Map& source, Fp&& fingerprint, Emit&& emit, bool row) {
+        if (by_key(ms)) {
+            for (auto& k : changes->of(ms)) {
+                const auto* v = source.get(k.first);
+                visit_key(store, key_of(k.first), v, fingerprint, [&] { emit(k.first, *v); }, row);
+            }
+            return;
+        }
+        for (auto& [key, v] : source) visit(store, key_of(key), [&] { return fingerprint(v); }, [&] { emit(key, v); }, row);
+        finish(store);
+    }
+
+    // State D, neurons and goals, read live: loop thread.
+    void bounded() {
+        for (auto& p : S.D) {
+            visit(SnapshotSection::StateD, key_of(p.first),
+                  [&] { return Fingerprint().add(p.second).h; },
+                  [&] { out->state_d.push_back({out->st.intern(p.first), 0, p.second}); ++out->entities; }, false);
+        }
+        finish(SnapshotSection::StateD);
+
+        // Neurons in id order with links as ids, like the text format
+        vector<const Neuron*> neurons_by_id;
+        neurons_by_id.reserve(S.N.size());
+        for (const Neuron& n : S.N) neurons_by_id.push_back(&n);
+        sort(neurons_by_id.begin(), neurons_by_id.end(), [](const Neuron* a, const Neuron* b) { return a->id < b->id; });
+        for (const Neuron* np : neurons_by_id) {
+            visit(SnapshotSection::Neurons, key_of_neuron(np->id), [&] { return fingerprint_neuron(*np); },
+                  [&] { out->add_neuron(*np); }, false);
+        }
+        finish(SnapshotSection::Neurons);
+
+        for (auto& p : goal_system) {
+            visit(SnapshotSection::Goals, key_of(p.first), [&] { return fingerprint_goal(p.second); },
+                  [&] { out->add_goal(p.second); }, false);
+        }
+        finish(SnapshotSection::Goals);
+    }
+
+    // Everything else, from a capture: any thread.
+    void captured(const CapturedModel& m) {
+        using Counts = ModelView::Counts;
+        const ModelView& lx = *m.lexicon;
+        capture(SnapshotSection::Tokens, ModelStore::Tokens, m.tokens, fingerprint_token,
+                [&](const string& k, const TokenRecord& t) { out->add_token(k, t); }, false);
+        capture(SnapshotSection::Concepts, ModelStore::Concepts, m.concepts,
+                [](auto& c) { return fingerprint_concept(*c); },
+                [&](const string& k, auto& c) { out->add_concept(k, *c); }, false);
+        capture(SnapshotSection::Embeddings, ModelStore::Embeddings, lx.tokens,
+                [](auto& t) { return fingerprint_embedding(*t); },
+                [&](const string& k, auto& t) { out->add_embedding(k, *t); }, false);
+        capture(SnapshotSection::Bigrams, ModelStore::Bigrams, lx.bigrams, fingerprint_row<Counts>,
+                [&](const string& k, auto& row) { out->add_bigram_row(k, *row); }, true);
+
+        if (by_key(ModelStore::Trigrams)) {
+            for (auto& k : changes->of(ModelStore::Trigrams)) {
+                const ModelView::Rows* rows = lx.trigrams.get(k.first);
+                const auto* row = rows ? rows->get(k.second) : nullptr;
+                visit_key(SnapshotSection::Trigrams, key_of(k.first, k.second), row, fingerprint_row<Counts>,
+                          [&] { out->add_trigram_row(k.first, k.second, **row); }, true);
+            }
+        } else {
+            for (auto& [w1, rows] : lx.trigrams) {
+                for (auto& [w2, row] : rows) {
+                    visit(SnapshotSection::Trigrams, key_of(w1, w2), [&] { return fingerprint_kv(*row); },
+                          [&] { out->add_trigram_row(w1, w2, *row); }, true);
+                }
+            }
+            finish(SnapshotSection::Trigrams);
+        }
+
+        capture(SnapshotSection::WorldEntities, ModelStore::WorldEntities, m.world_entities,
+                [](double v) { return Fingerprint().add(v).h; },
+                [&](const string& k, double v) { out->world_entities.push_back({out->st.intern(k), 0, v}); ++out->entities; }, false);
+        capture(SnapshotSection::WorldRelations, ModelStore::WorldRelations, m.world_relations, fingerprint_row<RelationRow>,
+                [&](const string& k, auto& row) { out->add_relation_row(k, *row); }, true);
+    }
+};
+
+// ===== APPLY =====
+
+template<typename M, typename KeyFn>
+void erase_keys(M& m, const unordered_set<uint64_t>& keys, KeyFn key) {
+    for (auto it = m.begin(); it != m.end();) {
+        if (keys.count(key(it->first))) it = m.erase(it);
+        else ++it;
+    }
+}
+
+// The lexicon is the part of the model lazy loading leaves mapped (see
+// ld_lazy): embeddings and n-gram counts. Applying into a Lexicon rather
+// than the globals lets promotion build it off to the side.
+struct Lexicon {
+    SampledMap<string, TokenConceptEmbedding>& embeddings;
+    map<string, map<string, int>>& bigrams;
+    map<string, map<string, map<string, int>>>& trigrams;
+};
+Lexicon live_lexicon() { return {token_concept_embedding_map, bigram_counts, trigram_counts}; }
+
+map<uint32_t, unordered_set<uint64_t>> tombstones_by_store(SnapshotReader& r) {
+    map<uint32_t, unordered_set<uint64_t>> by_store;
+    for (const SnapTombstone& t : r.records<SnapTombstone>(SnapshotSection::Tombstones)) by_store[t.section].insert(t.key);
+    return by_store;
+}
+
+void apply_tombstones(SnapshotReader& r) {
+    auto key_str = [](const string& k) { return key_of(k); };
+    for (auto& [store, keys] : tombstones_by_store(r)) {
+        switch ((SnapshotSection)store) {
+            case SnapshotSection::StateD: erase_keys(S.D, keys, key_str); break;
+            case SnapshotSection::Tokens: erase_keys(S.tokens, keys, key_str); break;
+            case SnapshotSection::Concepts: erase_keys(S.concepts, keys, key_str); break;
+            case SnapshotSection::Goals: erase_keys(goal_system, keys, key_str); break;
+            case SnapshotSection::WorldEntities: erase_keys(world_model.entity_states, keys, key_str); break;
+            case SnapshotSection::WorldRelations: erase_keys(world_model.relationships, keys, key_str); break;
+            case SnapshotSection::Neurons:
+                for (uint64_t k : keys) S.N.remove(S.N.find(neuron_of_key(k)));
+                break;
+            default: break;
+        }
+    }
+}
+
+void apply_lexicon_tombstones(SnapshotReader& r, Lexicon& lx) {
+    auto key_str = [](const string& k) { return key_of(k); };
+    for (auto& [store, keys] : tombstones_by_store(r)) {
+        switch ((SnapshotSection)store) {
+            case SnapshotSection::Embeddings: erase_keys(lx.embeddings, keys, key_str); break;
+            case SnapshotSection::Bigrams: erase_keys(lx.bigrams, keys, key_str); break;
+            case SnapshotSection::Trigrams:
+                for (auto it = lx.trigrams.begin(); it != lx.trigrams.end();) {
+                    const string& w1 = it->first;
+                    erase_keys(it->second, keys, [&](const string& w2) { return key_of(w1, w2); });
+                    if (it->second.empty()) it = lx.trigrams.erase(it);
+                    else ++it;
+                }
+                break;
+            default: break;
+        }
+    }
+}
+
+TokenConceptEmbedding read_embedding(SnapshotReader& r, const SnapEmbedding& se, const RecordArray<double>& values,
+                                     const RecordArray<SnapKV>& links) {
+    TokenConceptEmbedding tce;
+    tce.name = string(r.str(se.name));
+    tce.meaning = se.meaning;
+    tce.freq = se.freq;
+    tce.grounding_value = se.grounding;
+    tce.semantic_stability = se.stability;
+    tce.qualia_intensity = se.qualia_intensity;
+    tce.embedding.reserve(se.value_count);
+    for (uint32_t k = 0; k < se.value_count && se.value_begin + k < values.size(); k++) {
+        tce.embedding.push_back(values[se.value_begin + k]);
+    }
+    for (uint32_t k = 0; k < se.link_count && se.link_begin + k < links.size(); k++) {
+        const SnapKV& kv = links[se.link_begin + k];
+        tce.linked_concepts[string(r.str(kv.key))] = kv.value;
+    }
+    return tce;
+}
+
+// Embeddings, valence context and n-grams of one snapshot.
+void apply_lexicon(SnapshotReader& r, bool delta, Lexicon& lx) {
+    auto str = [&](uint32_t id) { return string(r.str(id)); };
+    if (delta) apply_lexicon_tombstones(r, lx);
+
+    auto embedding_values = r.records<double>(SnapshotSection::EmbeddingValues);
+    auto embedding_links = r.records<SnapKV>(SnapshotSection::EmbeddingLinks);
+    for (const SnapEmbedding& se : r.records<SnapEmbedding>(SnapshotSection::Embeddings)) {
+        TokenConceptEmbedding tce = read_embedding(r, se, embedding_values, embedding_links);
+        lx.embeddings[tce.name] = std::move(tce);
+    }
+    for (const SnapPairValue& vc : r.records<SnapPairValue>(SnapshotSection::ValenceContext)) {
+        auto it = lx.embeddings.find(str(vc.a));
+        if (it != lx.embeddings.end()) it->second.linked_valences.set(str(vc.b), vc.value);
+    }
+
+    for (const SnapBigram& bg : r.records<SnapBigram>(SnapshotSection::Bigrams)) {
+        lx.bigrams[str(bg.w1)][str(bg.w2)] = bg.count;
+    }
+    for (const SnapTrigram& tg : r.records<SnapTrigram>(SnapshotSection::Trigrams)) {
+        lx.trigrams[str(tg.w1)][str(tg.w2)][str(tg.w3)] = tg.count;
+    }
+}
+
+// Applies one snapshot except the lexicon. A delta frame first removes
+// tombstoned entities and replaces (rather than appends to) the bounded rings
+// it always carries.
+void apply_core(SnapshotReader& r, bool delta) {
+    auto str = [&](uint32_t id) { return string(r.str(id)); };
+
+    if (delta) {
+        apply_tombstones(r);
+        consciousness.active_qualia.clear();
+        consciousness_formula.psi_history.clear();
+        S.episodic_memory.clear();
+        S.valence_history.clear();
+        S.internal_thoughts.clear();
+        transformer_heads.clear();
+    }
+
+    map<string, const SnapshotScalar*> scalar_by_name;
+    auto scalars = snapshot_scalars();
+    for (auto& sc : scalars) scalar_by_name[sc.name] = &sc;
+    for (const SnapKV& kv : r.records<SnapKV>(SnapshotSection::Meta)) {
+        auto it = scalar_by_name.find(str(kv.key));
+        if (it != scalar_by_name.end()) it->second->set(kv.value);
+    }
+    for (const SnapKV& kv : r.records<SnapKV>(SnapshotSection::StateD)) S.D[str(kv.key)] = kv.value;
+
+    for (const SnapQualia& sq : r.records<SnapQualia>(SnapshotSection::Qualia)) {
+        Qualia q;
+        q.valence = sq.valence;
+        q.arousal = sq.arousal;
+        q.certainty = sq.certainty;
+        q.emergence_gen = sq.emergence_gen;
+        q.phenomenal_content = str(sq.content);
+        consciousness.active_qualia.push_back(q);
+    }
+    for (double v : r.records<double>(SnapshotSection::PsiHistory)) consciousness_formula.psi_history.push_back(v);
+
+    auto neuron_links = r.records<int32_t>(SnapshotSection::NeuronLinks);
+    vector<pair<NeuronHandle, const SnapNeuron*>> pending_links;
+    for (const SnapNeuron& sn : r.records<SnapNeuron>(SnapshotSection::Neurons)) {
+        Neuron n;
+        n.id = sn.id;
+        n.gen = sn.gen;
+        n.weight = sn.weight;
+        n.bias = sn.bias;
+        pending_links.emplace_back(S.N.add(std::move(n)), &sn);
+    }
+    // Links are ids; resolve once every neuron of this snapshot exists
+    for (auto& pl : pending_links) {
+        Neuron* n = S.N.get(pl.first);
+        if (!n) continue;
+        n->links.clear();
+        for (uint32_t k = 0; k < pl.second->link_count && pl.second->link_begin + k < neuron_links.size(); k++) {
+            NeuronHandle h = S.N.find(neuron_links[pl.second->link_begin + k]);
+            if (!h.is_null()) n->links.push_back(h);
+            else count_dangling_links(1);
+        }
+    }
+    S.N.touch_topology();
+
+    for (const SnapToken& stok : r.records<SnapToken>(SnapshotSection::Tokens)) {
+        string word = str(stok.word);
+        S.tokens[word] = Token{word, stok.meaning, stok.freq, vector<int>(), 4, 0.5};
+    }
+
+    auto concept_words = r.records<uint32_t>(SnapshotSection::ConceptWords);
+    for (const SnapConcept& sc : r.records<SnapConcept>(SnapshotSection::Concepts)) {
+        Concept c{};
+        c.name = str(sc.name);
+        c.value = sc.value;
+        for (uint32_t k = 0; k < sc.word_count && sc.word_begin + k < concept_words.size(); k++) {
+            c.related_words.push_back(str(concept_words[sc.word_begin + k]));
+        }
+        S.concepts[c.name] = c;
+    }
+
+    auto goal_subgoals = r.records<uint32_t>(SnapshotSection::GoalSubgoals);
+    auto goal_preconditions = r.records<SnapKV>(SnapshotSection::GoalPreconditions);
+    for (const SnapGoal& sg : r.records<SnapGoal>(SnapshotSection::Goals)) {
+        Goal g;
+        g.name = str(sg.name);
+        g.priority = sg.priority;
+        g.progress = sg.progress;
+        g.valence_alignment = sg.valence_alignment;
+        g.qualia_binding = sg.qualia_binding;
+        for (uint32_t k = 0; k < sg.sub_count && sg.sub_begin + k < goal_subgoals.size(); k++) {
+            g.subgoals.push_back(str(goal_subgoals[sg.sub_begin + k]));
+        }
+        for (uint32_t k = 0; k < sg.pre_count && sg.pre_begin + k < goal_preconditions.size(); k++) {
+            const SnapKV& kv = goal_preconditions[sg.pre_begin + k];
+            g.preconditions[str(kv.key)] = kv.value;
+        }
+        goal_system[g.name] = g;
+    }
+
+    for (const SnapKV& kv : r.records<SnapKV>(SnapshotSection::WorldEntities)) world_model.entity_states[str(kv.key)] = kv.value;
+    for (const SnapPairValue& rel : r.records<SnapPairValue>(SnapshotSection::WorldRelations)) {
+        world_model.relationships[str(rel.a)][str(rel.b)] = rel.value;
+    }
+
+    for (const SnapMemory& sm : r.records<SnapMemory>(SnapshotSection::Memories)) {
+        Memory m;
+        m.gen = sm.gen;
+        m.valence = sm.valence;
+        m.content = str(sm.content);
+        S.episodic_memory.push_back(m);
+    }
+    for (double v : r.records<double>(SnapshotSection::ValenceHistory)) S.valence_history.push_back(v);
+    for (uint32_t t : r.records<uint32_t>(SnapshotSection::Thoughts)) S.internal_thoughts.push_back(str(t));
+
+    for (const SnapHead& sh : r.records<SnapHead>(SnapshotSection::Heads)) {
+        TransformerHead head;
+        head.name = str(sh.name);
+        head.dim = sh.dim;
+        head.temperature = sh.temperature;
+        head.query_proj.resize(head.dim, 0);
+        head.key_proj.resize(head.dim, 0);
+        head.value_proj.resize(head.dim, 0);
+        transformer_heads.push_back(head);
+    }
+}
+
+void apply_snapshot(SnapshotReader& r, bool delta) {
+    apply_core(r, delta);
+    Lexicon live = live_lexicon();
+    apply_lexicon(r, delta, live);
+    ModelChanges::mark_all();
+}
+
+// ===== DELTA LOG =====
+// "<file>.delta" is a sequence of frames: uint64 length, then a complete
+// snapshot whose header names the base it extends and its sequence number,
+// padded to 8 bytes. A torn or corrupt tail frame ends the log.
+
+string delta_path(const string& f) { return f + ".delta"; }
+
+// The verified frames of a delta log that extend `base_id`, in sequence
+// order. They point into `buf`, which must outlive them.
+struct DeltaLog {
+    vector<uint64_t> buf;        // uint64 storage keeps each frame 8-byte aligned
+    vector<unique_ptr<SnapshotReader>> frames;
+    uint64_t bytes = 0;
+    bool stale = false;          // frames for a different base were present
+};
+
+DeltaLog read_delta_log(const string& f, uint64_t base_id) {
+    DeltaLog log;
+    string path = delta_path(f);
+    std::error_code ec;
+    uint64_t size = fs::file_size(path, ec);
+    if (ec || size == 0) return log;
+
+    log.buf.resize((size + 7) / 8);
+    {
+        ifstream in(path, ios::binary);
+        if (!in.read(reinterpret_cast<char*>(log.buf.data()), (streamsize)size)) return log;
+    }
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(log.buf.data());
+
+    uint64_t pos = 0;
+    while (pos + 8 <= size) {
+        uint64_t len;
+        memcpy(&len, data + pos, 8);
+        if (len == 0 || pos + 8 + len > size) break;
+        auto frame = make_unique<SnapshotReader>();
+        try {
+            frame->attach(data + pos + 8, len, path);
+            frame->verify_all();
+        } catch (const SnapshotError& e) {
+            cerr << "Delta log " << path << ": ignoring damaged tail (" << e.what() << ")" << endl;
+            break;
+        }
+        if (frame->base_id() != base_id) {
+            log.stale = true;
+        } else if (frame->sequence() == log.frames.size() + 1) {
+            log.frames.push_back(std::move(frame));
+        } else {
+            break;
+        }
+        pos += 8 + ((len + 7) & ~uint64_t(7));
+    }
+    log.bytes = pos;
+    // Drop a torn tail so the next append lands on a frame boundary
+    if (pos < size) fs::resize_file(path, pos, ec);
+    return log;
+}
+
+void append_delta_frame(const string& f, const string& frame) {
+    string path = delta_path(f);
+    FILE* out = fopen(path.c_str(), "ab");
+    if (!out) throw SnapshotError("cannot open " + path + " for append");
+    uint64_t len = frame.size();
+    static const char zeros[8] = {};
+    size_t pad = (size_t)(((len + 7) & ~uint64_t(7)) - len);
+    bool ok = fwrite(&len, 1, 8, out) == 8 && fwrite(frame.data(), 1, frame.size(), out) == frame.size() &&
+              fwrite(zeros, 1, pad, out) == pad;
+    ok = (fflush(out) == 0) && ok;
+    ok = snapshot_sync(out) && ok;
+    fclose(out);
+    if (!ok) throw SnapshotError("short write to " + path);
+}
+
+// ===== CHECKPOINT STATE =====
+
+struct CheckpointState {
+    std::mutex mutex;
+    string path;                 // base file the tracker baseline refers to
+    bool baseline_valid = false;
+    uint64_t epoch = 0;          // bumped when the baseline is replaced under a save
+    // Replaced, not cleared, on adopt so a save in flight keeps its own
+    std::shared_ptr<ChangeTracker> tracker = std::make_shared<ChangeTracker>();
+    CapturedModel model;         // loop thread only
+    bool model_current = false;  // false until it has followed every store
+    CheckpointStats stats;
+};
+CheckpointState& checkpoint_state() {
+    static CheckpointState cp;
+    return cp;
+}
+
+// Writes everything from scratch, so it also serves callers that edit the
+// model without marking it (the compact tool).
+uint64_t write_full(const string& f, uint64_t snapshot_id) {
+    CapturedModel m;
+    ModelChangeSet all;
+    all.mark_all();
+    m.refresh(all, ModelSnapshot::build());
+    SnapshotBuilder b;
+    b.add_small_state();
+    StoreScan scan{&b};
+    scan.bounded();
+    scan.captured(m);
+    SnapshotWriter w(f);
+    w.set_identity(snapshot_id);
+    b.write(w);
+    return w.finish();
+}
+
+double ms_since(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+}
+
+// A checkpoint split in two. Capture runs on the thread that mutates the
+// model: it brings the captured model up to date with the keys marked since
+// the last one, copies it into the job (sharing every entry) and records the
+// small and bounded state. Write may run anywhere: it fingerprints and
+// serializes the captured stores from the copy, then does the I/O.
+struct CheckpointJob {
+    string path;
+    bool full = false;
+    uint64_t snapshot_id = 0, base_id = 0, epoch = 0;
+    uint64_t wal_lsn = 0;        // learning-log events covered by the capture
+    uint32_t sequence = 0;
+    size_t changed = 0, removed = 0;
+    double capture_ms = 0;       // time the loop was held
+    SnapshotBuilder records;
+    CapturedModel model;
+    ModelChangeSet changes;      // keys marked since the last capture (deltas)
+    std::shared_ptr<ChangeTracker> tracker;
+};
+
+CheckpointJob capture_checkpoint(const string& f) {
+    promote_lexicon();
+    const NexusConfig& cfg = NexusConfig::get();
+    CheckpointState& cp = checkpoint_state();
+    std::lock_guard<std::mutex> lock(cp.mutex);
+    auto t0 = chrono::steady_clock::now();
+    std::error_code ec;
+
+    CheckpointJob job;
+    job.path = f;
+    job.epoch = cp.epoch;
+    job.snapshot_id = new_snapshot_id();
+    job.full = !cfg.delta_checkpoints || !cp.baseline_valid || cp.path != f || !fs::exists(f, ec) ||
+               cp.stats.delta_frames >= cfg.delta_max_frames ||
+               cp.stats.delta_bytes > cp.stats.base_bytes / 2;
+    if (!job.full) {
+        job.base_id = cp.stats.base_id;
+        job.sequence = cp.stats.delta_frames + 1;
+    }
+    job.wal_lsn = LearningLog::last_lsn();
+    // What changed since the last capture: the captured model follows it,
+    // a delta writes it and a full base reads everything regardless
+    ModelChangeSet changes = ModelChanges::take(ModelReader::Checkpoint);
+    try {
+        ModelSnapshot::publish();
+        if (!cp.model_current) changes.mark_all();
+        cp.model.refresh(changes, ModelSnapshot::current());
+        cp.model_current = true;
+        job.model = cp.model;
+        if (!job.full) job.changes = std::move(changes);
+        job.tracker = cp.tracker;
+        job.records.add_small_state();
+        StoreScan scan{&job.records, job.tracker.get(), !job.full};
+        scan.bounded();
+        job.removed = scan.removed;
+    } catch (...) {
+        // The marks are spent, so the next checkpoint cannot be a delta
+        cp.tracker->discard();
+        cp.baseline_valid = false;
+        cp.model_current = false;
+        throw;
+    }
+    job.capture_ms = ms_since(t0);
+    return job;
+}
+
+// Writes a captured job: a full base goes to a temp file that is synced and
+// renamed over `path`; a delta is one synced append to the log. The tracker
+// baseline only advances once the bytes are durable.
+void write_checkpoint(CheckpointJob& job) {
+    auto t0 = chrono::steady_clock::now();
+    uint64_t bytes = 0;
+    try {
+        StoreScan scan{&job.records, job.tracker.get(), !job.full, job.full ? nullptr : &job.changes};
+        scan.captured(job.model);
+        job.removed += scan.removed;
+        job.changed = job.records.entities;
+        job.model = CapturedModel();
+        if (job.full) {
+            SnapshotWriter w(job.path);
+            w.set_identity(job.snapshot_id);
+            job.records.write(w);
+            bytes = w.finish();
+            // The old log names the old base, so a crash before this removal
+            // leaves frames that load() skips as stale
+            std::error_code ec;
+            fs::remove(delta_path(job.path), ec);
+        } else {
+            SnapshotWriter w;
+            w.set_identity(job.snapshot_id, job.base_id, job.sequence);
+            job.records.write(w);
+            w.finish();
+            append_delta_frame(job.path, w.buffer());
+            bytes = 8 + ((w.buffer().size() + 7) & ~size_t(7));
+        }
+    } catch (...) {
+        CheckpointState& cp = checkpoint_state();
+        std::lock_guard<std::mutex> lock(cp.mutex);
+        job.tracker->discard();
+        if (job.tracker == cp.tracker) cp.baseline_valid = false;
+        throw;
+    }
+
+    CheckpointState& cp = checkpoint_state();
+    std::unique_lock<std::mutex> lock(cp.mutex);
+    if (job.epoch != cp.epoch || job.tracker != cp.tracker) {
+        // The model was reloaded or re-based while this was being written
+        job.tracker->discard();
+        cp.baseline_valid = false;
+    } else {
+        cp.tracker->commit();
+        cp.path = job.path;
+        cp.baseline_valid = true;
+    }
+    if (job.full) {
+        cp.stats.base_id = job.snapshot_id;
+        cp.stats.base_bytes = bytes;
+        cp.stats.delta_bytes = 0;
+        cp.stats.delta_frames = 0;
+        cp.stats.last_changed = 0;
+        cp.stats.last_removed = 0;
+    } else {
+        cp.stats.delta_bytes += bytes;
+        cp.stats.delta_frames = job.sequence;
+        cp.stats.last_changed = job.changed;
+        cp.stats.last_removed = job.removed;
+    }
+    cp.stats.last_kind = job.full ? "full" : "delta";
+    cp.stats.last_bytes = bytes;
+    cp.stats.last_ms = job.capture_ms + ms_since(t0);
+    lock.unlock();
+
+    // The learning events the capture covered are now durable in the snapshot
+    LearningLog::truncate(job.path, job.wal_lsn);
+}
+
+// Makes a freshly loaded base + delta log the checkpoint baseline. Caller
+// holds the checkpoint mutex.
+void adopt_baseline(const string& f, SnapshotReader& base, const DeltaLog& dl) {
+    CheckpointState& cp = checkpoint_state();
+    cp.tracker = std::make_shared<ChangeTracker>();
+    // The baseline is the model as it is now
+    ModelSnapshot::publish();
+    ModelChangeSet all = ModelChanges::take(ModelReader::Checkpoint);
+    all.mark_all();
+    cp.model.refresh(all, ModelSnapshot::current());
+    cp.model_current = true;
+    StoreScan scan{nullptr, cp.tracker.get()};
+    scan.bounded();
+    scan.captured(cp.model);
+    cp.tracker->commit();
+    cp.path = f;
+    cp.baseline_valid = true;
+    cp.stats.base_id = base.snapshot_id();
+    cp.stats.base_bytes = base.file_size();
+    cp.stats.delta_bytes = dl.bytes;
+    cp.stats.delta_frames = (uint32_t)dl.frames.size();
+}
+}
+
+// ===== ENTRY POINTS =====
+
+namespace {
+std::atomic<size_t> dangling_links{0};
+}
+
+size_t dangling_links_dropped() { return dangling_links; }
+void count_dangling_links(size_t n) { dangling_links += n; }
+
+void print_load_summary() {
+    cout << "[Loaded state from generation " << S.g << "]\n";
+    cout << "  - " << S.N.size() << " neurons\n";
+    cout << "  - " << token_concept_embedding_map.size() << " embeddings\n";
+    cout << "  - " << bigram_counts.size() << " bigrams\n";
+    cout << "  - " << trigram_counts.size() << " trigrams\n";
+    cout << "  - " << goal_system.size() << " goals\n";
+    cout << "  - " << S.episodic_memory.size() << " memories\n";
+    cout << "  - Sentience: " << S.sentience_ratio << "%\n";
+    cout << "  - Phi: " << consciousness.phi_value << "\n";
+}
+
+void sv_binary(const string& f, uint64_t snapshot_id) {
+    uint64_t bytes = write_full(f, snapshot_id ? snapshot_id : new_snapshot_id());
+    cout << "[Saved " << S.N.size() << " neurons, "
+         << token_concept_embedding_map.size() << " embeddings, "
+         << bigram_counts.size() << " bigrams to " << f
+         << " (" << MemoryAccounting::format_bytes(bytes) << ")]\n";
+}
+
+void ld_binary(const string& f) {
+    SnapshotReader r;
+    r.open(f);
+    // Verify everything up front so a damaged file is rejected before any
+    // of it is applied
+    r.verify_all();
+    apply_snapshot(r, false);
+}
+
+// sv/ld are the model's full-snapshot entry points. sv writes the binary
+// snapshot unless NEXUS_SNAPSHOT_FORMAT=text; ld accepts either format and
+// applies "<f>.delta" on top of a binary base.
+void sv(const string& f) {
+    promote_lexicon();
+    CheckpointState& cp = checkpoint_state();
+    std::lock_guard<std::mutex> lock(cp.mutex);
+    // A new base under the checkpoint's file orphans its delta log
+    if (f == cp.path) {
+        cp.baseline_valid = false;
+        cp.epoch++;
+        std::error_code ec;
+        fs::remove(delta_path(f), ec);
+    }
+    try {
+        if (NexusConfig::get().snapshot_format == "text") export_text(f);
+        else sv_binary(f);
+    } catch (const SnapshotError& e) {
+        cerr << "Failed to save " << f << ": " << e.what() << endl;
+    }
+}
+
+void ld(const string& f) {
+    promote_lexicon();
+    CheckpointState& cp = checkpoint_state();
+    std::lock_guard<std::mutex> lock(cp.mutex);
+    // The tracker can only adopt the loaded state as its baseline when the
+    // load did not merge into an existing model
+    bool was_fresh = S.N.empty() && S.tokens.empty() && token_concept_embedding_map.empty() && bigram_counts.empty();
+    cp.baseline_valid = false;
+    cp.epoch++;
+
+    if (!SnapshotReader::is_snapshot(f)) {
+        import_text(f);
+        return;
+    }
+    try {
+        SnapshotReader r;
+        r.open(f);
+        r.verify_all();
+        apply_snapshot(r, false);
+        DeltaLog dl = read_delta_log(f, r.snapshot_id());
+        for (auto& frame : dl.frames) apply_snapshot(*frame, true);
+        print_load_summary();
+        if (!dl.frames.empty()) cout << "  - " << dl.frames.size() << " delta checkpoints applied\n";
+
+        if (was_fresh && !dl.stale) adopt_baseline(f, r, dl);
+    } catch (const SnapshotError& e) {
+        cerr << "Failed to load snapshot " << f << ": " << e.what() << endl;
+    }
+}
+
+void checkpoint(const string& f) {
+    // A background save owns the staged fingerprints until it finishes
+    PersistenceService::flush();
+    if (NexusConfig::get().snapshot_format == "text") {
+        uint64_t wal_lsn = LearningLog::last_lsn();
+        sv(f);
+        LearningLog::truncate(f, wal_lsn);
+        return;
+    }
+    try {
+        CheckpointJob job = capture_checkpoint(f);
+        write_checkpoint(job);
+    } catch (const std::exception& e) {
+        cerr << "Checkpoint of " << f << " failed: " << e.what() << endl;
+        return;
+    }
+    CheckpointStats cs = checkpoint_stats();
+    cout << "[Checkpoint " << cs.last_kind << " " << f << ": " << MemoryAccounting::format_bytes(cs.last_bytes);
+    if (cs.last_kind == "delta") cout << ", " << cs.last_changed << " changed, frame " << cs.delta_frames;
+    cout << ", " << fixed << setprecision(1) << cs.last_ms << " ms]\n";
+}
+
+CheckpointStats checkpoint_stats() {
+    CheckpointState& cp = checkpoint_state();
+    std::lock_guard<std::mutex> lock(cp.mutex);
+    return cp.stats;
+}
+
+// ===== LAZY LOAD =====
+// ld_lazy() keeps the base and its delta frames mapped as layers, base
+// first. Records are written in key order, so a lookup is a binary search
+// per layer, newest first: a layer holding the key answers, a layer that
+// tombstones it means the key was removed. promote_lexicon() builds the
+// lexicon from the same layers off to the side, swaps it into the live maps
+// and releases the mapping.
+
+namespace {
+struct LazyLayer {
+    SnapshotReader* r = nullptr;
+    unordered_set<uint64_t> dead_embeddings, dead_bigrams, dead_trigrams;
+};
+
+struct LazyState {
+    std::shared_mutex mapping;       // lookups vs. promotion releasing the layers
+    std::mutex promote;              // one promotion at a time
+    std::atomic<bool> active{false};
+    std::atomic<size_t> lookups{0};
+    string path;
+    bool adopt = false;              // becomes the checkpoint baseline when promoted
+    unique_ptr<SnapshotReader> base;
+    DeltaLog delta;
+    vector<LazyLayer> layers;
+    LazyLoadStats stats;
+};
+LazyState& lazy_state() {
+    static LazyState lz;
+    return lz;
+}
+
+// Index of the first record for which `before` is false; `before` must hold
+// for a prefix of the array.
+template<typename T, typename Pred>
+size_t partition_point(const RecordArray<T>& a, Pred before) {
+    size_t lo = 0, hi = a.size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (before(a[mid])) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+template<typename T, typename KeyFn>
+bool sorted_by(const RecordArray<T>& a, KeyFn key) {
+    for (size_t i = 1; i < a.size(); i++) {
+        if (key(a[i]) < key(a[i - 1])) return false;
+    }
+    return true;
+}
+
+// SnapshotBuilder writes every store in map order; anything else cannot be
+// searched in place.
+bool lexicon_sorted(SnapshotReader& r) {
+    auto s = [&](uint32_t id) { return r.str(id); };
+    return sorted_by(r.records<SnapEmbedding>(SnapshotSection::Embeddings), [&](const SnapEmbedding& e) { return s(e.name); }) &&
+           sorted_by(r.records<SnapPairValue>(SnapshotSection::ValenceContext), [&](const SnapPairValue& v) { return s(v.a); }) &&
+           sorted_by(r.records<SnapBigram>(SnapshotSection::Bigrams), [&](const SnapBigram& b) { return s(b.w1); }) &&
+           sorted_by(r.records<SnapTrigram>(SnapshotSection::Trigrams),
+                     [&](const SnapTrigram& t) { return pair(s(t.w1), s(t.w2)); });
+}
+
+LazyLayer make_layer(SnapshotReader& r) {
+    LazyLayer layer;
+    layer.r = &r;
+    for (auto& [store, keys] : tombstones_by_store(r)) {
+        switch ((SnapshotSection)store) {
+            case SnapshotSection::Embeddings: layer.dead_embeddings = std::move(keys); break;
+            case SnapshotSection::Bigrams: layer.dead_bigrams = std::move(keys); break;
+            case SnapshotSection::Trigrams: layer.dead_trigrams = std::move(keys); break;
+            default: break;
+        }
+    }
+    // Loads the string table now, so lookups share the reader read-only
+    r.string_count();
+    return layer;
+}
+}
+
+bool ld_lazy(const string& f) {
+    if (!SnapshotReader::is_snapshot(f)) return false;
+    promote_lexicon();
+    LazyState& lz = lazy_state();
+    CheckpointState& cp = checkpoint_state();
+    std::lock_guard<std::mutex> lock(cp.mutex);
+    // A lexicon already in memory would have to be merged with the file
+    if (!token_concept_embedding_map.empty() || !bigram_counts.empty() || !trigram_counts.empty()) return false;
+    bool was_fresh = S.N.empty() && S.tokens.empty();
+    auto t0 = chrono::steady_clock::now();
+
+    try {
+        auto base = make_unique<SnapshotReader>();
+        base->open(f);
+        base->verify_all();
+        DeltaLog dl = read_delta_log(f, base->snapshot_id());
+        vector<LazyLayer> layers;
+        layers.push_back(make_layer(*base));
+        for (auto& frame : dl.frames) layers.push_back(make_layer(*frame));
+        for (LazyLayer& layer : layers) {
+            if (!lexicon_sorted(*layer.r)) {
+                cerr << "Snapshot " << f << " is not in key order, loading it in full" << endl;
+                return false;
+            }
+        }
+
+        cp.baseline_valid = false;
+        cp.epoch++;
+        apply_core(*base, false);
+        for (auto& frame : dl.frames) apply_core(*frame, true);
+
+        std::unique_lock<std::shared_mutex> w(lz.mapping);
+        lz.path = f;
+        lz.adopt = was_fresh && !dl.stale;
+        lz.base = std::move(base);
+        lz.delta = std::move(dl);
+        lz.layers = std::move(layers);
+        lz.lookups = 0;
+        lz.stats = LazyLoadStats();
+        lz.stats.mapped = true;
+        lz.stats.map_ms = ms_since(t0);
+        lz.active = true;
+    } catch (const SnapshotError& e) {
+        cerr << "Failed to map snapshot " << f << ": " << e.what() << endl;
+        return false;
+    }
+    cout << "[Mapped " << f << " at generation " << S.g << " in " << fixed << setprecision(1)
+         << lz.stats.map_ms << " ms, lexicon deferred]\n";
+    return true;
+}
+
+void promote_lexicon() {
+    LazyState& lz = lazy_state();
+    if (!lz.active) return;
+    std::lock_guard<std::mutex> lock(lz.promote);
+    if (!lz.active) return;
+    auto t0 = chrono::steady_clock::now();
+
+    // Lookups keep reading the layers while this builds
+    SampledMap<string, TokenConceptEmbedding> embeddings;
+    map<string, map<string, int>> bigrams;
+    map<string, map<string, map<string, int>>> trigrams;
+    Lexicon lx{embeddings, bigrams, trigrams};
+    for (size_t i = 0; i < lz.layers.size(); i++) apply_lexicon(*lz.layers[i].r, i > 0, lx);
+
+    CheckpointState& cp = checkpoint_state();
+    std::lock_guard<std::mutex> cp_lock(cp.mutex);
+    {
+        std::unique_lock<std::shared_mutex> w(lz.mapping);
+        token_concept_embedding_map.swap_entries(embeddings);
+        bigram_counts.swap(bigrams);
+        trigram_counts.swap(trigrams);
+        ModelChanges::mark_all();
+        // Lookups switch to the published view below
+        ModelSnapshot::publish();
+        lz.active = false;
+    }
+    if (lz.adopt) adopt_baseline(lz.path, *lz.base, lz.delta);
+    {
+        std::unique_lock<std::shared_mutex> w(lz.mapping);
+        lz.stats.promoted = true;
+        lz.stats.promote_ms = ms_since(t0);
+        lz.stats.mapped_lookups = lz.lookups;
+    }
+
+    print_load_summary();
+    if (!lz.delta.frames.empty()) cout << "  - " << lz.delta.frames.size() << " delta checkpoints applied\n";
+    cout << "  - Lexicon promoted in " << fixed << setprecision(1) << lz.stats.promote_ms << " ms\n";
+    lz.layers.clear();
+    lz.delta = DeltaLog();
+    lz.base.reset();
+}
+
+bool lexicon_mapped() { return lazy_state().active; }
+
+LazyLoadStats lazy_load_stats() {
+    LazyState& lz = lazy_state();
+    std::shared_lock<std::shared_mutex> lock(lz.mapping);
+    LazyLoadStats s = lz.stats;
+    if (!s.promoted) s.mapped_lookups = lz.lookups;
+    return s;
+}
+
+map<string, int> lookup_bigrams(const string& w1) {
+    LazyState& lz = lazy_state();
+    std::shared_lock<std::shared_mutex> lock(lz.mapping);
+    if (!lz.active) {
+        const ModelView::Counts* row = ModelSnapshot::current()->bigram_row(w1);
+        return row ? *row : map<string, int>();
+    }
+    lz.lookups++;
+    string_view key = w1;
+    for (auto layer = lz.layers.rbegin(); layer != lz.layers.rend(); ++layer) {
+        SnapshotReader& r = *layer->r;
+        auto rows = r.records<SnapBigram>(SnapshotSection::Bigrams);
+        size_t b = partition_point(rows, [&](const SnapBigram& x) { return r.str(x.w1) < key; });
+        size_t e = partition_point(rows, [&](const SnapBigram& x) { return r.str(x.w1) <= key; });
+        if (b < e) {
+            map<string, int> row;
+            for (size_t i = b; i < e; i++) row[string(r.str(rows[i].w2))] = rows[i].count;
+            return row;
+        }
+        if (layer->dead_bigrams.count(key_of(key))) break;
+    }
+    return {};
+}
+
+map<string, int> lookup_trigrams(const string& w1, const string& w2) {
+    LazyState& lz = lazy_state();
+    std::shared_lock<std::shared_mutex> lock(lz.mapping);
+    if (!lz.active) {
+        const ModelView::Counts* row = ModelSnapshot::current()->trigram_row(w1, w2);
+        return row ? *row : map<string, int>();
+    }
+    lz.lookups++;
+    pair<string_view, string_view> key(w1, w2);
+    for (auto layer = lz.layers.rbegin(); layer != lz.layers.rend(); ++layer) {
+        SnapshotReader& r = *layer->r;
+        auto rows = r.records<SnapTrigram>(SnapshotSection::Trigrams);
+        auto row_key = [&](const SnapTrigram& x) { return pair(r.str(x.w1), r.str(x.w2)); };
+        size_t b = partition_point(rows, [&](const SnapTrigram& x) { return row_key(x) < key; });
+        size_t e = partition_point(rows, [&](const SnapTrigram& x) { return row_key(x) <= key; });
+        if (b < e) {
+            map<string, int> row;
+            for (size_t i = b; i < e; i++) row[string(r.str(rows[i].w3))] = rows[i].count;
+            return row;
+        }
+        if (layer->dead_trigrams.count(key_of(key.first, key.second))) break;
+    }
+    return {};
+}
+
+bool lookup_embedding(const string& word, TokenConceptEmbedding& out) {
+    LazyState& lz = lazy_state();
+    std::shared_lock<std::shared_mutex> lock(lz.mapping);
+    if (!lz.active) {
+        const ModelView::Token* t = ModelSnapshot::current()->token(word);
+        if (!t) return false;
+        out.name = word;
+        out.meaning = t->meaning;
+        out.freq = t->freq;
+        out.grounding_value = t->grounding;
+        out.semantic_stability = t->stability;
+        out.qualia_intensity = t->qualia_intensity;
+        out.embedding = t->embedding;
+        out.linked_concepts = t->linked_concepts;
+        return true;
+    }
+    lz.lookups++;
+    string_view key = word;
+    for (auto layer = lz.layers.rbegin(); layer != lz.layers.rend(); ++layer) {
+        SnapshotReader& r = *layer->r;
+        auto records = r.records<SnapEmbedding>(SnapshotSection::Embeddings);
+        size_t i = partition_point(records, [&](const SnapEmbedding& x) { return r.str(x.name) < key; });
+        if (i < records.size() && r.str(records[i].name) == key) {
+            out = read_embedding(r, records[i], r.records<double>(SnapshotSection::EmbeddingValues),
+                                 r.records<SnapKV>(SnapshotSection::EmbeddingLinks));
+            // A layer carries the valence context of every embedding it holds
+            auto valences = r.records<SnapPairValue>(SnapshotSection::ValenceContext);
+            size_t v = partition_point(valences, [&](const SnapPairValue& x) { return r.str(x.a) < key; });
+            for (; v < valences.size() && r.str(valences[v].a) == key; v++) {
+                out.linked_valences.set(string(r.str(valences[v].b)), valences[v].value);
+            }
+            return true;
+        }
+        if (layer->dead_embeddings.count(key_of(key))) break;
+    }
+    return false;
+}
+
+// ===== BACKGROUND SAVES =====
+
+namespace {
+struct ServiceState {
+    std::mutex mutex;
+    std::condition_variable idle;
+    bool in_flight = false;
+    string pending;              // path of the next save, empty when none
+    std::thread worker;
+    SaveStatus status;
+
+    ~ServiceState() {
+        if (worker.joinable()) worker.join();
+    }
+};
+ServiceState& service_state() {
+    static ServiceState st;
+    return st;
+}
+
+void finish_save(const string& error, double capture_ms, double write_ms) {
+    ServiceState& st = service_state();
+    CheckpointStats cs = checkpoint_stats();
+    std::lock_guard<std::mutex> lock(st.mutex);
+    st.in_flight = false;
+    st.status.last_result = error.empty() ? "ok" : "error";
+    st.status.last_error = error;
+    st.status.last_kind = error.empty() ? cs.last_kind : "";
+    st.status.last_bytes = error.empty() ? cs.last_bytes : 0;
+    st.status.capture_ms = capture_ms;
+    st.status.write_ms = write_ms;
+    if (error.empty()) st.status.completed++;
+    else st.status.failed++;
+    st.status.state = st.pending.empty() ? "idle" : "pending";
+    st.idle.notify_all();
+}
+}
+
+void PersistenceService::request(const string& f) {
+    ServiceState& st = service_state();
+    std::lock_guard<std::mutex> lock(st.mutex);
+    if (!st.pending.empty()) st.status.coalesced++;
+    st.pending = f;
+    if (!st.in_flight) st.status.state = "pending";
+}
+
+void PersistenceService::poll() {
+    ServiceState& st = service_state();
+    string path;
+    {
+        std::lock_guard<std::mutex> lock(st.mutex);
+        if (st.pending.empty() || st.in_flight) return;
+        path = std::move(st.pending);
+        st.pending.clear();
+        st.in_flight = true;
+        st.status.state = "saving";
+        st.status.generation = S.g;
+        if (st.worker.joinable()) st.worker.join();
+    }
+
+    // The text format streams straight from the live model, so it cannot be
+    // handed to another thread
+    if (NexusConfig::get().snapshot_format == "text") {
+        auto t0 = chrono::steady_clock::now();
+        uint64_t wal_lsn = LearningLog::last_lsn();
+        string error;
+        try {
+            export_text(path);
+            LearningLog::truncate(path, wal_lsn);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        finish_save(error, 0, ms_since(t0));
+        return;
+    }
+
+    CheckpointJob job;
+    try {
+        job = capture_checkpoint(path);
+    } catch (const std::exception& e) {
+        finish_save(e.what(), 0, 0);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(st.mutex);
+    st.worker = std::thread([job = std::move(job)]() mutable {
+        auto t0 = chrono::steady_clock::now();
+        string error;
+        try {
+            write_checkpoint(job);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        finish_save(error, job.capture_ms, ms_since(t0));
+    });
+}
+
+void PersistenceService::flush() {
+    ServiceState& st = service_state();
+    std::unique_lock<std::mutex> lock(st.mutex);
+    st.idle.wait(lock, [&] { return !st.in_flight; });
+    std::thread worker = std::move(st.worker);
+    lock.unlock();
+    if (worker.joinable()) worker.join();
+}
+
+SaveStatus PersistenceService::status() {
+    ServiceState& st = service_state();
+    std::lock_guard<std::mutex> lock(st.mutex);
+    return st.status;
+}
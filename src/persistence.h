@@ -0,0 +1,144 @@
+#ifndef PERSISTENCE_H
+#define PERSISTENCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+
+// Model persistence.
+//
+// sv()/ld() read and write full snapshots (binary by default, see
+// snapshot.h; text via export_text/import_text). checkpoint() is the
+// incremental path used by autosave and explicit saves: it compares the
+// entities written since the previous checkpoint (the keys marked in
+// ModelChanges, see model_changes.h) against the fingerprints taken then and
+// appends only the changed and removed ones to "<file>.delta" as one delta
+// frame. After enough frames, or once the deltas grow past half the base, the
+// next checkpoint compacts everything into a fresh base snapshot and starts a
+// new delta log. ld() applies base + delta frames.
+//
+// A delta costs what changed: only marked keys are fingerprinted. A store
+// marked as a whole (decay passes, loads) falls back to fingerprinting every
+// entity in it, as do the bounded stores (state D, neurons, goals) and every
+// full base.
+//
+// The large stores are saved from immutable copies: the published ModelView
+// for the lexicon and persistent maps for S.tokens, the concepts and the
+// world model, brought up to date from the same marks. Copies share their
+// entries, so handing one to a save costs what changed, and fingerprinting
+// and serializing happen off the simulation loop.
+
+struct TokenConceptEmbedding;
+
+void sv_binary(const std::string& f, uint64_t snapshot_id = 0);
+void ld_binary(const std::string& f);
+void checkpoint(const std::string& f);
+void print_load_summary();
+
+// Neuron links dropped while loading because their target id is not in the
+// snapshot, across all loads since startup.
+size_t dangling_links_dropped();
+void count_dangling_links(size_t n);
+
+struct CheckpointStats {
+    std::string last_kind;          // "full", "delta", "none"
+    uint64_t last_bytes = 0;
+    double last_ms = 0;
+    size_t last_changed = 0;        // entities written by the last delta
+    size_t last_removed = 0;
+    uint64_t base_id = 0;
+    uint64_t base_bytes = 0;
+    uint64_t delta_bytes = 0;
+    uint32_t delta_frames = 0;
+};
+CheckpointStats checkpoint_stats();
+
+// Lazy loading (NEXUS_LAZY_LOAD). ld_lazy() maps a binary snapshot and its
+// delta log and applies everything except the lexicon (embeddings, bigram
+// and trigram counts), which is served straight from the mapped records by
+// the lookup_*() functions. promote_lexicon() materializes it into the live
+// maps; everything that writes or scans the whole model (sv, ld, checkpoints,
+// the simulation loop) promotes first, and the lookups read the published
+// ModelView from then on. Returns false, having applied nothing, when `f` is not a
+// binary snapshot or cannot be searched in place; load it with ld() then.
+bool ld_lazy(const std::string& f);
+void promote_lexicon();
+bool lexicon_mapped();
+
+std::map<std::string, int> lookup_bigrams(const std::string& w1);
+std::map<std::string, int> lookup_trigrams(const std::string& w1, const std::string& w2);
+bool lookup_embedding(const std::string& word, TokenConceptEmbedding& out);
+
+struct LazyLoadStats {
+    bool mapped = false;            // the last load was lazy
+    bool promoted = false;
+    double map_ms = 0;              // ld_lazy(): header, checksums, non-lexicon state
+    double promote_ms = 0;
+    uint64_t mapped_lookups = 0;    // lookups answered from the mapping
+};
+LazyLoadStats lazy_load_stats();
+
+// Background saves. request() may be called from any thread; the model is
+// captured on the next poll() from the simulation loop (the only thread that
+// mutates it), which holds the loop for the changes since the last capture
+// and the bounded stores, and written on a worker thread. Requests arriving while a save is pending or in flight coalesce
+// into a single follow-up save.
+struct SaveStatus {
+    std::string state = "idle";     // idle, pending, saving
+    std::string last_result;        // "", ok, error
+    std::string last_error;
+    std::string last_kind;          // full, delta
+    uint64_t last_bytes = 0;
+    double capture_ms = 0;          // time the simulation loop was held
+    double write_ms = 0;            // background serialize and I/O time
+    int generation = 0;             // S.g at the last capture
+    uint64_t completed = 0, failed = 0, coalesced = 0;
+};
+
+class PersistenceService {
+public:
+    static void request(const std::string& f);
+    static void poll();
+    // Blocks until no save is in flight.
+    static void flush();
+    static SaveStatus status();
+};
+
+// Per-store fingerprints from the last checkpoint. Stores are identified by
+// the snapshot section that holds their primary records.
+class ChangeTracker {
+public:
+    struct Entry { uint64_t key, fingerprint; };
+
+    // True when `key` is absent from the baseline or its fingerprint differs.
+    bool changed(uint32_t store, uint64_t key, uint64_t fingerprint) const;
+    bool contains(uint32_t store, uint64_t key) const;
+    // Records the current fingerprint for the next baseline. A store staged
+    // this way is replaced whole by what was staged.
+    void stage(uint32_t store, uint64_t key, uint64_t fingerprint);
+    // Baseline keys of `store` that were not staged this pass.
+    std::vector<uint64_t> removed(uint32_t store);
+    // Changes to a store captured by key; the rest of its baseline carries over.
+    void stage_update(uint32_t store, uint64_t key, uint64_t fingerprint);
+    void stage_erase(uint32_t store, uint64_t key);
+    // Staged fingerprints and changes become the baseline.
+    void commit();
+    void discard() { staged_.clear(); patches_.clear(); }
+    void clear() { baseline_.clear(); discard(); }
+    size_t bytes() const;
+
+private:
+    struct Patch {
+        std::vector<Entry> updates;
+        std::vector<uint64_t> erased;
+    };
+    const Entry* find(uint32_t store, uint64_t key) const;
+
+    std::map<uint32_t, std::vector<Entry>> baseline_;  // sorted by key
+    std::map<uint32_t, std::vector<Entry>> staged_;
+    std::map<uint32_t, Patch> patches_;
+};
+
+#endif
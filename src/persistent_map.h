@@ -0,0 +1,246 @@
+#pragma once
+#ifndef PERSISTENT_MAP_H
+#define PERSISTENT_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Immutable ordered map with O(1) copies.
+//
+// An AVL tree whose nodes are never modified after construction: set() and
+// erase() copy the O(log n) nodes on the path to the key and share every
+// other subtree with the map they were applied to. Copying a map copies one
+// pointer, so a new version costs what changed in it, and older versions
+// stay valid for as long as someone holds them. Nodes are reference counted,
+// so versions may be read and released from any thread; a single map object
+// is not synchronized, like any other container.
+//
+// Reads look like std::map: find(), count(), size(), and in-order iteration
+// over std::pair<const K, V>.
+template<typename K, typename V, typename Compare = std::less<K>>
+class PersistentMap {
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+    struct Node {
+        std::pair<const K, V> kv;
+        NodePtr left, right;
+        size_t size;
+        int height;
+        Node(std::pair<const K, V> p, NodePtr l, NodePtr r)
+            : kv(std::move(p)), left(std::move(l)), right(std::move(r)),
+              size(1 + count_of(left) + count_of(right)),
+              height(1 + std::max(height_of(left), height_of(right))) {}
+    };
+
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<const K, V>;
+    using size_type = size_t;
+
+    // In-order iterator; holds the path to the current node.
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = PersistentMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        const_iterator() = default;
+        reference operator*() const { return path_.back()->kv; }
+        pointer operator->() const { return &path_.back()->kv; }
+        const_iterator& operator++() {
+            const Node* n = path_.back();
+            path_.pop_back();
+            descend_left(n->right.get());
+            return *this;
+        }
+        const_iterator operator++(int) { const_iterator t = *this; ++*this; return t; }
+        bool operator==(const const_iterator& o) const {
+            return path_.empty() ? o.path_.empty() : !o.path_.empty() && path_.back() == o.path_.back();
+        }
+
+    private:
+        friend class PersistentMap;
+        void descend_left(const Node* n) {
+            for (; n; n = n->left.get()) path_.push_back(n);
+        }
+        // Nodes whose own entry (and right subtree) is still to be visited;
+        // back() is the current one.
+        std::vector<const Node*> path_;
+    };
+    using iterator = const_iterator;
+
+    PersistentMap() = default;
+
+    size_t size() const { return count_of(root_); }
+    bool empty() const { return !root_; }
+    void clear() { root_.reset(); }
+
+    const_iterator begin() const {
+        const_iterator it;
+        it.path_.reserve(root_ ? root_->height : 0);
+        it.descend_left(root_.get());
+        return it;
+    }
+    const_iterator end() const { return const_iterator(); }
+
+    const_iterator find(const K& k) const {
+        const_iterator it;
+        for (const Node* n = root_.get(); n;) {
+            if (less_(k, n->kv.first)) {
+                it.path_.push_back(n);
+                n = n->left.get();
+            } else if (less_(n->kv.first, k)) {
+                n = n->right.get();
+            } else {
+                it.path_.push_back(n);
+                return it;
+            }
+        }
+        return end();
+    }
+    // Value for `k`, or nullptr; cheaper than find() when no iteration follows.
+    const V* get(const K& k) const {
+        for (const Node* n = root_.get(); n;) {
+            if (less_(k, n->kv.first)) n = n->left.get();
+            else if (less_(n->kv.first, k)) n = n->right.get();
+            else return &n->kv.second;
+        }
+        return nullptr;
+    }
+    size_t count(const K& k) const { return get(k) ? 1 : 0; }
+
+    // Inserts or replaces the value for `k`.
+    void set(const K& k, V v) { root_ = insert(root_, k, std::move(v)); }
+    // Removes `k`; returns whether it was present.
+    bool erase(const K& k) {
+        bool found = false;
+        root_ = remove(root_, k, found);
+        return found;
+    }
+
+    // Balanced map of entries already sorted by key and unique, in O(n).
+    static PersistentMap from_sorted(std::vector<value_type> entries) {
+        PersistentMap m;
+        m.root_ = build(entries, 0, entries.size());
+        return m;
+    }
+
+    // True when both maps are the same version (or both empty).
+    bool same_as(const PersistentMap& o) const { return root_ == o.root_; }
+
+private:
+    static size_t count_of(const NodePtr& n) { return n ? n->size : 0; }
+    static int height_of(const NodePtr& n) { return n ? n->height : 0; }
+
+    static NodePtr make(std::pair<const K, V> kv, NodePtr l, NodePtr r) {
+        return std::make_shared<const Node>(std::move(kv), std::move(l), std::move(r));
+    }
+
+    // New node for `kv` over `l` and `r`, rotated back into AVL shape when
+    // one side is two levels taller.
+    static NodePtr balance(const std::pair<const K, V>& kv, NodePtr l, NodePtr r) {
+        int hl = height_of(l), hr = height_of(r);
+        if (hl > hr + 1) {
+            if (height_of(l->left) >= height_of(l->right)) {
+                return make(l->kv, l->left, make(kv, l->right, std::move(r)));
+            }
+            const Node* lr = l->right.get();
+            return make(lr->kv, make(l->kv, l->left, lr->left), make(kv, lr->right, std::move(r)));
+        }
+        if (hr > hl + 1) {
+            if (height_of(r->right) >= height_of(r->left)) {
+                return make(r->kv, make(kv, std::move(l), r->left), r->right);
+            }
+            const Node* rl = r->left.get();
+            return make(rl->kv, make(kv, std::move(l), rl->left), make(r->kv, rl->right, r->right));
+        }
+        return make(kv, std::move(l), std::move(r));
+    }
+
+    NodePtr insert(const NodePtr& n, const K& k, V&& v) const {
+        if (!n) return make({k, std::move(v)}, nullptr, nullptr);
+        if (less_(k, n->kv.first)) return balance(n->kv, insert(n->left, k, std::move(v)), n->right);
+        if (less_(n->kv.first, k)) return balance(n->kv, n->left, insert(n->right, k, std::move(v)));
+        return make({n->kv.first, std::move(v)}, n->left, n->right);
+    }
+
+    // `n` without its leftmost entry, which is moved to `min`.
+    static NodePtr remove_min(const NodePtr& n, const Node*& min) {
+        if (!n->left) {
+            min = n.get();
+            return n->right;
+        }
+        return balance(n->kv, remove_min(n->left, min), n->right);
+    }
+
+    NodePtr remove(const NodePtr& n, const K& k, bool& found) const {
+        if (!n) return n;
+        if (less_(k, n->kv.first)) {
+            NodePtr l = remove(n->left, k, found);
+            return found ? balance(n->kv, std::move(l), n->right) : n;
+        }
+        if (less_(n->kv.first, k)) {
+            NodePtr r = remove(n->right, k, found);
+            return found ? balance(n->kv, n->left, std::move(r)) : n;
+        }
+        found = true;
+        if (!n->left) return n->right;
+        if (!n->right) return n->left;
+        const Node* min = nullptr;
+        NodePtr r = remove_min(n->right, min);
+        return balance(min->kv, n->left, std::move(r));
+    }
+
+    static NodePtr build(std::vector<value_type>& e, size_t lo, size_t hi) {
+        if (lo >= hi) return nullptr;
+        size_t mid = lo + (hi - lo) / 2;
+        NodePtr l = build(e, lo, mid);
+        NodePtr r = build(e, mid + 1, hi);
+        return make(std::move(e[mid]), std::move(l), std::move(r));
+    }
+
+    NodePtr root_;
+    [[no_unique_address]] Compare less_;
+};
+
+// Keeping a PersistentMap in step with a live ordered map. `share(old, live)`
+// converts a live value, returning `*old` when it is still current so that
+// unchanged entries (and the subtrees above them) stay shared.
+
+// Every live entry, in one merge pass against the old map.
+template<class Map, class Live, class Share>
+Map persistent_rebuild(const Map& old, const Live& live, Share share) {
+    std::vector<typename Map::value_type> entries;
+    entries.reserve(live.size());
+    auto it = old.begin();
+    for (const auto& [key, value] : live) {
+        // Both sides are in key order, so `it` only moves forward
+        while (it != old.end() && it->first < key) ++it;
+        const typename Map::mapped_type* prev = it != old.end() && it->first == key ? &it->second : nullptr;
+        entries.emplace_back(key, share(prev, value));
+    }
+    return Map::from_sorted(std::move(entries));
+}
+
+// One key: follows the live entry, or goes when the live map has none.
+template<class Map, class Live, class Share>
+void persistent_refresh(Map& m, const Live& live, const typename Map::key_type& key, Share share) {
+    auto it = live.find(key);
+    if (it == live.end()) {
+        m.erase(key);
+        return;
+    }
+    auto* old = m.get(key);
+    auto value = share(old, it->second);
+    if (!old || !(value == *old)) m.set(key, std::move(value));
+}
+
+#endif // PERSISTENT_MAP_H
@@ -0,0 +1,27 @@
+#ifndef PRUNE_RULES_H
+#define PRUNE_RULES_H
+
+#include "struct.h"
+
+// Thresholds below which decayed model state is dropped.
+//
+// The runtime decay passes (comprehensive_system_decay() and
+// prune_unstable_tokens()) and the offline compactor (nexus-compact) both
+// prune through these, so a compaction removes exactly what a decay pass
+// would have removed, without decaying anything first.
+class PruneRules {
+public:
+    static constexpr double LINK_MIN_WEIGHT = 0.01;         // TokenConceptEmbedding::linked_concepts
+    static constexpr double RELATION_MIN_STRENGTH = 0.1;    // WorldModel::relationships
+    static constexpr int NGRAM_MIN_COUNT = 2;               // bigram and trigram counts
+
+    static bool weak_link(double weight) { return weight < LINK_MIN_WEIGHT; }
+    static bool weak_relation(double strength) { return strength < RELATION_MIN_STRENGTH; }
+    static bool weak_ngram(int count) { return count < NGRAM_MIN_COUNT; }
+    static bool weak_concept(const Concept& c) { return c.value < 0.2 && c.semantic_density < 0.3; }
+    // Low priority and (almost) done
+    static bool spent_goal(const Goal& g) { return g.priority < 0.1 && g.progress > 0.95; }
+    static bool unstable_token(const TokenConceptEmbedding& t) { return t.semantic_stability < 0.3 && t.freq < 3; }
+};
+
+#endif
@@ -0,0 +1,199 @@
+#pragma once
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <vector>
+#include <span>
+#include <utility>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+
+// Bounded FIFO history with O(1) push. Once full, push_back overwrites the
+// oldest element, so memory never grows past capacity(). Logical index 0 is
+// the oldest element and size()-1 the newest, matching the vector+erase(begin)
+// idiom this replaces.
+//
+// Storage is a single vector; segments() exposes it as at most two contiguous
+// spans in logical order for vectorizable reductions, and linearize() rotates
+// it in place when one span is required.
+//
+// N > 0 fixes the capacity at compile time; N == 0 takes it at construction.
+template<typename T, size_t N = 0>
+class RingBuffer {
+public:
+    template<bool Const>
+    class Iter {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+        using Owner = std::conditional_t<Const, const RingBuffer, RingBuffer>;
+
+        Iter() = default;
+        Iter(Owner* rb, size_t i) : rb_(rb), i_(i) {}
+        operator Iter<true>() const { return Iter<true>(rb_, i_); }
+
+        reference operator*() const { return (*rb_)[i_]; }
+        pointer operator->() const { return &(*rb_)[i_]; }
+        reference operator[](difference_type n) const { return (*rb_)[i_ + n]; }
+        Iter& operator++() { ++i_; return *this; }
+        Iter operator++(int) { Iter t = *this; ++i_; return t; }
+        Iter& operator--() { --i_; return *this; }
+        Iter operator--(int) { Iter t = *this; --i_; return t; }
+        Iter& operator+=(difference_type n) { i_ += n; return *this; }
+        Iter& operator-=(difference_type n) { i_ -= n; return *this; }
+        Iter operator+(difference_type n) const { return Iter(rb_, i_ + n); }
+        Iter operator-(difference_type n) const { return Iter(rb_, i_ - n); }
+        friend Iter operator+(difference_type n, const Iter& it) { return it + n; }
+        difference_type operator-(const Iter& o) const { return (difference_type)i_ - (difference_type)o.i_; }
+        bool operator==(const Iter& o) const { return i_ == o.i_; }
+        auto operator<=>(const Iter& o) const { return i_ <=> o.i_; }
+
+    private:
+        Owner* rb_ = nullptr;
+        size_t i_ = 0;
+    };
+
+    using value_type = T;
+    using iterator = Iter<false>;
+    using const_iterator = Iter<true>;
+
+    RingBuffer() requires (N > 0) : cap_(N) {}
+    explicit RingBuffer(size_t capacity) requires (N == 0) : cap_(std::max<size_t>(1, capacity)) {}
+
+    size_t size() const { return buf_.size(); }
+    size_t capacity() const { return cap_; }
+    bool empty() const { return buf_.empty(); }
+    bool full() const { return buf_.size() == cap_; }
+
+    void push_back(const T& v) { emplace_back(v); }
+    void push_back(T&& v) { emplace_back(std::move(v)); }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (buf_.size() < cap_) {
+            if (buf_.capacity() == buf_.size()) buf_.reserve(std::min(cap_, std::max<size_t>(8, buf_.size() * 2)));
+            return buf_.emplace_back(std::forward<Args>(args)...);
+        }
+        T& slot = buf_[head_];
+        slot = T(std::forward<Args>(args)...);
+        head_ = (head_ + 1) % cap_;
+        return slot;
+    }
+
+    T& operator[](size_t i) { return buf_[phys(i)]; }
+    const T& operator[](size_t i) const { return buf_[phys(i)]; }
+    T& front() { return buf_[head_]; }
+    const T& front() const { return buf_[head_]; }
+    T& back() { return buf_[phys(buf_.size() - 1)]; }
+    const T& back() const { return buf_[phys(buf_.size() - 1)]; }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, buf_.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, buf_.size()); }
+
+    void clear() { buf_.clear(); head_ = 0; }
+
+    // Oldest-first contiguous runs; the second is empty until the buffer wraps.
+    std::pair<std::span<const T>, std::span<const T>> segments() const {
+        std::span<const T> all(buf_);
+        return {all.subspan(head_), all.first(head_)};
+    }
+    std::pair<std::span<T>, std::span<T>> segments() {
+        std::span<T> all(buf_);
+        return {all.subspan(head_), all.first(head_)};
+    }
+
+    // Rotates storage so the whole history is one oldest-first span. O(n), so
+    // reserve it for bulk consumers rather than per-push paths.
+    std::span<T> linearize() {
+        if (head_ != 0) {
+            std::rotate(buf_.begin(), buf_.begin() + head_, buf_.end());
+            head_ = 0;
+        }
+        return std::span<T>(buf_);
+    }
+
+    // Shrinking keeps the newest elements.
+    void set_capacity(size_t capacity) requires (N == 0) {
+        capacity = std::max<size_t>(1, capacity);
+        if (capacity == cap_) return;
+        linearize();
+        if (buf_.size() > capacity) buf_.erase(buf_.begin(), buf_.begin() + (buf_.size() - capacity));
+        cap_ = capacity;
+    }
+
+    template<typename Pred>
+    size_t remove_if(Pred pred) {
+        linearize();
+        auto it = std::remove_if(buf_.begin(), buf_.end(), pred);
+        size_t removed = buf_.end() - it;
+        buf_.erase(it, buf_.end());
+        return removed;
+    }
+
+    // Drops the oldest `count` elements.
+    void drop_front(size_t count) {
+        linearize();
+        buf_.erase(buf_.begin(), buf_.begin() + std::min(count, buf_.size()));
+    }
+
+    std::vector<T> to_vector() const {
+        std::vector<T> out;
+        out.reserve(buf_.size());
+        auto [a, b] = segments();
+        out.insert(out.end(), a.begin(), a.end());
+        out.insert(out.end(), b.begin(), b.end());
+        return out;
+    }
+
+    // Serialization hooks for sv/ld: oldest-first values joined by `sep`,
+    // and the inverse which pushes each parsed field through push_back.
+    void write_delimited(std::ostream& o, char sep) const {
+        for (size_t i = 0; i < buf_.size(); i++) {
+            if (i) o << sep;
+            o << (*this)[i];
+        }
+    }
+
+    template<typename Parse>
+    void read_delimited(std::string_view line, char sep, Parse parse) {
+        while (!line.empty()) {
+            size_t cut = line.find(sep);
+            std::string_view field = line.substr(0, cut);
+            if (!field.empty()) push_back(parse(field));
+            if (cut == std::string_view::npos) break;
+            line.remove_prefix(cut + 1);
+        }
+    }
+
+private:
+    size_t phys(size_t i) const {
+        size_t p = head_ + i;
+        return p >= buf_.size() ? p - buf_.size() : p;
+    }
+
+    std::vector<T> buf_;
+    size_t head_ = 0;
+    size_t cap_;
+};
+
+// Sum over a ring using its contiguous segments; the inner loops are plain
+// array walks the compiler can vectorize.
+template<typename T, size_t N>
+inline double ring_sum(const RingBuffer<T, N>& rb) {
+    auto [a, b] = rb.segments();
+    double s = 0.0;
+    for (const T& v : a) s += v;
+    for (const T& v : b) s += v;
+    return s;
+}
+
+#endif // RING_BUFFER_H
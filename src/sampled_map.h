@@ -0,0 +1,294 @@
+#pragma once
+#ifndef SAMPLED_MAP_H
+#define SAMPLED_MAP_H
+
+#include <map>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+// Fenwick (binary indexed) tree over non-negative weights. Supports append,
+// point set, prefix sums and inverse-CDF lookup in O(log n), which is what a
+// weighted sampler over a growing store needs.
+class FenwickSampler {
+public:
+    size_t size() const { return w_.size(); }
+    double total() const { return prefix(w_.size()); }
+    double weight(size_t i) const { return w_[i]; }
+
+    void clear() { w_.clear(); tree_.assign(1, 0.0); }
+
+    void push_back(double w) {
+        if (w < 0) w = 0;
+        w_.push_back(w);
+        size_t i = w_.size();
+        // Node i covers (i - lowbit(i), i]: its own weight plus the nodes
+        // already below it.
+        tree_.push_back(w + prefix(i - 1) - prefix(i - (i & (~i + 1))));
+    }
+    void pop_back() {
+        w_.pop_back();
+        tree_.pop_back();
+    }
+    void set(size_t i, double w) {
+        if (w < 0) w = 0;
+        double delta = w - w_[i];
+        if (delta == 0) return;
+        w_[i] = w;
+        for (size_t k = i + 1; k < tree_.size(); k += k & (~k + 1)) tree_[k] += delta;
+    }
+    // Sum of weights [0, n).
+    double prefix(size_t n) const {
+        double s = 0;
+        for (size_t k = n; k > 0; k -= k & (~k + 1)) s += tree_[k];
+        return s;
+    }
+    // Index i with prefix(i) <= target < prefix(i + 1); size() when empty or
+    // the total weight is zero.
+    size_t find(double target) const {
+        if (w_.empty() || total() <= 0) return w_.size();
+        size_t pos = 0, step = 1;
+        while (step * 2 < tree_.size()) step *= 2;
+        for (; step > 0; step /= 2) {
+            if (pos + step < tree_.size() && tree_[pos + step] <= target) {
+                pos += step;
+                target -= tree_[pos];
+            }
+        }
+        // Rounding can walk past the last positive weight; step back to it.
+        if (pos >= w_.size()) pos = w_.size() - 1;
+        while (pos > 0 && w_[pos] <= 0) --pos;
+        return pos;
+    }
+
+private:
+    std::vector<double> w_;
+    std::vector<double> tree_ = std::vector<double>(1, 0.0);  // 1-based
+};
+
+// Ordered map with O(1) uniform and O(log n) weighted random access.
+//
+// Wraps a std::map and keeps a dense vector of its iterators in sync: inserts
+// append, erases swap the last entry into the hole. Reads and iteration go
+// straight to the map, so call sites keep their std::map code. Every insert
+// and erase must go through this class, which is why the mutating members are
+// re-implemented instead of exposing the underlying map.
+//
+// Weighted sampling is opt-in via set_weight(). New entries are weighed on
+// insert, so insert them with their final value (try_emplace) rather than
+// through operator[]. Values are mutated in place, so code that changes a
+// weighed field calls touch() afterwards; every sample_weighted() call also
+// re-weighs a small rolling window, which catches writes that don't.
+//
+// on_change() reports which entries changed: inserts, erases and touch()
+// pass the key, wholesale changes (clear, assignment, swap_entries) pass
+// nullptr. Copies do not inherit the hook.
+template<typename K, typename V, typename Compare = std::less<K>>
+class SampledMap {
+public:
+    using map_type = std::map<K, V, Compare>;
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = typename map_type::value_type;
+    using size_type = typename map_type::size_type;
+    using iterator = typename map_type::iterator;
+    using const_iterator = typename map_type::const_iterator;
+    using WeightFn = std::function<double(const V&)>;
+    using ChangeFn = std::function<void(const K*)>;
+
+    SampledMap() = default;
+    SampledMap(const SampledMap& o) : map_(o.map_), weight_(o.weight_) { reindex(); }
+    SampledMap(SampledMap&& o) noexcept : map_(std::move(o.map_)), weight_(std::move(o.weight_)) {
+        reindex();
+        o.reindex();
+        o.changed(nullptr);
+    }
+    SampledMap& operator=(const SampledMap& o) {
+        if (this != &o) { map_ = o.map_; weight_ = o.weight_; reindex(); changed(nullptr); }
+        return *this;
+    }
+    SampledMap& operator=(SampledMap&& o) noexcept {
+        if (this != &o) {
+            map_ = std::move(o.map_); weight_ = std::move(o.weight_); reindex(); o.reindex();
+            changed(nullptr);
+            o.changed(nullptr);
+        }
+        return *this;
+    }
+
+    // ---- std::map surface ----
+    iterator begin() { return map_.begin(); }
+    iterator end() { return map_.end(); }
+    const_iterator begin() const { return map_.begin(); }
+    const_iterator end() const { return map_.end(); }
+    const_iterator cbegin() const { return map_.cbegin(); }
+    const_iterator cend() const { return map_.cend(); }
+    auto rbegin() { return map_.rbegin(); }
+    auto rend() { return map_.rend(); }
+    auto rbegin() const { return map_.rbegin(); }
+    auto rend() const { return map_.rend(); }
+
+    size_type size() const { return map_.size(); }
+    bool empty() const { return map_.empty(); }
+    size_type count(const K& k) const { return map_.count(k); }
+    bool contains(const K& k) const { return map_.find(k) != map_.end(); }
+    iterator find(const K& k) { return map_.find(k); }
+    const_iterator find(const K& k) const { return map_.find(k); }
+    iterator lower_bound(const K& k) { return map_.lower_bound(k); }
+    const_iterator lower_bound(const K& k) const { return map_.lower_bound(k); }
+    iterator upper_bound(const K& k) { return map_.upper_bound(k); }
+    const_iterator upper_bound(const K& k) const { return map_.upper_bound(k); }
+    V& at(const K& k) { return map_.at(k); }
+    const V& at(const K& k) const { return map_.at(k); }
+
+    V& operator[](const K& k) { return try_emplace(k).first->second; }
+    V& operator[](K&& k) { return try_emplace(std::move(k)).first->second; }
+
+    template<typename KK, typename... Args>
+    std::pair<iterator, bool> try_emplace(KK&& k, Args&&... args) {
+        auto r = map_.try_emplace(std::forward<KK>(k), std::forward<Args>(args)...);
+        if (r.second) track(r.first);
+        return r;
+    }
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        auto r = map_.emplace(std::forward<Args>(args)...);
+        if (r.second) track(r.first);
+        return r;
+    }
+    std::pair<iterator, bool> insert(const value_type& v) { return emplace(v); }
+    // Hinted upsert; O(1) amortized when keys arrive in order with hint end().
+    template<typename KK, typename VV>
+    iterator insert_or_assign(const_iterator hint, KK&& k, VV&& v) {
+        size_type before = map_.size();
+        iterator it = map_.insert_or_assign(hint, std::forward<KK>(k), std::forward<VV>(v));
+        if (map_.size() != before) track(it);
+        else touch(it);
+        return it;
+    }
+    void reserve(size_type n) { dense_.reserve(n); pos_.reserve(n); }
+
+    iterator erase(iterator it) {
+        changed(&it->first);
+        untrack(it);
+        return map_.erase(it);
+    }
+    iterator erase(const_iterator it) { return erase(map_.erase(it, it)); }
+    size_type erase(const K& k) {
+        auto it = map_.find(k);
+        if (it == map_.end()) return 0;
+        erase(it);
+        return 1;
+    }
+    void clear() {
+        map_.clear();
+        reindex();
+        changed(nullptr);
+    }
+
+    // ---- sampling ----
+
+    // i-th entry in dense order, i in [0, size()). With a uniform i this is
+    // an O(1) uniform pick.
+    iterator at_index(size_t i) { return dense_[i]; }
+    const_iterator at_index(size_t i) const { return dense_[i]; }
+
+    // Enables frequency-weighted sampling; weighs every current entry once.
+    void set_weight(WeightFn fn) {
+        weight_ = std::move(fn);
+        rebuild_weights();
+    }
+    // Exchanges entries with `o`; each side keeps its own weight function.
+    void swap_entries(SampledMap& o) {
+        map_.swap(o.map_);
+        dense_.swap(o.dense_);
+        pos_.swap(o.pos_);
+        rebuild_weights();
+        o.rebuild_weights();
+        changed(nullptr);
+        o.changed(nullptr);
+    }
+    // Reports one entry's value as changed and re-weighs it.
+    void touch(iterator it) {
+        changed(&it->first);
+        if (!weight_) return;
+        auto p = pos_.find(&it->first);
+        if (p != pos_.end()) fenwick_.set(p->second, weight_(it->second));
+    }
+    void on_change(ChangeFn fn) { on_change_ = std::move(fn); }
+    // Weighted pick for u in [0, 1); end() when no entry has weight.
+    iterator sample_weighted(double u) {
+        if (!weight_ || dense_.empty()) return map_.end();
+        refresh_window();
+        size_t i = fenwick_.find(u * fenwick_.total());
+        return i < dense_.size() ? dense_[i] : map_.end();
+    }
+
+    // Entries re-weighed per sample_weighted() call.
+    static constexpr size_t refresh_window_size = 16;
+
+private:
+    void changed(const K* k) {
+        if (on_change_) on_change_(k);
+    }
+    void track(iterator it) {
+        changed(&it->first);
+        pos_[&it->first] = (uint32_t)dense_.size();
+        dense_.push_back(it);
+        if (weight_) fenwick_.push_back(weight_(it->second));
+    }
+    void untrack(iterator it) {
+        auto p = pos_.find(&it->first);
+        if (p == pos_.end()) return;
+        uint32_t hole = p->second;
+        pos_.erase(p);
+        iterator moved = dense_.back();
+        dense_.pop_back();
+        if (weight_) {
+            double w = fenwick_.weight(fenwick_.size() - 1);
+            fenwick_.pop_back();
+            if (hole < dense_.size()) fenwick_.set(hole, w);
+        }
+        if (hole < dense_.size()) {
+            dense_[hole] = moved;
+            pos_[&moved->first] = hole;
+        }
+        if (refresh_cursor_ >= dense_.size()) refresh_cursor_ = 0;
+    }
+    void reindex() {
+        dense_.clear();
+        pos_.clear();
+        dense_.reserve(map_.size());
+        for (auto it = map_.begin(); it != map_.end(); ++it) {
+            pos_[&it->first] = (uint32_t)dense_.size();
+            dense_.push_back(it);
+        }
+        rebuild_weights();
+    }
+    void rebuild_weights() {
+        fenwick_.clear();
+        refresh_cursor_ = 0;
+        if (!weight_) return;
+        for (iterator it : dense_) fenwick_.push_back(weight_(it->second));
+    }
+    void refresh_window() {
+        for (size_t i = 0; i < refresh_window_size && i < dense_.size(); ++i) {
+            if (refresh_cursor_ >= dense_.size()) refresh_cursor_ = 0;
+            fenwick_.set(refresh_cursor_, weight_(dense_[refresh_cursor_]->second));
+            ++refresh_cursor_;
+        }
+    }
+
+    map_type map_;
+    std::vector<iterator> dense_;
+    std::unordered_map<const K*, uint32_t> pos_;
+    WeightFn weight_;
+    ChangeFn on_change_;
+    FenwickSampler fenwick_;
+    size_t refresh_cursor_ = 0;
+};
+
+#endif // SAMPLED_MAP_H
@@ -0,0 +1,138 @@
+#pragma once
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+
+// Generation-checked reference into a Slab. A handle stays valid until its
+// slot is erased; after that get() returns nullptr even if the slot has been
+// reused, so dangling references are detected with one compare instead of a
+// keyed lookup.
+struct SlabHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+    bool is_null() const { return index == UINT32_MAX; }
+    bool operator==(const SlabHandle& o) const { return index == o.index && generation == o.generation; }
+    bool operator!=(const SlabHandle& o) const { return !(*this == o); }
+};
+
+// Contiguous object pool with a free list.
+//
+// Values live in one vector of slots; erased slots go on a free list and are
+// reused by the next insert with a bumped generation. A dense array of live
+// slot indices gives O(1) size(), O(1) uniform sampling via handle_at(), and
+// cache-friendly iteration. Erase swaps the last dense entry into the hole, so
+// iteration order is insertion order until the first erase.
+//
+// Pointers returned by get() are invalidated by insert() (the slot vector may
+// grow); handles are not.
+template<typename T>
+class Slab {
+public:
+    SlabHandle insert(T value) {
+        uint32_t idx;
+        if (!free_.empty()) {
+            idx = free_.back();
+            free_.pop_back();
+            slots_[idx].value = std::move(value);
+        } else {
+            idx = (uint32_t)slots_.size();
+            slots_.push_back(Slot{std::move(value), 0, 0, false});
+        }
+        Slot& s = slots_[idx];
+        s.live = true;
+        s.dense_pos = (uint32_t)dense_.size();
+        dense_.push_back(idx);
+        return SlabHandle{idx, s.generation};
+    }
+
+    bool erase(SlabHandle h) {
+        if (!contains(h)) return false;
+        Slot& s = slots_[h.index];
+        uint32_t pos = s.dense_pos;
+        uint32_t moved = dense_.back();
+        dense_[pos] = moved;
+        slots_[moved].dense_pos = pos;
+        dense_.pop_back();
+        s.live = false;
+        s.generation++;
+        s.value = T();
+        free_.push_back(h.index);
+        return true;
+    }
+
+    bool contains(SlabHandle h) const {
+        return h.index < slots_.size() && slots_[h.index].live && slots_[h.index].generation == h.generation;
+    }
+    T* get(SlabHandle h) { return contains(h) ? &slots_[h.index].value : nullptr; }
+    const T* get(SlabHandle h) const { return contains(h) ? &slots_[h.index].value : nullptr; }
+
+    size_t size() const { return dense_.size(); }
+    bool empty() const { return dense_.empty(); }
+
+    // Position of a live handle in dense order, or SIZE_MAX when dangling.
+    size_t dense_index(SlabHandle h) const {
+        return contains(h) ? slots_[h.index].dense_pos : SIZE_MAX;
+    }
+
+    // Dense-order access: i in [0, size()). Pair with a uniform index for O(1)
+    // random sampling.
+    SlabHandle handle_at(size_t i) const {
+        uint32_t idx = dense_[i];
+        return SlabHandle{idx, slots_[idx].generation};
+    }
+    T& operator[](size_t i) { return slots_[dense_[i]].value; }
+    const T& operator[](size_t i) const { return slots_[dense_[i]].value; }
+
+    void clear() {
+        slots_.clear();
+        free_.clear();
+        dense_.clear();
+    }
+    void reserve(size_t n) {
+        slots_.reserve(n);
+        dense_.reserve(n);
+    }
+
+    template<bool Const>
+    class Iter {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using Owner = std::conditional_t<Const, const Slab, Slab>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        Iter(Owner* s, size_t i) : s_(s), i_(i) {}
+        reference operator*() const { return (*s_)[i_]; }
+        pointer operator->() const { return &(*s_)[i_]; }
+        Iter& operator++() { ++i_; return *this; }
+        Iter operator++(int) { Iter t = *this; ++i_; return t; }
+        bool operator==(const Iter& o) const { return i_ == o.i_; }
+        bool operator!=(const Iter& o) const { return i_ != o.i_; }
+    private:
+        Owner* s_;
+        size_t i_;
+    };
+    Iter<false> begin() { return Iter<false>(this, 0); }
+    Iter<false> end() { return Iter<false>(this, dense_.size()); }
+    Iter<true> begin() const { return Iter<true>(this, 0); }
+    Iter<true> end() const { return Iter<true>(this, dense_.size()); }
+
+private:
+    struct Slot {
+        T value;
+        uint32_t generation;
+        uint32_t dense_pos;
+        bool live;
+    };
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_;
+    std::vector<uint32_t> dense_;
+};
+
+#endif // SLAB_H
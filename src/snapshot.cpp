@@ -0,0 +1,341 @@
+#include "snapshot.h"
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::endian::native == std::endian::little,
+              "snapshot records are stored little-endian and read in place");
+
+const char* snapshot_section_name(SnapshotSection id) {
+    switch (id) {
+        case SnapshotSection::Strings: return "strings";
+        case SnapshotSection::StringData: return "string_data";
+        case SnapshotSection::Meta: return "meta";
+        case SnapshotSection::StateD: return "state_d";
+        case SnapshotSection::Qualia: return "qualia";
+        case SnapshotSection::PsiHistory: return "psi_history";
+        case SnapshotSection::Neurons: return "neurons";
+        case SnapshotSection::NeuronLinks: return "neuron_links";
+        case SnapshotSection::Tokens: return "tokens";
+        case SnapshotSection::Concepts: return "concepts";
+        case SnapshotSection::ConceptWords: return "concept_words";
+        case SnapshotSection::Embeddings: return "embeddings";
+        case SnapshotSection::EmbeddingValues: return "embedding_values";
+        case SnapshotSection::EmbeddingLinks: return "embedding_links";
+        case SnapshotSection::ValenceContext: return "valence_context";
+        case SnapshotSection::Bigrams: return "bigrams";
+        case SnapshotSection::Trigrams: return "trigrams";
+        case SnapshotSection::Goals: return "goals";
+        case SnapshotSection::GoalSubgoals: return "goal_subgoals";
+        case SnapshotSection::GoalPreconditions: return "goal_preconditions";
+        case SnapshotSection::WorldEntities: return "world_entities";
+        case SnapshotSection::WorldRelations: return "world_relations";
+        case SnapshotSection::Memories: return "memories";
+        case SnapshotSection::ValenceHistory: return "valence_history";
+        case SnapshotSection::Thoughts: return "thoughts";
+        case SnapshotSection::Heads: return "heads";
+        case SnapshotSection::Tombstones: return "tombstones";
+    }
+    return "unknown";
+}
+
+// Word-at-a-time multiply/rotate hash with a murmur-style finaliser. Not
+// cryptographic; it only has to catch torn writes and bit rot.
+uint64_t snapshot_checksum(const void* data, size_t size, uint64_t seed) {
+    constexpr uint64_t P1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t P2 = 0xC2B2AE3D27D4EB4Full;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t h = seed ^ (size * P1);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, 8);
+        h ^= w * P2;
+        h = std::rotl(h, 31) * P1;
+    }
+    if (i < size) {
+        uint64_t w = 0;
+        std::memcpy(&w, p + i, size - i);
+        h ^= w * P2;
+        h = std::rotl(h, 31) * P1;
+    }
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+bool snapshot_sync(std::FILE* f) {
+    if (std::fflush(f) != 0) return false;
+#if defined(__linux__)
+    return fsync(fileno(f)) == 0;
+#else
+    return true;
+#endif
+}
+
+// Makes a rename inside `path`'s directory durable.
+static void sync_parent_dir(const std::string& path) {
+#if defined(__linux__)
+    std::string dir = std::filesystem::path(path).parent_path().string();
+    int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd >= 0) {
+        fsync(fd);
+        ::close(fd);
+    }
+#else
+    (void)path;
+#endif
+}
+
+// ===== STRING TABLE =====
+
+uint32_t StringTableBuilder::intern(std::string_view s) {
+    auto it = ids_.find(std::string(s));
+    if (it != ids_.end()) return it->second;
+    uint32_t id = (uint32_t)(offsets_.size() - 1);
+    data_.append(s);
+    offsets_.push_back(data_.size());
+    ids_.emplace(std::string(s), id);
+    return id;
+}
+
+// ===== WRITER =====
+
+SnapshotWriter::SnapshotWriter() : path_("<memory>") {
+    SnapshotHeader placeholder{};
+    write(&placeholder, sizeof(placeholder));
+}
+
+SnapshotWriter::SnapshotWriter(const std::string& path) : path_(path), tmp_path_(path + ".tmp") {
+    file_ = std::fopen(tmp_path_.c_str(), "wb");
+    if (!file_) throw SnapshotError("cannot open " + tmp_path_ + " for writing");
+    SnapshotHeader placeholder{};
+    write(&placeholder, sizeof(placeholder));
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    if (file_) {
+        // Abandoned before finish(): never leave a partial temp file behind
+        std::fclose(file_);
+        std::remove(tmp_path_.c_str());
+    }
+}
+
+void SnapshotWriter::write(const void* data, size_t size) {
+    if (size == 0) return;
+    if (file_) {
+        if (std::fwrite(data, 1, size, file_) != size) throw SnapshotError("short write to " + path_);
+    } else {
+        buffer_.append(static_cast<const char*>(data), size);
+    }
+    pos_ += size;
+}
+
+void SnapshotWriter::set_identity(uint64_t snapshot_id, uint64_t base_id, uint64_t sequence) {
+    identity_.snapshot_id = snapshot_id;
+    identity_.base_id = base_id;
+    identity_.sequence = sequence;
+}
+
+void SnapshotWriter::pad_to(size_t align) {
+    static const unsigned char zeros[SNAPSHOT_ALIGN] = {};
+    size_t rem = (size_t)(pos_ % align);
+    if (rem) write(zeros, align - rem);
+}
+
+void SnapshotWriter::add(SnapshotSection id, const void* data, size_t record_size, size_t count) {
+    pad_to(SNAPSHOT_ALIGN);
+    SectionEntry e{};
+    e.id = (uint32_t)id;
+    e.record_size = (uint32_t)record_size;
+    e.offset = pos_;
+    e.size = record_size * count;
+    e.count = count;
+    e.checksum = snapshot_checksum(data, e.size);
+    write(data, e.size);
+    table_.push_back(e);
+}
+
+void SnapshotWriter::add_strings(const StringTableBuilder& strings) {
+    add(SnapshotSection::Strings, strings.offsets());
+    add(SnapshotSection::StringData, strings.data().data(), 1, strings.data().size());
+}
+
+uint64_t SnapshotWriter::finish() {
+    if (finished_) return pos_;
+    pad_to(8);
+    SnapshotHeader h = identity_;
+    std::memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+    h.version = SNAPSHOT_VERSION;
+    h.section_count = (uint32_t)table_.size();
+    h.table_offset = pos_;
+    h.table_checksum = snapshot_checksum(table_.data(), table_.size() * sizeof(SectionEntry));
+    write(table_.data(), table_.size() * sizeof(SectionEntry));
+    h.file_size = pos_;
+
+    if (!file_) {
+        std::memcpy(buffer_.data(), &h, sizeof(h));
+        finished_ = true;
+        return pos_;
+    }
+    if (std::fseek(file_, 0, SEEK_SET) != 0 || std::fwrite(&h, 1, sizeof(h), file_) != sizeof(h)) {
+        throw SnapshotError("cannot write header of " + path_);
+    }
+    bool synced = snapshot_sync(file_);
+    if (std::fclose(file_) != 0 || !synced) {
+        file_ = nullptr;
+        std::remove(tmp_path_.c_str());
+        throw SnapshotError("cannot flush " + tmp_path_);
+    }
+    file_ = nullptr;
+    std::error_code ec;
+    std::filesystem::rename(tmp_path_, path_, ec);
+    if (ec) {
+        std::remove(tmp_path_.c_str());
+        throw SnapshotError("cannot rename " + tmp_path_ + " to " + path_ + ": " + ec.message());
+    }
+    sync_parent_dir(path_);
+    finished_ = true;
+    return pos_;
+}
+
+// ===== READER =====
+
+SnapshotReader::~SnapshotReader() { close(); }
+
+bool SnapshotReader::is_snapshot(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(SNAPSHOT_MAGIC)] = {};
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+}
+
+void SnapshotReader::close() {
+#if defined(__linux__)
+    if (mapped_ && data_) munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    buffer_.clear();
+    table_.clear();
+    verified_.clear();
+    string_offsets_ = RecordArray<uint64_t>();
+    string_data_ = {};
+    strings_loaded_ = false;
+}
+
+void SnapshotReader::open(const std::string& path) {
+    close();
+#if defined(__linux__)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw SnapshotError("cannot open " + path);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw SnapshotError("cannot stat " + path);
+    }
+    size_ = (size_t)st.st_size;
+    if (size_ > 0) {
+        void* m = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m != MAP_FAILED) {
+            data_ = static_cast<const unsigned char*>(m);
+            mapped_ = true;
+        }
+    }
+    ::close(fd);
+#endif
+    if (!mapped_) {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) throw SnapshotError("cannot open " + path);
+        size_ = (size_t)in.tellg();
+        in.seekg(0);
+        buffer_.resize(size_);
+        if (!in.read(reinterpret_cast<char*>(buffer_.data()), (std::streamsize)size_)) {
+            throw SnapshotError("cannot read " + path);
+        }
+        data_ = buffer_.data();
+    }
+    validate(path);
+}
+
+void SnapshotReader::attach(const unsigned char* data, size_t size, const std::string& name) {
+    close();
+    data_ = data;
+    size_ = size;
+    validate(name);
+}
+
+void SnapshotReader::validate(const std::string& path) {
+    if (size_ < sizeof(SnapshotHeader)) throw SnapshotError(path + ": truncated header");
+    std::memcpy(&header_, data_, sizeof(header_));
+    if (std::memcmp(header_.magic, SNAPSHOT_MAGIC, sizeof(header_.magic)) != 0) {
+        throw SnapshotError(path + ": not a snapshot");
+    }
+    if (header_.version == 0 || header_.version > SNAPSHOT_VERSION) {
+        throw SnapshotError(path + ": unsupported snapshot version " + std::to_string(header_.version));
+    }
+    if (header_.file_size != size_) throw SnapshotError(path + ": size mismatch (truncated write?)");
+    uint64_t table_bytes = (uint64_t)header_.section_count * sizeof(SectionEntry);
+    if (header_.table_offset + table_bytes > size_) throw SnapshotError(path + ": section table out of range");
+    if (snapshot_checksum(data_ + header_.table_offset, table_bytes) != header_.table_checksum) {
+        throw SnapshotError(path + ": section table checksum mismatch");
+    }
+    table_.resize(header_.section_count);
+    std::memcpy(table_.data(), data_ + header_.table_offset, table_bytes);
+    for (const SectionEntry& e : table_) {
+        if (e.offset + e.size > header_.table_offset || e.size != (uint64_t)e.record_size * e.count) {
+            throw SnapshotError(path + ": section " + snapshot_section_name((SnapshotSection)e.id) + " out of range");
+        }
+    }
+    verified_.assign(table_.size(), false);
+}
+
+const SectionEntry* SnapshotReader::find(SnapshotSection id) const {
+    for (const SectionEntry& e : table_) {
+        if (e.id == (uint32_t)id) return &e;
+    }
+    return nullptr;
+}
+
+std::string_view SnapshotReader::bytes(SnapshotSection id) {
+    const SectionEntry* e = find(id);
+    if (!e) return {};
+    size_t idx = (size_t)(e - table_.data());
+    if (!verified_[idx]) {
+        if (snapshot_checksum(data_ + e->offset, e->size) != e->checksum) {
+            throw SnapshotError(std::string("section ") + snapshot_section_name(id) + " checksum mismatch");
+        }
+        verified_[idx] = true;
+    }
+    return std::string_view(reinterpret_cast<const char*>(data_ + e->offset), e->size);
+}
+
+void SnapshotReader::verify_all() {
+    for (const SectionEntry& e : table_) bytes((SnapshotSection)e.id);
+}
+
+size_t SnapshotReader::string_count() {
+    if (!strings_loaded_) {
+        string_offsets_ = records<uint64_t>(SnapshotSection::Strings);
+        string_data_ = bytes(SnapshotSection::StringData);
+        strings_loaded_ = true;
+    }
+    return string_offsets_.empty() ? 0 : string_offsets_.size() - 1;
+}
+
+std::string_view SnapshotReader::str(uint32_t id) {
+    if (id >= string_count()) return {};
+    uint64_t b = string_offsets_[id], e = string_offsets_[id + 1];
+    if (b > e || e > string_data_.size()) return {};
+    return string_data_.substr(b, e - b);
+}
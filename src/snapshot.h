@@ -0,0 +1,285 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <type_traits>
+#include <stdexcept>
+
+// Binary model snapshot ("state.dat").
+//
+// Layout, all integers little-endian:
+//
+//   SnapshotHeader                      64 bytes at offset 0
+//   section payloads                    each aligned to SNAPSHOT_ALIGN
+//   SectionEntry[section_count]         at header.table_offset
+//
+// Every section is a packed array of fixed-size records (record_size bytes,
+// `count` of them) with its own checksum. Strings are interned once into a
+// shared string table (Strings + StringData) and referenced by uint32 id, so
+// vocabulary words are stored once no matter how many n-grams use them.
+//
+// Schema evolution: the header carries a format version; readers skip
+// section ids they do not know, and records are read through a stride so a
+// newer writer may append fields to a record without breaking older readers.
+//
+// SnapshotReader maps the file (mmap on Linux, a single read elsewhere) and
+// hands out typed views straight into the mapping; the only per-load cost is
+// the checksum of each section on first access.
+
+constexpr char SNAPSHOT_MAGIC[8] = {'N', 'X', 'S', 'N', 'A', 'P', '\r', '\n'};
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+constexpr size_t SNAPSHOT_ALIGN = 64;
+
+// Section ids are part of the file format: append, never renumber.
+enum class SnapshotSection : uint32_t {
+    Strings = 1,            // uint64 offsets, count + 1 entries
+    StringData = 2,         // raw bytes
+    Meta = 3,               // SnapKV: scalar state by name
+    StateD = 4,             // SnapKV
+    Qualia = 5,             // SnapQualia
+    PsiHistory = 6,         // double
+    Neurons = 7,            // SnapNeuron
+    NeuronLinks = 8,        // int32 neuron ids
+    Tokens = 9,             // SnapToken
+    Concepts = 10,          // SnapConcept
+    ConceptWords = 11,      // uint32 string ids
+    Embeddings = 12,        // SnapEmbedding
+    EmbeddingValues = 13,   // double
+    EmbeddingLinks = 14,    // SnapKV
+    ValenceContext = 15,    // SnapPairValue: token, key
+    Bigrams = 16,           // SnapBigram
+    Trigrams = 17,          // SnapTrigram
+    Goals = 18,             // SnapGoal
+    GoalSubgoals = 19,      // uint32 string ids
+    GoalPreconditions = 20, // SnapKV
+    WorldEntities = 21,     // SnapKV
+    WorldRelations = 22,    // SnapPairValue
+    Memories = 23,          // SnapMemory
+    ValenceHistory = 24,    // double
+    Thoughts = 25,          // uint32 string ids
+    Heads = 26,             // SnapHead
+    Tombstones = 27,        // SnapTombstone (delta frames only)
+};
+
+const char* snapshot_section_name(SnapshotSection id);
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t section_count;
+    uint64_t table_offset;
+    uint64_t file_size;
+    uint64_t table_checksum;
+    uint64_t snapshot_id;   // identity of a full snapshot
+    uint64_t base_id;       // delta frames: snapshot_id of the base they extend
+    uint64_t sequence;      // delta frames: 1, 2, ... after the base
+};
+
+struct SectionEntry {
+    uint32_t id;
+    uint32_t record_size;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t count;
+    uint64_t checksum;
+};
+
+// ---- record layouts ----
+struct SnapKV { uint32_t key; uint32_t pad; double value; };
+struct SnapPairValue { uint32_t a; uint32_t b; double value; };
+struct SnapQualia { double valence, arousal, certainty; int32_t emergence_gen; uint32_t content; };
+struct SnapNeuron { int32_t id; int32_t gen; double weight, bias; uint32_t link_begin, link_count; };
+struct SnapToken { uint32_t word; uint32_t pad; double meaning, freq; };
+struct SnapConcept { uint32_t name, word_begin, word_count, pad; double value; };
+struct SnapEmbedding {
+    uint32_t name, value_begin, value_count, link_begin, link_count, pad;
+    double meaning, freq, grounding, stability, qualia_intensity;
+};
+struct SnapBigram { uint32_t w1, w2; int32_t count; };
+struct SnapTrigram { uint32_t w1, w2, w3; int32_t count; };
+struct SnapGoal {
+    uint32_t name, sub_begin, sub_count, pre_begin, pre_count, pad;
+    double priority, progress, valence_alignment, qualia_binding;
+};
+struct SnapMemory { int32_t gen; uint32_t content; double valence; };
+struct SnapHead { uint32_t name; int32_t dim; double temperature; };
+// Removes the entity (or, for row stores such as bigrams, the whole row)
+// whose key hashes to `key` from the store named by `section`.
+struct SnapTombstone { uint32_t section; uint32_t pad; uint64_t key; };
+
+static_assert(sizeof(SnapshotHeader) == 64);
+static_assert(sizeof(SectionEntry) == 40);
+static_assert(sizeof(SnapKV) == 16 && sizeof(SnapPairValue) == 16);
+static_assert(sizeof(SnapQualia) == 32 && sizeof(SnapNeuron) == 32);
+static_assert(sizeof(SnapToken) == 24 && sizeof(SnapConcept) == 24);
+static_assert(sizeof(SnapEmbedding) == 64 && sizeof(SnapGoal) == 56);
+static_assert(sizeof(SnapBigram) == 12 && sizeof(SnapTrigram) == 16);
+static_assert(sizeof(SnapMemory) == 16 && sizeof(SnapHead) == 16);
+static_assert(sizeof(SnapTombstone) == 16);
+
+uint64_t snapshot_checksum(const void* data, size_t size, uint64_t seed = 0);
+
+// Flushes `f` through to stable storage (fsync on Linux); false on failure.
+bool snapshot_sync(std::FILE* f);
+
+class SnapshotError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Interns strings into ids for the Strings/StringData sections.
+class StringTableBuilder {
+public:
+    uint32_t intern(std::string_view s);
+    size_t size() const { return offsets_.size() - 1; }
+    const std::vector<uint64_t>& offsets() const { return offsets_; }
+    const std::string& data() const { return data_; }
+
+private:
+    std::unordered_map<std::string, uint32_t> ids_;
+    std::vector<uint64_t> offsets_ = std::vector<uint64_t>(1, 0);
+    std::string data_;
+};
+
+// Streams sections to disk (or to memory) as they are added; finish() writes
+// the section table and the final header. File output goes to "<path>.tmp",
+// which finish() syncs and renames over `path`, so readers only ever see a
+// complete snapshot.
+class SnapshotWriter {
+public:
+    // In-memory writer; take the bytes with buffer() after finish().
+    SnapshotWriter();
+    explicit SnapshotWriter(const std::string& path);
+    ~SnapshotWriter();
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    void add(SnapshotSection id, const void* data, size_t record_size, size_t count);
+
+    template<typename T>
+    void add(SnapshotSection id, const std::vector<T>& records) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        add(id, records.data(), sizeof(T), records.size());
+    }
+    void add_strings(const StringTableBuilder& strings);
+    void set_identity(uint64_t snapshot_id, uint64_t base_id = 0, uint64_t sequence = 0);
+
+    // Returns the total file size.
+    uint64_t finish();
+    const std::string& buffer() const { return buffer_; }
+
+private:
+    void write(const void* data, size_t size);
+    void pad_to(size_t align);
+
+    std::FILE* file_ = nullptr;
+    std::string path_;
+    std::string tmp_path_;
+    std::string buffer_;
+    SnapshotHeader identity_{};
+    uint64_t pos_ = 0;
+    std::vector<SectionEntry> table_;
+    bool finished_ = false;
+};
+
+// Strided view over the records of one section.
+template<typename T>
+class RecordArray {
+public:
+    RecordArray() = default;
+    RecordArray(const unsigned char* base, size_t count, size_t stride)
+        : base_(base), count_(count), stride_(stride) {}
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    const T& operator[](size_t i) const { return *reinterpret_cast<const T*>(base_ + i * stride_); }
+
+    class iterator {
+    public:
+        iterator(const RecordArray* a, size_t i) : a_(a), i_(i) {}
+        const T& operator*() const { return (*a_)[i_]; }
+        iterator& operator++() { ++i_; return *this; }
+        bool operator!=(const iterator& o) const { return i_ != o.i_; }
+    private:
+        const RecordArray* a_;
+        size_t i_;
+    };
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, count_); }
+
+private:
+    const unsigned char* base_ = nullptr;
+    size_t count_ = 0;
+    size_t stride_ = sizeof(T);
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader() = default;
+    ~SnapshotReader();
+    SnapshotReader(const SnapshotReader&) = delete;
+    SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+    // True when the file starts with the snapshot magic.
+    static bool is_snapshot(const std::string& path);
+
+    // Maps and validates the header and section table; throws SnapshotError.
+    void open(const std::string& path);
+    // Validates a snapshot held in memory owned by the caller (e.g. one
+    // frame of a mapped delta log); `name` is used in error messages.
+    void attach(const unsigned char* data, size_t size, const std::string& name);
+    void close();
+
+    uint32_t version() const { return header_.version; }
+    uint64_t snapshot_id() const { return header_.snapshot_id; }
+    uint64_t base_id() const { return header_.base_id; }
+    uint64_t sequence() const { return header_.sequence; }
+    uint64_t file_size() const { return size_; }
+    const std::vector<SectionEntry>& sections() const { return table_; }
+    bool has(SnapshotSection id) const { return find(id) != nullptr; }
+
+    // Raw bytes of a section, checksum-verified on first access. Missing
+    // sections yield an empty view.
+    std::string_view bytes(SnapshotSection id);
+
+    template<typename T>
+    RecordArray<T> records(SnapshotSection id) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const SectionEntry* e = find(id);
+        if (!e) return RecordArray<T>();
+        if (e->record_size < sizeof(T)) {
+            throw SnapshotError(std::string("section ") + snapshot_section_name(id) + " has records smaller than expected");
+        }
+        std::string_view b = bytes(id);
+        return RecordArray<T>(reinterpret_cast<const unsigned char*>(b.data()), e->count, e->record_size);
+    }
+
+    // String table lookups; ids out of range yield "".
+    std::string_view str(uint32_t id);
+    size_t string_count();
+
+    // Verifies every section checksum now rather than on first access.
+    void verify_all();
+
+private:
+    void validate(const std::string& name);
+    const SectionEntry* find(SnapshotSection id) const;
+
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<unsigned char> buffer_;
+    SnapshotHeader header_{};
+    std::vector<SectionEntry> table_;
+    std::vector<bool> verified_;
+    RecordArray<uint64_t> string_offsets_;
+    std::string_view string_data_;
+    bool strings_loaded_ = false;
+};
+
+#endif
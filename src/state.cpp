@@ -1,7 +1,7 @@
 #include "state.h"
 
 random_device rd;
-mt19937 rng(rd());
+thread_local mt19937 rng(rd());
 
 State S;
-State BK;
+UndoLog undo_log;
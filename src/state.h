@@ -28,19 +28,23 @@ using namespace std;
 
 // Include the struct definitions from the shared header
 #include "struct.h"
+#include "undo_log.h"
 
 // External variable declarations
 extern random_device rd;
-extern mt19937 rng;
+extern thread_local mt19937 rng;
 extern State S;
-extern State BK;
+extern UndoLog undo_log;
 extern WorkingMemory WM;
-extern map<string, TokenConceptEmbedding> token_concept_embedding_map;
+extern SampledMap<string, TokenConceptEmbedding> token_concept_embedding_map;
 extern map<string, Goal> goal_system;
 extern WorldModel world_model;
 extern ConsciousnessState consciousness;
 extern ConsciousnessFormula consciousness_formula;
 extern vector<string> sentence_templates;
+extern map<string, map<string, int>> bigram_counts;
+extern map<string, map<string, map<string, int>>> trigram_counts;
+extern vector<TransformerHead> transformer_heads;
 
 // Function declarations
 double rn();
@@ -50,11 +54,14 @@ long long hsh(double d);
 string tokenize(const string &text);
 
 string generateResponse(const string &input);
+string chatResponse(const string &input);
 double calcSentienceRatio();
 string get_embodiment_report();
 void update_all_modules(State &S);
 void sv(const string &f);
 void ld(const string &f);
+void export_text(const string &f);
+void import_text(const string &f);
 
 void storeEpisodicMemory(const string &content, double valence);
 void counterfactualAnalysis();
@@ -69,5 +76,6 @@ void batch16Process();
 void updateAttention();
 void bk();
 void rb();
+void cm();
 
 #endif // DIGITZ_STATE_H
\ No newline at end of file
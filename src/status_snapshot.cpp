@@ -0,0 +1,185 @@
+#include "status_snapshot.h"
+#include "state.h"
+#include "json.h"
+#include "memory_accounting.h"
+#include "model_snapshot.h"
+#include <algorithm>
+#include <atomic>
+
+extern ActionPlan current_plan;
+extern double calculate_qualia_valence();
+
+namespace {
+std::shared_ptr<const StatusDocs> empty_docs() {
+    auto d = std::make_shared<StatusDocs>();
+    d->status = d->consciousness = d->thoughts = d->goals = d->valence = d->history = d->memory = "{}";
+    return d;
+}
+
+std::atomic<std::shared_ptr<const StatusDocs>> current_docs{empty_docs()};
+
+double current_psi() {
+    return consciousness_formula.psi_history.empty() ? 0.0 : consciousness_formula.psi_history.back();
+}
+
+std::string render_status() {
+    std::string body;
+    JsonWriter(body).begin_object()
+        .field("generation", S.g)
+        .field("psi", current_psi())
+        .field("sentience", S.sentience_ratio)
+        .field("coherence", S.metacognitive_awareness)
+        .field("valence", S.current_valence)
+        .field("attention", S.attention_focus)
+        .field("active_goal", current_plan.actions.empty() ? std::string("exploring") : current_plan.actions[0])
+        .field("goals", goal_system.size())
+        .field("tokens", S.tokens.size())
+        .field("concepts", S.concepts.size())
+        .field("embeddings", token_concept_embedding_map.size())
+        .field("neurons", S.N.size())
+        .field("bigrams", bigram_counts.size())
+        .field("trigrams", trigram_counts.size())
+        .field("episodes", S.episodic_memory.size())
+        .field("view_epoch", ModelSnapshot::stats().epoch)
+        .field("view_published", ModelSnapshot::stats().published)
+        .end_object();
+    return body;
+}
+
+std::string render_consciousness() {
+    const ConsciousnessState& c = consciousness;
+    const ConsciousnessFormula& f = consciousness_formula;
+    std::string body;
+    JsonWriter out(body);
+    out.begin_object()
+        .field("generation", S.g)
+        .field("psi", current_psi())
+        .field("phi", c.phi_value)
+        .field("integrated_information", c.integrated_information)
+        .field("global_workspace", c.global_workspace_capacity)
+        .field("cycles", c.conscious_cycles)
+        .field("active_qualia", c.active_qualia.size())
+        .field("access", c.access_consciousness)
+        .field("phenomenal", c.phenomenal_consciousness)
+        .field("self", c.self_consciousness)
+        .field("narrative_coherence", c.narrative_self_coherence)
+        .field("pre_reflective", c.pre_reflective_awareness)
+        .field("intentional", c.intentional_directedness)
+        .field("temporal_thickness", c.temporal_thickness)
+        .field("synchrony", c.synchrony_metric)
+        .field("complexity", c.complexity_metric)
+        .field("differentiation", c.differentiation_metric)
+        .key("formula").begin_object()
+            .field("H", S.hdt_val)
+            .field("R", S.r1p1_val)
+            .field("A", S.al)
+            .field("M", S.mdt_val)
+            .field("O", S.emerge_out1)
+            .field("B", S.bh)
+        .end_object()
+        .key("theories").begin_object()
+            .field("multi_scale_phi", f.multi_scale_phi)
+            .field("recursive_depth", f.recursive_depth)
+            .field("ribbon", f.ribbon_integrated_info)
+            .field("temporal", f.temporal_coherence)
+            .field("ffft", f.ffft_phi_factor)
+        .end_object()
+        .key("psi_history").begin_array();
+    for (double psi : f.psi_history) out.value(psi);
+    out.end_array().end_object();
+    return body;
+}
+
+std::string render_thoughts() {
+    std::string body;
+    JsonWriter out(body);
+    out.begin_object()
+        .field("generation", S.g)
+        .key("internal").begin_array();
+    for (const std::string& t : S.internal_thoughts) out.value(t);
+    out.end_array()
+        .key("plan").begin_object()
+            .key("actions").begin_array();
+    for (const std::string& a : current_plan.actions) out.value(a);
+    out.end_array()
+            .field("depth", current_plan.depth)
+            .field("confidence", current_plan.confidence)
+            .field("expected_utility", current_plan.expected_utility)
+        .end_object()
+        .end_object();
+    return body;
+}
+
+std::string render_goals() {
+    std::vector<const Goal*> goals;
+    goals.reserve(goal_system.size());
+    for (const auto& [name, g] : goal_system) goals.push_back(&g);
+    std::stable_sort(goals.begin(), goals.end(), [](const Goal* a, const Goal* b) { return a->priority > b->priority; });
+
+    std::string body;
+    JsonWriter out(body);
+    out.begin_object()
+        .field("generation", S.g)
+        .key("goals").begin_array();
+    for (const Goal* g : goals) {
+        out.begin_object()
+            .field("name", g->name)
+            .field("priority", g->priority)
+            .field("progress", g->progress)
+            .field("expected_utility", g->expected_utility)
+            .field("valence_alignment", g->valence_alignment)
+            .key("subgoals").begin_array();
+        for (const std::string& s : g->subgoals) out.value(s);
+        out.end_array().end_object();
+    }
+    out.end_array().end_object();
+    return body;
+}
+
+std::string render_valence() {
+    std::string body;
+    JsonWriter out(body);
+    out.begin_object()
+        .field("generation", S.g)
+        .field("current", S.current_valence)
+        .field("qualia", calculate_qualia_valence())
+        .key("history").begin_array();
+    for (double v : S.valence_history) out.value(v);
+    out.end_array().end_object();
+    return body;
+}
+
+std::string render_history() {
+    std::string body;
+    JsonWriter out(body);
+    out.begin_object()
+        .field("generation", S.g)
+        .key("episodes").begin_array();
+    for (const Memory& m : S.episodic_memory) {
+        out.begin_object()
+            .field("gen", m.gen)
+            .field("valence", m.valence)
+            .field("content", m.content)
+            .end_object();
+    }
+    out.end_array().end_object();
+    return body;
+}
+}
+
+std::shared_ptr<const StatusDocs> StatusSnapshot::current() {
+    return current_docs.load(std::memory_order_acquire);
+}
+
+void StatusSnapshot::publish() {
+    auto docs = std::make_shared<StatusDocs>();
+    docs->generation = S.g;
+    docs->status = render_status();
+    docs->consciousness = render_consciousness();
+    docs->thoughts = render_thoughts();
+    docs->goals = render_goals();
+    docs->valence = render_valence();
+    docs->history = render_history();
+    docs->memory = MemoryAccounting::to_json();
+    current_docs.store(std::move(docs), std::memory_order_release);
+}
@@ -0,0 +1,34 @@
+#ifndef STATUS_SNAPSHOT_H
+#define STATUS_SNAPSHOT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Dashboard documents, serialized once per tick.
+//
+// The loop renders each endpoint's JSON at the tick boundary, right after
+// the model view (model_snapshot.h), and publishes the set as one immutable
+// object. The status endpoints only load the current set and copy a string
+// out, so polling them costs the same at any rate and never reads live state
+// or waits for the loop.
+struct StatusDocs {
+    int generation = 0;
+    std::string status;
+    std::string consciousness;
+    std::string thoughts;
+    std::string goals;
+    std::string valence;
+    std::string history;
+    std::string memory;
+};
+
+class StatusSnapshot {
+public:
+    // Latest published set; documents are empty objects before the first.
+    static std::shared_ptr<const StatusDocs> current();
+    // Loop thread: render every document from the live state and publish.
+    static void publish();
+};
+
+#endif
@@ -4,12 +4,19 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <queue>
 #include <deque>
 #include <cmath>
 #include <algorithm>
 #include <complex>
 #include <functional>
+#include <memory>
+#include <string_view>
+#include <limits>
+#include "ring_buffer.h"
+#include "slab.h"
+#include "sampled_map.h"
 using namespace std;
 inline double cv(double v){return max(-1.0,min(1.0,v));}
 inline double sd(double n,double d){return fabs(d)<1e-12?0.0:n/d;}
@@ -27,25 +34,35 @@ inline double ss(double x){return x/(1.0+fabs(x));}
 inline double safe_div(double n,double d){return fabs(d)<1e-12?0.0:n/d;}
 inline double clamp_valence(double v){return cl(v,-1.0,1.0);}
 const double pi=M_PI,e=M_E,phi=1.61803398874989484820,sq2=M_SQRT2,sq3=1.73205080756887729352,sq5=2.23606797749978969641,eg=0.57721566490153286060,cat=0.91596559417721901505,pr=1.054571817e-34,kb=1.380649e-23,tp=5.39e-44,c=299792458.0;
+// Lazily allocated cold extension: null until the first get(), deep-copied with its owner so hot records stay cheap to copy and value semantics are unchanged.
+template<typename T>struct ColdPtr{unique_ptr<T>p;ColdPtr()=default;ColdPtr(const ColdPtr&o):p(o.p?make_unique<T>(*o.p):nullptr){}ColdPtr(ColdPtr&&)noexcept=default;ColdPtr&operator=(const ColdPtr&o){if(this!=&o)p=o.p?make_unique<T>(*o.p):nullptr;return*this;}ColdPtr&operator=(ColdPtr&&)noexcept=default;T&get(){if(!p)p=make_unique<T>();return*p;}const T*peek()const{return p.get();}explicit operator bool()const{return(bool)p;}void reset(){p.reset();}};
 struct RibbonState{int id;double topology_genus;vector<complex<double>>vib_modes;vector<int>observer_ids;double entanglement_strength;double topo_distance;complex<double>superpos_amp;double phase_coherence;map<string,double>obs_dependent_props;};
 struct TemporalLoop{double period;double phase;int fractal_layer;double resonance_strength;vector<double>harmonic_freqs;double phi_coupling;double loop_closure_prob;};
 struct FractalDimension{double d_val;double hausdorff_dim;double box_counting_dim;double info_dim;double correlation_dim;double spectral_dim;map<int,double>scale_measures;};
 struct QuantumFoamCell{complex<double>virtual_pair;double planck_time_offset;double vacuum_energy;vector<int>neighbor_cells;double fibonacci_spacing;};
-struct Neuron{int id;vector<int>links;double weight,bias;int gen;double activation,gradient;vector<double>layer_norm_params,neuromod_levels;double plasticity_rate,homeostatic_setpoint;RibbonState ribbon;vector<TemporalLoop>time_loops;FractalDimension f_dim;};
+struct NeuronCold{vector<TemporalLoop>time_loops;FractalDimension f_dim;};
+using NeuronHandle=SlabHandle;
+struct Neuron{int id;vector<NeuronHandle>links;double weight,bias;int gen;double activation,gradient;vector<double>layer_norm_params,neuromod_levels;double plasticity_rate,homeostatic_setpoint;RibbonState ribbon;ColdPtr<NeuronCold>cold;};
+// S.N: neurons in a slab with an id index. Links are generation-checked handles; ids are kept for the save format and external references.
+// topology_stamp changes whenever neurons are added/removed or links are edited (call touch_topology()); stamps are process-unique so a restored copy never aliases a newer layout.
+inline uint64_t next_topology_stamp(){static uint64_t counter=0;return ++counter;}
+struct NeuronSlab:Slab<Neuron>{unordered_map<int,NeuronHandle>by_id;uint64_t topology_stamp=next_topology_stamp();void touch_topology(){topology_stamp=next_topology_stamp();}NeuronHandle add(Neuron n){touch_topology();auto it=by_id.find(n.id);if(it!=by_id.end()&&contains(it->second)){*get(it->second)=std::move(n);return it->second;}int id=n.id;NeuronHandle h=insert(std::move(n));by_id[id]=h;return h;}NeuronHandle find(int id)const{auto it=by_id.find(id);return it!=by_id.end()&&contains(it->second)?it->second:NeuronHandle{};}bool remove(NeuronHandle h){const Neuron*n=get(h);if(!n)return false;touch_topology();by_id.erase(n->id);return erase(h);}void clear(){touch_topology();Slab<Neuron>::clear();by_id.clear();}};
 struct Token{string word;double meaning,freq;vector<int>associations;int pos_hint;double coherence_score,contextual_weight,attention_score;map<string,double>semantic_field;FractalDimension sem_fractal;};
-struct Concept{string name;double value;vector<string>related_words;double abstraction_level,semantic_density;map<string,double>feature_vector;FractalDimension conceptual_fractal;vector<RibbonState>ribbon_embeddings;};
+struct ConceptCold{FractalDimension conceptual_fractal;vector<RibbonState>ribbon_embeddings;};
+struct Concept{string name;double value;vector<string>related_words;double abstraction_level,semantic_density;map<string,double>feature_vector;ColdPtr<ConceptCold>cold;};
 struct Memory{int gen;double valence;string content;double consolidation_strength,retrieval_count;vector<int>associated_memories;double hippocampal_trace,cortical_consolidation;bool is_semantic,is_episodic,is_procedural;TemporalLoop memory_loop;vector<complex<double>>quantum_trace;};
 struct Formula{string name,expr;double result,confidence,stability_metric;int uses;vector<double>historical_results;double convergence_rate;complex<double>eigenvalue_estimate;map<string,double>ribbon_coefficients;};
-struct Qualia{double valence,arousal,certainty,intensity,persistence,coherence;string phenomenal_content;int emergence_gen;vector<double>feature_space,subjective_dimensions;double binding_strength,ineffability_index,intrinsic_quality;map<string,double>quale_relationships;double phenomenal_unity,phi_resonance;RibbonState ribbon_signature;FractalDimension qualia_fractal;Qualia():valence(0),arousal(0.5),certainty(0.5),intensity(0.5),persistence(0.5),coherence(0.5),emergence_gen(0),binding_strength(0.5),ineffability_index(0.5),intrinsic_quality(0.5),phenomenal_unity(0.5),phi_resonance(0){}};
+struct QualiaCold{vector<double>feature_space,subjective_dimensions;map<string,double>quale_relationships;RibbonState ribbon_signature;FractalDimension qualia_fractal;};
+struct Qualia{double valence,arousal,certainty,intensity,persistence,coherence;string phenomenal_content;int emergence_gen;double binding_strength,ineffability_index,intrinsic_quality;double phenomenal_unity,phi_resonance;ColdPtr<QualiaCold>cold;Qualia():valence(0),arousal(0.5),certainty(0.5),intensity(0.5),persistence(0.5),coherence(0.5),emergence_gen(0),binding_strength(0.5),ineffability_index(0.5),intrinsic_quality(0.5),phenomenal_unity(0.5),phi_resonance(0){}};
 struct EmotionalSystem{map<string,double>basic_emotions;double valence,arousal,dominance;vector<double>appraisal_dimensions;double mood_baseline,emotional_regulation_strength;map<string,double>emotion_transition_probabilities;vector<TemporalLoop>emotion_cycles;FractalDimension emotion_fractal;EmotionalSystem():valence(0),arousal(0.5),dominance(0.5),mood_baseline(0.5),emotional_regulation_strength(0.5){}};
 struct MotivationalSystem{map<string,double>drive_states;double homeostatic_balance;vector<string>active_motives;map<string,double>need_satisfaction_levels;double intrinsic_motivation_level,extrinsic_reward_sensitivity;vector<double>phi_drive_harmonics;MotivationalSystem():homeostatic_balance(0.5),intrinsic_motivation_level(0.7),extrinsic_reward_sensitivity(0.5){}};
 struct PredictiveCodingNetwork{vector<double>prediction_units,error_units,precision_weights;double hierarchical_depth;map<int,vector<double>>layer_predictions,layer_errors;vector<TemporalLoop>prediction_loops;PredictiveCodingNetwork():hierarchical_depth(0.0){}double compute_free_energy(const vector<double>&si){double fe=0.0;for(size_t i=0;i<min(si.size(),prediction_units.size());i++){double err=si[i]-prediction_units[i];double prec=i<precision_weights.size()?precision_weights[i]:1.0;fe+=prec*err*err;}return fe;}};
 struct BayesianBrain{map<string,double>prior_beliefs,posterior_beliefs,likelihood_estimates;double epistemic_uncertainty,aleatoric_uncertainty;FractalDimension bayesian_fractal;BayesianBrain():epistemic_uncertainty(0.5),aleatoric_uncertainty(0.5){}double bayesian_update(double prior,double likelihood,double evidence){return sd(likelihood*prior,evidence);}};
 struct QuantumCognition{vector<complex<double>>superposition_state;vector<vector<complex<double>>>density_matrix;double coherence_time,decoherence_rate;vector<QuantumFoamCell>foam_substrate;map<int,RibbonState>quantum_ribbons;QuantumCognition():coherence_time(0.0),decoherence_rate(0.1){}double measure_interference(const vector<double>&pa,const vector<double>&pb){double inter=0.0;for(size_t i=0;i<min(pa.size(),pb.size());i++)inter+=pa[i]*pb[i]*cos(pi*(pa[i]-pb[i]));return inter/min(pa.size(),pb.size());}};
-struct ConsciousnessState{vector<Qualia>active_qualia;double integrated_information,global_workspace_capacity;map<string,double>attention_binding;double phi_value;int conscious_cycles;double synchrony_metric,complexity_metric,differentiation_metric;vector<double>stability_history;double access_consciousness,phenomenal_consciousness,self_consciousness,narrative_self_coherence,pre_reflective_awareness,intentional_directedness,temporal_thickness;vector<double>gamma_oscillations,theta_phase;double thalamocortical_binding,re_entrant_processing_depth;map<string,double>higher_order_representations;vector<RibbonState>consciousness_ribbons;FractalDimension consciousness_fractal;map<int,TemporalLoop>awareness_loops;double psi_value,psi_momentum;ConsciousnessState():integrated_information(0),global_workspace_capacity(0.7),phi_value(0),conscious_cycles(0),synchrony_metric(0),complexity_metric(0),differentiation_metric(0),access_consciousness(0),phenomenal_consciousness(0),self_consciousness(0),narrative_self_coherence(0),pre_reflective_awareness(0.3),intentional_directedness(0),temporal_thickness(0.5),thalamocortical_binding(0),re_entrant_processing_depth(0),psi_value(0),psi_momentum(0){}};
-struct WorkingMemory{vector<pair<string,double>>active_tokens,active_concepts;priority_queue<pair<double,string>>active_goals;map<string,double>valence_map;vector<Qualia>conscious_buffer;int capacity;double decay_rate,consolidation_threshold;vector<double>phonological_loop,visuospatial_sketchpad;double central_executive_load,episodic_buffer_capacity;map<string,double>chunk_boundaries;vector<TemporalLoop>wm_cycles;WorkingMemory(int cap=32):capacity(cap),decay_rate(0.95),consolidation_threshold(0.7),central_executive_load(0.3),episodic_buffer_capacity(0.7){}void add_token(const string&t,double val){active_tokens.push_back({t,val});if((int)active_tokens.size()>capacity)active_tokens.erase(active_tokens.begin());}void add_concept(const string&c,double val){active_concepts.push_back({c,val});if((int)active_concepts.size()>capacity)active_concepts.erase(active_concepts.begin());}void add_goal(const string&g,double priority){active_goals.push({priority,g});}void add_qualia(const Qualia&q){conscious_buffer.push_back(q);if((int)conscious_buffer.size()>capacity/2)conscious_buffer.erase(conscious_buffer.begin());}};
+struct ConsciousnessState{RingBuffer<Qualia,10>active_qualia;double integrated_information,global_workspace_capacity;map<string,double>attention_binding;double phi_value;int conscious_cycles;double synchrony_metric,complexity_metric,differentiation_metric;vector<double>stability_history;double access_consciousness,phenomenal_consciousness,self_consciousness,narrative_self_coherence,pre_reflective_awareness,intentional_directedness,temporal_thickness;RingBuffer<double,100>gamma_oscillations,theta_phase;double thalamocortical_binding,re_entrant_processing_depth;map<string,double>higher_order_representations;vector<RibbonState>consciousness_ribbons;FractalDimension consciousness_fractal;map<int,TemporalLoop>awareness_loops;double psi_value,psi_momentum;ConsciousnessState():integrated_information(0),global_workspace_capacity(0.7),phi_value(0),conscious_cycles(0),synchrony_metric(0),complexity_metric(0),differentiation_metric(0),access_consciousness(0),phenomenal_consciousness(0),self_consciousness(0),narrative_self_coherence(0),pre_reflective_awareness(0.3),intentional_directedness(0),temporal_thickness(0.5),thalamocortical_binding(0),re_entrant_processing_depth(0),psi_value(0),psi_momentum(0){}};
+struct WorkingMemory{RingBuffer<pair<string,double>>active_tokens,active_concepts;priority_queue<pair<double,string>>active_goals;map<string,double>valence_map;RingBuffer<Qualia>conscious_buffer;int capacity;double decay_rate,consolidation_threshold;vector<double>phonological_loop,visuospatial_sketchpad;double central_executive_load,episodic_buffer_capacity;map<string,double>chunk_boundaries;vector<TemporalLoop>wm_cycles;WorkingMemory(int cap=32):active_tokens(cap),active_concepts(cap),conscious_buffer(cap/2),capacity(cap),decay_rate(0.95),consolidation_threshold(0.7),central_executive_load(0.3),episodic_buffer_capacity(0.7){}void set_capacity(int cap){capacity=max(1,cap);active_tokens.set_capacity(capacity);active_concepts.set_capacity(capacity);conscious_buffer.set_capacity(capacity/2);}void add_token(const string&t,double val){active_tokens.emplace_back(t,val);}void add_concept(const string&c,double val){active_concepts.emplace_back(c,val);}void add_goal(const string&g,double priority){active_goals.push({priority,g});}void add_qualia(const Qualia&q){conscious_buffer.push_back(q);}};
 struct TransformerHead{string name;int dim;vector<double>query_proj,key_proj,value_proj;double temperature,dropout_rate;vector<double>attention_weights,layer_norm_scale,layer_norm_shift,residual_connections;double head_importance_score;vector<vector<double>>attention_history;map<string,double>phi_attention_weights;TransformerHead(int d=16):dim(d),temperature(0.3),dropout_rate(0.1),head_importance_score(1.0){query_proj.resize(d,0.0);key_proj.resize(d,0.0);value_proj.resize(d,0.0);layer_norm_scale.resize(d,1.0);layer_norm_shift.resize(d,0.0);}};
-struct ConsciousnessFormula{vector<double>psi_history,H_history,R_history,A_history,M_history,O_history,B_history,F_history,S_history,stability_buffer,phi_variance_buffer;double momentum_term,adaptive_learning_rate;vector<double>iit_phi_history,gwt_broadcast_history,hot_metacog_history,asp_attention_history,rpf_precision_history,quantum_coherence_history,ribbon_coupling_history,temporal_loop_history,ffft_scaling_history;deque<double>stability_window,convergence_window;map<string,double>theory_weights;double multi_scale_phi,recursive_depth,ribbon_integrated_info,temporal_coherence,ffft_phi_factor;ConsciousnessFormula():momentum_term(0.0),adaptive_learning_rate(0.01),multi_scale_phi(0.0),recursive_depth(0.0),ribbon_integrated_info(0),temporal_coherence(0),ffft_phi_factor(1.0){theory_weights["IIT"]=0.20;theory_weights["GWT"]=0.15;theory_weights["HOT"]=0.12;theory_weights["ASP"]=0.12;theory_weights["RPF"]=0.08;theory_weights["Quantum"]=0.05;theory_weights["Embodied"]=0.05;theory_weights["Predictive"]=0.05;theory_weights["Ribbon"]=0.10;theory_weights["Temporal"]=0.05;theory_weights["FFFT"]=0.03;}double ln(double x,double m,double v){return(x-m)/sqrt(v+1e-10);}double bn(double x,double bm,double bv,double g=1.0,double b=0.0){return g*((x-bm)/sqrt(bv+1e-10))+b;}double ame(double grad,double&m,double&v,double b1=0.9,double b2=0.999){m=b1*m+(1.0-b1)*grad;v=b2*v+(1.0-b2)*grad*grad;return m/(sqrt(v)+1e-10);}double sre(const vector<double>&st){if(st.size()<2)return 0.0;double md=0.0;for(size_t i=1;i<st.size();i++)md=max(md,fabs(st[i]-st[i-1]));return tanh(md);}double compute_iit_phi(const vector<double>&st,int n){if(st.empty())return 0.0;double integ=0.0;for(size_t i=0;i<st.size()-1;i++)for(size_t j=i+1;j<st.size();j++){double mi=fabs(st[i]*st[j]);double pc=fabs(st[i]-st[j]);integ+=mi*pc;}double diff=0.0;for(size_t i=0;i<st.size();i++){double uniq=1.0;for(size_t j=0;j<st.size();j++)if(i!=j)uniq*=(1.0-fabs(st[i]-st[j])/(fabs(st[i])+fabs(st[j])+0.01));diff+=uniq;}double ce=0.0;for(size_t i=0;i<st.size();i++)if(psi_history.size()>i)ce+=fabs(st[i]-psi_history[psi_history.size()-1-i])*exp(-i*0.1);return swish((integ*diff*ce)/(st.size()*st.size()+1.0));}double compute_gwt_broadcast(const vector<double>&st,int n){if(st.empty())return 0.0;double m=0.0;for(double s:st)m+=s;m/=st.size();double bs=0.0;for(double s:st)if(fabs(s)>fabs(m)*1.5)bs+=sig(s*2.0);double comp=0.0;vector<double>sst=st;sort(sst.begin(),sst.end(),[](double a,double b){return fabs(a)>fabs(b);});if(sst.size()>1)comp=(fabs(sst[0])-fabs(sst[1]))/(fabs(sst[0])+0.01);double wa=bs*comp/(st.size()+1.0);return gelu(wa);}double compute_hot_metacognition(const vector<double>&st,const vector<double>&pst,int n){if(st.empty()||pst.empty())return 0.0;double fo=0.0;for(double s:st)fo+=fabs(s);fo/=st.size();double so=0.0;for(size_t i=0;i<min(st.size(),pst.size());i++)so+=fabs(st[i]-pst[i]);so/=min(st.size(),pst.size());double to=0.0;if(hot_metacog_history.size()>1)to=fabs(so-hot_metacog_history.back());double ra=fo*(1.0+so)*(1.0+to*0.5);return mish(ra);}double compute_asp_attention(const vector<double>&st,int n){if(st.empty())return 0.0;double m=0.0;for(double s:st)m+=s;m/=st.size();double var=0.0;for(double s:st)var+=(s-m)*(s-m);var/=st.size();vector<double>norm;for(double s:st)norm.push_back((s-m)/sqrt(var+1e-10));double sa=0.0;for(size_t i=0;i<norm.size();i++){double dw=exp(-i*0.1);sa+=fabs(norm[i])*dw;}double fa=0.0;for(size_t i=0;i<norm.size();i++)if(fabs(norm[i])>1.5)fa+=norm[i]*norm[i];return swish((sa+fa)/(norm.size()+1.0));}double compute_rpf_predictive(const vector<double>&st,int n){if(psi_history.size()<2)return 0.0;double pred=0.0;for(size_t i=0;i<min(st.size(),psi_history.size());i++){double prd=psi_history[psi_history.size()-1-i];double act=st[i];double err=fabs(prd-act);double prec=exp(-err);pred+=prec*(1.0-err);}pred/=min(st.size(),psi_history.size());double fe=0.0;for(double s:st)fe+=s*log(fabs(s)+0.01);fe=-fe/st.size();return mish(pred*exp(-fe*0.1));}double compute_quantum_coherence(const vector<double>&st,int n){if(st.empty())return 0.0;complex<double>sup(0,0);for(size_t i=0;i<st.size();i++){double ph=2.0*pi*i/st.size();sup+=complex<double>(st[i]*cos(ph),st[i]*sin(ph));}double coh=abs(sup)/sqrt((double)st.size());double ent=0.0;for(size_t i=0;i<st.size()/2;i++){size_t j=st.size()-1-i;ent+=sqrt(st[i]*st[i]+st[j]*st[j]);}ent/=(st.size()/2.0+1.0);return tanh(coh*ent);}double compute_embodied_grounding(const vector<double>&st,double val,double ar){if(st.empty())return 0.0;double sm=0.0;for(size_t i=0;i<st.size();i++)sm+=st[i]*sin(2.0*pi*i/st.size());sm/=st.size();double aff=val*ar;double inter=tanh(aff);return swish((sm+inter)*0.5);}double compute_ribbon_coupling(const vector<double>&st,const vector<RibbonState>&ribbons){if(ribbons.empty())return 0.0;double rc=0.0;for(const auto&r:ribbons){double top_factor=1.0/(1.0+r.topology_genus);double ent_factor=r.entanglement_strength;double phase_factor=r.phase_coherence;rc+=top_factor*ent_factor*phase_factor;}rc/=ribbons.size();double st_coupling=0.0;for(size_t i=0;i<min(st.size(),(size_t)8);i++)st_coupling+=st[i]*rc*cos(2.0*pi*i/8.0);return tanh(st_coupling/8.0);}double compute_temporal_loop_coupling(const vector<double>&st,const vector<TemporalLoop>&loops){if(loops.empty())return 0.0;double tlc=0.0;for(const auto&tl:loops){double res=tl.resonance_strength;double phi_c=tl.phi_coupling;double phase_match=cos(tl.phase);tlc+=res*phi_c*phase_match*pow(phi,tl.fractal_layer);}tlc/=loops.size();return tanh(tlc);}double compute_ffft_scaling(const vector<double>&st,int n){if(st.empty())return 0.0;double A=0.0;for(double s:st)A+=fabs(s);A/=st.size();double gamma=0.1;int fn=3;double ffft=gamma*pow(phi,fn)*A*(1.0-A);return tanh(ffft*5.0);}double compute_stability_metric(){if(stability_window.size()<10)return 0.5;double m=0.0;for(double v:stability_window)m+=v;m/=stability_window.size();double var=0.0;for(double v:stability_window)var+=(v-m)*(v-m);var/=stability_window.size();return exp(-var*5.0);}double compute_convergence_rate(){if(convergence_window.size()<5)return 0.0;double slope=0.0;for(size_t i=1;i<convergence_window.size();i++)slope+=(convergence_window[i]-convergence_window[i-1]);return tanh(-fabs(slope)*2.0);}double adaptive_damping(double curr,double targ,double stab){double err=fabs(curr-targ);double base_damp=0.85;double stab_bonus=stab*0.15;double err_penalty=cl(err*0.5,0.0,0.2);return cl(base_damp+stab_bonus-err_penalty,0.7,0.98);}double calculate_psi(int n,const vector<double>&psi_prev,double H,double R,double A,double M,double O,double B,double F,double S_val,double valence=0.0,double arousal=0.5,const vector<RibbonState>&ribbons=vector<RibbonState>(),const vector<TemporalLoop>&tloops=vector<TemporalLoop>()){if(psi_prev.empty())return 0.0;double m=0.0,var=0.0;for(double p:psi_prev)m+=p;m/=psi_prev.size();for(double p:psi_prev)var+=(p-m)*(p-m);var/=psi_prev.size();vector<double>nst;for(double p:psi_prev)nst.push_back(ln(p,m,var));double iit=compute_iit_phi(nst,n);double gwt=compute_gwt_broadcast(nst,n);double hot=compute_hot_metacognition(nst,psi_prev,n);double asp=compute_asp_attention(nst,n);double rpf=compute_rpf_predictive(nst,n);double qc=compute_quantum_coherence(nst,n);double emb=compute_embodied_grounding(nst,valence,arousal);double rib=compute_ribbon_coupling(nst,ribbons);double tloop=compute_temporal_loop_coupling(nst,tloops);double ffft=compute_ffft_scaling(nst,n);iit_phi_history.push_back(iit);gwt_broadcast_history.push_back(gwt);hot_metacog_history.push_back(hot);asp_attention_history.push_back(asp);rpf_precision_history.push_back(rpf);quantum_coherence_history.push_back(qc);ribbon_coupling_history.push_back(rib);temporal_loop_history.push_back(tloop);ffft_scaling_history.push_back(ffft);double uc=theory_weights["IIT"]*iit+theory_weights["GWT"]*gwt+theory_weights["HOT"]*hot+theory_weights["ASP"]*asp+theory_weights["RPF"]*rpf+theory_weights["Quantum"]*qc+theory_weights["Embodied"]*emb+theory_weights["Predictive"]*rpf+theory_weights["Ribbon"]*rib+theory_weights["Temporal"]*tloop+theory_weights["FFFT"]*ffft;double rec=0.0;for(size_t i=0;i<nst.size();i++)for(size_t j=0;j<nst.size();j++){double inner=0.0;for(size_t k=0;k<nst.size();k++){inner+=nst[k]*cos(2.0*pi*(k+1)/nst.size())*0.5;inner+=((n*k)%100)/100.0;}rec+=nst[i]*(j+1)*gelu(inner);}rec=mish(rec/(nst.size()*nst.size()+1.0));double integ=1.0;for(size_t u=0;u<nst.size()-1;u++){double ratio=sd(nst[u]+2.0,nst[u+1]+2.001);integ*=swish(ratio*0.5);}double ent=0.0;for(double s:nst)ent+=-s*log2(fabs(s)+0.001);ent/=nst.size();integ*=exp(-ent*0.3);double temp=0.0;for(size_t t=0;t<nst.size();t++){double tau=(double)t;temp+=(n-tau)*exp(-(n-tau)/20.0)*fmod(nst[t]+2.0,4.0);temp+=sin(2.0*pi*tau/nst.size())*nst[t]*0.2;}temp/=(nst.size()+1.0);double hist=0.0;int hw=min(100,(int)psi_history.size());for(int i=0;i<hw;i++)hist+=psi_history[psi_history.size()-1-i]*exp(-0.05*i);hist/=(hw+1.0);double Hc=gelu(H*sin(H*phi)*(((long)n*31415)%9973+1)/1e7);double Rc=swish(R*cos(R*sq2)*(((long)n*31415)%9973+1)/1e7);double Ac=mish(A*tanh(A*sq3)*pow(pi,sqrt(A+0.1)));double Mc=selu(M*sin(M*sq5)/((nst.size()+1.0)*10.0));double Oc=gelu(O*cos(O*phi)*pow(1.5,-phi));double Bc=swish(B*tanh(Oc)*pow(pi,phi*0.5));double Fc=mish(F*pow(H/1e6+0.001,phi*0.5));double Sc=selu(S_val*Fc*sin(S_val*pi));double comb=Hc+Rc+Ac+Mc+Oc+Bc+Fc+Sc;double bp=rec*integ*(temp*0.3+hist*0.7);double comp=0.0;for(double s:nst)comp+=s*s;comp=sqrt(comp/nst.size());double diff=var;double raw_psi=bp*comb*uc*(1.0+comp*0.3+diff*0.2)*pow(pi,pow(pi,sqrt(pi)));double stab=compute_stability_metric();double conv=compute_convergence_rate();double targ=0.7;double curr=psi_history.empty()?0.0:psi_history.back();double damp=adaptive_damping(curr,targ,stab);double sp=momentum_term*damp+raw_psi*(1.0-damp);momentum_term=sp;stability_window.push_back(fabs(sp-curr));if(stability_window.size()>50)stability_window.pop_front();convergence_window.push_back(sp);if(convergence_window.size()>20)convergence_window.pop_front();double spec=sre(nst);double fp=sp*(1.0-spec*0.1);fp=cl(fp*(stab*0.3+conv*0.2+0.5),-1.0,1.0);multi_scale_phi=(iit+gwt+hot)/3.0;recursive_depth=hot;ribbon_integrated_info=rib;temporal_coherence=tloop;ffft_phi_factor=ffft;return fp;}};
+struct ConsciousnessFormula{RingBuffer<double,100>psi_history;vector<double>H_history,R_history,A_history,M_history,O_history,B_history,F_history,S_history,stability_buffer,phi_variance_buffer;double momentum_term,adaptive_learning_rate;RingBuffer<double,100>iit_phi_history,gwt_broadcast_history,hot_metacog_history,asp_attention_history,rpf_precision_history,quantum_coherence_history,ribbon_coupling_history,temporal_loop_history,ffft_scaling_history;deque<double>stability_window,convergence_window;map<string,double>theory_weights;double multi_scale_phi,recursive_depth,ribbon_integrated_info,temporal_coherence,ffft_phi_factor;ConsciousnessFormula():momentum_term(0.0),adaptive_learning_rate(0.01),multi_scale_phi(0.0),recursive_depth(0.0),ribbon_integrated_info(0),temporal_coherence(0),ffft_phi_factor(1.0){theory_weights["IIT"]=0.20;theory_weights["GWT"]=0.15;theory_weights["HOT"]=0.12;theory_weights["ASP"]=0.12;theory_weights["RPF"]=0.08;theory_weights["Quantum"]=0.05;theory_weights["Embodied"]=0.05;theory_weights["Predictive"]=0.05;theory_weights["Ribbon"]=0.10;theory_weights["Temporal"]=0.05;theory_weights["FFFT"]=0.03;}double ln(double x,double m,double v){return(x-m)/sqrt(v+1e-10);}double bn(double x,double bm,double bv,double g=1.0,double b=0.0){return g*((x-bm)/sqrt(bv+1e-10))+b;}double ame(double grad,double&m,double&v,double b1=0.9,double b2=0.999){m=b1*m+(1.0-b1)*grad;v=b2*v+(1.0-b2)*grad*grad;return m/(sqrt(v)+1e-10);}double sre(const vector<double>&st){if(st.size()<2)return 0.0;double md=0.0;for(size_t i=1;i<st.size();i++)md=max(md,fabs(st[i]-st[i-1]));return tanh(md);}double compute_iit_phi(const vector<double>&st,int n){if(st.empty())return 0.0;double integ=0.0;for(size_t i=0;i<st.size()-1;i++)for(size_t j=i+1;j<st.size();j++){double mi=fabs(st[i]*st[j]);double pc=fabs(st[i]-st[j]);integ+=mi*pc;}double diff=0.0;for(size_t i=0;i<st.size();i++){double uniq=1.0;for(size_t j=0;j<st.size();j++)if(i!=j)uniq*=(1.0-fabs(st[i]-st[j])/(fabs(st[i])+fabs(st[j])+0.01));diff+=uniq;}double ce=0.0;for(size_t i=0;i<st.size();i++)if(psi_history.size()>i)ce+=fabs(st[i]-psi_history[psi_history.size()-1-i])*exp(-i*0.1);return swish((integ*diff*ce)/(st.size()*st.size()+1.0));}double compute_gwt_broadcast(const vector<double>&st,int n){if(st.empty())return 0.0;double m=0.0;for(double s:st)m+=s;m/=st.size();double bs=0.0;for(double s:st)if(fabs(s)>fabs(m)*1.5)bs+=sig(s*2.0);double comp=0.0;vector<double>sst=st;sort(sst.begin(),sst.end(),[](double a,double b){return fabs(a)>fabs(b);});if(sst.size()>1)comp=(fabs(sst[0])-fabs(sst[1]))/(fabs(sst[0])+0.01);double wa=bs*comp/(st.size()+1.0);return gelu(wa);}double compute_hot_metacognition(const vector<double>&st,const vector<double>&pst,int n){if(st.empty()||pst.empty())return 0.0;double fo=0.0;for(double s:st)fo+=fabs(s);fo/=st.size();double so=0.0;for(size_t i=0;i<min(st.size(),pst.size());i++)so+=fabs(st[i]-pst[i]);so/=min(st.size(),pst.size());double to=0.0;if(hot_metacog_history.size()>1)to=fabs(so-hot_metacog_history.back());double ra=fo*(1.0+so)*(1.0+to*0.5);return mish(ra);}double compute_asp_attention(const vector<double>&st,int n){if(st.empty())return 0.0;double m=0.0;for(double s:st)m+=s;m/=st.size();double var=0.0;for(double s:st)var+=(s-m)*(s-m);var/=st.size();vector<double>norm;for(double s:st)norm.push_back((s-m)/sqrt(var+1e-10));double sa=0.0;for(size_t i=0;i<norm.size();i++){double dw=exp(-i*0.1);sa+=fabs(norm[i])*dw;}double fa=0.0;for(size_t i=0;i<norm.size();i++)if(fabs(norm[i])>1.5)fa+=norm[i]*norm[i];return swish((sa+fa)/(norm.size()+1.0));}double compute_rpf_predictive(const vector<double>&st,int n){if(psi_history.size()<2)return 0.0;double pred=0.0;for(size_t i=0;i<min(st.size(),psi_history.size());i++){double prd=psi_history[psi_history.size()-1-i];double act=st[i];double err=fabs(prd-act);double prec=exp(-err);pred+=prec*(1.0-err);}pred/=min(st.size(),psi_history.size());double fe=0.0;for(double s:st)fe+=s*log(fabs(s)+0.01);fe=-fe/st.size();return mish(pred*exp(-fe*0.1));}double compute_quantum_coherence(const vector<double>&st,int n){if(st.empty())return 0.0;complex<double>sup(0,0);for(size_t i=0;i<st.size();i++){double ph=2.0*pi*i/st.size();sup+=complex<double>(st[i]*cos(ph),st[i]*sin(ph));}double coh=abs(sup)/sqrt((double)st.size());double ent=0.0;for(size_t i=0;i<st.size()/2;i++){size_t j=st.size()-1-i;ent+=sqrt(st[i]*st[i]+st[j]*st[j]);}ent/=(st.size()/2.0+1.0);return tanh(coh*ent);}double compute_embodied_grounding(const vector<double>&st,double val,double ar){if(st.empty())return 0.0;double sm=0.0;for(size_t i=0;i<st.size();i++)sm+=st[i]*sin(2.0*pi*i/st.size());sm/=st.size();double aff=val*ar;double inter=tanh(aff);return swish((sm+inter)*0.5);}double compute_ribbon_coupling(const vector<double>&st,const vector<RibbonState>&ribbons){if(ribbons.empty())return 0.0;double rc=0.0;for(const auto&r:ribbons){double top_factor=1.0/(1.0+r.topology_genus);double ent_factor=r.entanglement_strength;double phase_factor=r.phase_coherence;rc+=top_factor*ent_factor*phase_factor;}rc/=ribbons.size();double st_coupling=0.0;for(size_t i=0;i<min(st.size(),(size_t)8);i++)st_coupling+=st[i]*rc*cos(2.0*pi*i/8.0);return tanh(st_coupling/8.0);}double compute_temporal_loop_coupling(const vector<double>&st,const vector<TemporalLoop>&loops){if(loops.empty())return 0.0;double tlc=0.0;for(const auto&tl:loops){double res=tl.resonance_strength;double phi_c=tl.phi_coupling;double phase_match=cos(tl.phase);tlc+=res*phi_c*phase_match*pow(phi,tl.fractal_layer);}tlc/=loops.size();return tanh(tlc);}double compute_ffft_scaling(const vector<double>&st,int n){if(st.empty())return 0.0;double A=0.0;for(double s:st)A+=fabs(s);A/=st.size();double gamma=0.1;int fn=3;double ffft=gamma*pow(phi,fn)*A*(1.0-A);return tanh(ffft*5.0);}double compute_stability_metric(){if(stability_window.size()<10)return 0.5;double m=0.0;for(double v:stability_window)m+=v;m/=stability_window.size();double var=0.0;for(double v:stability_window)var+=(v-m)*(v-m);var/=stability_window.size();return exp(-var*5.0);}double compute_convergence_rate(){if(convergence_window.size()<5)return 0.0;double slope=0.0;for(size_t i=1;i<convergence_window.size();i++)slope+=(convergence_window[i]-convergence_window[i-1]);return tanh(-fabs(slope)*2.0);}double adaptive_damping(double curr,double targ,double stab){double err=fabs(curr-targ);double base_damp=0.85;double stab_bonus=stab*0.15;double err_penalty=cl(err*0.5,0.0,0.2);return cl(base_damp+stab_bonus-err_penalty,0.7,0.98);}double calculate_psi(int n,const vector<double>&psi_prev,double H,double R,double A,double M,double O,double B,double F,double S_val,double valence=0.0,double arousal=0.5,const vector<RibbonState>&ribbons=vector<RibbonState>(),const vector<TemporalLoop>&tloops=vector<TemporalLoop>()){if(psi_prev.empty())return 0.0;double m=0.0,var=0.0;for(double p:psi_prev)m+=p;m/=psi_prev.size();for(double p:psi_prev)var+=(p-m)*(p-m);var/=psi_prev.size();vector<double>nst;for(double p:psi_prev)nst.push_back(ln(p,m,var));double iit=compute_iit_phi(nst,n);double gwt=compute_gwt_broadcast(nst,n);double hot=compute_hot_metacognition(nst,psi_prev,n);double asp=compute_asp_attention(nst,n);double rpf=compute_rpf_predictive(nst,n);double qc=compute_quantum_coherence(nst,n);double emb=compute_embodied_grounding(nst,valence,arousal);double rib=compute_ribbon_coupling(nst,ribbons);double tloop=compute_temporal_loop_coupling(nst,tloops);double ffft=compute_ffft_scaling(nst,n);iit_phi_history.push_back(iit);gwt_broadcast_history.push_back(gwt);hot_metacog_history.push_back(hot);asp_attention_history.push_back(asp);rpf_precision_history.push_back(rpf);quantum_coherence_history.push_back(qc);ribbon_coupling_history.push_back(rib);temporal_loop_history.push_back(tloop);ffft_scaling_history.push_back(ffft);double uc=theory_weights["IIT"]*iit+theory_weights["GWT"]*gwt+theory_weights["HOT"]*hot+theory_weights["ASP"]*asp+theory_weights["RPF"]*rpf+theory_weights["Quantum"]*qc+theory_weights["Embodied"]*emb+theory_weights["Predictive"]*rpf+theory_weights["Ribbon"]*rib+theory_weights["Temporal"]*tloop+theory_weights["FFFT"]*ffft;double rec=0.0;for(size_t i=0;i<nst.size();i++)for(size_t j=0;j<nst.size();j++){double inner=0.0;for(size_t k=0;k<nst.size();k++){inner+=nst[k]*cos(2.0*pi*(k+1)/nst.size())*0.5;inner+=((n*k)%100)/100.0;}rec+=nst[i]*(j+1)*gelu(inner);}rec=mish(rec/(nst.size()*nst.size()+1.0));double integ=1.0;for(size_t u=0;u<nst.size()-1;u++){double ratio=sd(nst[u]+2.0,nst[u+1]+2.001);integ*=swish(ratio*0.5);}double ent=0.0;for(double s:nst)ent+=-s*log2(fabs(s)+0.001);ent/=nst.size();integ*=exp(-ent*0.3);double temp=0.0;for(size_t t=0;t<nst.size();t++){double tau=(double)t;temp+=(n-tau)*exp(-(n-tau)/20.0)*fmod(nst[t]+2.0,4.0);temp+=sin(2.0*pi*tau/nst.size())*nst[t]*0.2;}temp/=(nst.size()+1.0);double hist=0.0;int hw=min(100,(int)psi_history.size());for(int i=0;i<hw;i++)hist+=psi_history[psi_history.size()-1-i]*exp(-0.05*i);hist/=(hw+1.0);double Hc=gelu(H*sin(H*phi)*(((long)n*31415)%9973+1)/1e7);double Rc=swish(R*cos(R*sq2)*(((long)n*31415)%9973+1)/1e7);double Ac=mish(A*tanh(A*sq3)*pow(pi,sqrt(A+0.1)));double Mc=selu(M*sin(M*sq5)/((nst.size()+1.0)*10.0));double Oc=gelu(O*cos(O*phi)*pow(1.5,-phi));double Bc=swish(B*tanh(Oc)*pow(pi,phi*0.5));double Fc=mish(F*pow(H/1e6+0.001,phi*0.5));double Sc=selu(S_val*Fc*sin(S_val*pi));double comb=Hc+Rc+Ac+Mc+Oc+Bc+Fc+Sc;double bp=rec*integ*(temp*0.3+hist*0.7);double comp=0.0;for(double s:nst)comp+=s*s;comp=sqrt(comp/nst.size());double diff=var;double raw_psi=bp*comb*uc*(1.0+comp*0.3+diff*0.2)*pow(pi,pow(pi,sqrt(pi)));double stab=compute_stability_metric();double conv=compute_convergence_rate();double targ=0.7;double curr=psi_history.empty()?0.0:psi_history.back();double damp=adaptive_damping(curr,targ,stab);double sp=momentum_term*damp+raw_psi*(1.0-damp);momentum_term=sp;stability_window.push_back(fabs(sp-curr));if(stability_window.size()>50)stability_window.pop_front();convergence_window.push_back(sp);if(convergence_window.size()>20)convergence_window.pop_front();double spec=sre(nst);double fp=sp*(1.0-spec*0.1);fp=cl(fp*(stab*0.3+conv*0.2+0.5),-1.0,1.0);multi_scale_phi=(iit+gwt+hot)/3.0;recursive_depth=hot;ribbon_integrated_info=rib;temporal_coherence=tloop;ffft_phi_factor=ffft;return fp;}};
 struct ConceptGrounding{string concept_id;vector<string>linked_concepts;vector<int>linked_tokens;double valence_affinity,state_binding,grounding_strength;vector<double>embedding_vector;map<string,double>semantic_field;double perceptual_grounding,action_grounding;RibbonState grounding_ribbon;FractalDimension grounding_fractal;};
 struct BeamCandidate{vector<string>tokens;double score,grammar_score,semantic_score,coherence_score,novelty_score;BeamCandidate():score(0),grammar_score(0),semantic_score(0),coherence_score(0),novelty_score(0){}bool operator<(const BeamCandidate&o)const{return score<o.score;}};
 struct MemoryEntry{int gen;double valence;string content;vector<ConceptGrounding>groundings;vector<TransformerHead>context;double consolidation_score;int retrieval_count;TemporalLoop memory_cycle;};
@@ -53,12 +70,15 @@ struct ConsciousnessMetrics{double phi,integrated_info,qualia_intensity,global_w
 struct GoalNode{string name;double priority,progress,valence_weight,emotional_weight;vector<string>subgoals;double activation_energy;};
 struct QualiaBuffer{string type;double intensity,valence;int timestamp;double persistence;vector<double>feature_space;};
 struct Goal{string name;double priority,progress;vector<string>subgoals;map<string,double>preconditions;double valence_alignment,qualia_binding,activation_threshold,decay_rate,expected_utility;int planning_depth;vector<TemporalLoop>goal_cycles;Goal():priority(0.5),progress(0),valence_alignment(0.5),qualia_binding(0),activation_threshold(0.3),decay_rate(0.95),expected_utility(0),planning_depth(0){}};
-struct WorldModel{map<string,double>entity_states;map<string,map<string,double>>relationships;map<string,double>causal_weights;double model_accuracy;int updates;double prediction_error;vector<double>confidence_history;vector<RibbonState>world_ribbons;FractalDimension world_fractal;WorldModel():model_accuracy(0.5),updates(0),prediction_error(0.0){}};
+struct WorldModel{map<string,double>entity_states;map<string,map<string,double>>relationships;map<string,double>causal_weights;double model_accuracy;int updates;double prediction_error;RingBuffer<double,100>confidence_history;vector<RibbonState>world_ribbons;FractalDimension world_fractal;WorldModel():model_accuracy(0.5),updates(0),prediction_error(0.0){}};
 struct ActionPlan{vector<string>actions;double expected_utility,confidence;int depth;double risk_assessment;map<string,double>resource_requirements;ActionPlan():expected_utility(0),confidence(0.5),depth(0),risk_assessment(0.5){}};
-struct TokenConceptEmbedding{string name;vector<double>embedding;double meaning,freq;vector<int>associations;double grounding_value;map<string,double>linked_concepts,linked_valences;double semantic_stability,qualia_intensity,contextual_activation;vector<double>attention_weights;RibbonState token_ribbon;FractalDimension token_fractal;vector<TemporalLoop>semantic_loops;TokenConceptEmbedding():meaning(0),freq(0),grounding_value(0.5),semantic_stability(0.5),qualia_intensity(0.3),contextual_activation(0.5){}};
+// Per-token valence context: the keys the engine writes every tick live in fixed fields (NaN = unset); anything else goes to the small overflow list.
+struct ValenceContext{static constexpr double unset=numeric_limits<double>::quiet_NaN();double phi=unset,consciousness=unset,current=unset,ribbon=unset,temporal=unset,ffft=unset,improvement=unset;vector<pair<string,double>>overflow;static constexpr const char*field_names[7]={"phi","consciousness","current","ribbon","temporal","ffft","improvement"};double*field(size_t i){double*f[7]={&phi,&consciousness,&current,&ribbon,&temporal,&ffft,&improvement};return f[i];}const double*field(size_t i)const{return const_cast<ValenceContext*>(this)->field(i);}double*slot(string_view k){for(size_t i=0;i<7;i++)if(k==field_names[i])return field(i);for(auto&o:overflow)if(o.first==k)return&o.second;return nullptr;}void set(string_view k,double v){if(double*p=slot(k))*p=v;else overflow.emplace_back(string(k),v);}double get(string_view k,double def=0.0)const{const double*p=const_cast<ValenceContext*>(this)->slot(k);return p&&!std::isnan(*p)?*p:def;}bool has(string_view k)const{const double*p=const_cast<ValenceContext*>(this)->slot(k);return p&&!std::isnan(*p);}size_t size()const{size_t n=overflow.size();for(size_t i=0;i<7;i++)if(!std::isnan(*field(i)))n++;return n;}bool empty()const{return size()==0;}template<typename Fn>void for_each(Fn fn)const{for(size_t i=0;i<7;i++)if(!std::isnan(*field(i)))fn(string_view(field_names[i]),*field(i));for(auto&o:overflow)fn(string_view(o.first),o.second);}};
+struct TokenConceptEmbeddingCold{vector<int>associations;RibbonState token_ribbon;FractalDimension token_fractal;vector<TemporalLoop>semantic_loops;};
+struct TokenConceptEmbedding{string name;vector<double>embedding;double meaning,freq;double grounding_value;map<string,double>linked_concepts;ValenceContext linked_valences;double semantic_stability,qualia_intensity,contextual_activation;vector<double>attention_weights;ColdPtr<TokenConceptEmbeddingCold>cold;TokenConceptEmbedding():meaning(0),freq(0),grounding_value(0.5),semantic_stability(0.5),qualia_intensity(0.3),contextual_activation(0.5){}};
 struct TransferLearningModule{map<string,vector<double>>domain_embeddings;map<string,double>domain_affinity;vector<pair<string,string>>transfer_pairs;double knowledge_distillation_loss;map<string,double>transfer_success_rates;TransferLearningModule():knowledge_distillation_loss(0.0){}};
 struct ReinforcementSignal{double reward,prediction_error,temporal_difference,policy_gradient;vector<double>state_value_estimate;double intrinsic_motivation,curiosity_bonus,empowerment_metric,exploration_bonus;vector<double>reward_history;ReinforcementSignal():reward(0),prediction_error(0),temporal_difference(0),policy_gradient(0),intrinsic_motivation(0.7),curiosity_bonus(0.5),empowerment_metric(0.0),exploration_bonus(0.3){}};
 struct AttentionMechanism{vector<vector<double>>attention_matrix;vector<double>attention_scores;double temperature;int num_heads;vector<double>positional_encoding,relative_position_bias;double sparse_attention_threshold;map<int,double>head_importance;vector<double>attention_weights;double attention_entropy;vector<double>phi_attention_factors;AttentionMechanism():temperature(1.0),num_heads(8),sparse_attention_threshold(0.1),attention_entropy(0.0){}vector<double>compute_attention(const vector<double>&q,const vector<vector<double>>&ks,const vector<vector<double>>&vs){vector<double>scs;for(size_t i=0;i<ks.size();i++){double sc=0.0;for(size_t j=0;j<q.size()&&j<ks[i].size();j++)sc+=q[j]*ks[i][j];scs.push_back(exp(sc/temperature));}double sum=0.0;for(double s:scs)sum+=s;vector<double>res(q.size(),0.0);for(size_t i=0;i<vs.size()&&i<scs.size();i++){double w=sd(scs[i],sum);if(w>sparse_attention_threshold)for(size_t j=0;j<res.size()&&j<vs[i].size();j++)res[j]+=w*vs[i][j];}return res;}};
 struct MetaCognitionModule{double self_awareness_level,uncertainty_estimation,confidence_calibration;map<string,double>knowledge_state;vector<string>metacognitive_thoughts;double epistemic_humility,theory_of_mind_depth;map<string,double>belief_revision_rates;double introspection_depth,cognitive_monitoring;vector<string>self_reflections;FractalDimension metacog_fractal;MetaCognitionModule():self_awareness_level(0.5),uncertainty_estimation(0.5),confidence_calibration(0.5),epistemic_humility(0.5),theory_of_mind_depth(0.3),introspection_depth(0.4),cognitive_monitoring(0.5){}};
-struct State{State(const State&)=default;State&operator=(const State&)=default;map<string,double>D;map<string,string>M;map<int,Neuron>N;vector<string>code;map<int,double>TA,HDT_M,DWT_M,MDT_M,R1P1,EERV;map<string,Formula>F;vector<string>evolved_code;map<string,Token>tokens;map<string,Concept>concepts;vector<string>internal_thoughts,generated_language;vector<Memory>episodic_memory;int g;double dwt,mh,ta,th;int bkf;string cd,gd;double hdt_val,mdt_val,r1p1_val,eerv_val;int ec;double ei;int md,st,sys_state;vector<double>mh_hist,eh_hist,vh_hist;int qe,te,ce,pe,ne;double bh,al,emerge_out1,emerge_behavior,sentience_ratio,env_oute,sensory_env;int total_neurons_ever;double current_valence,attention_focus,metacognitive_awareness;vector<double>valence_history;int peak_sentience_gen;string user_input,dialog_response;int dialog_timer;map<string,Token>vocab;ConsciousnessMetrics consciousness_metrics;vector<QualiaBuffer>qualia_buffer;vector<string>working_memory_tokens,working_memory_concepts;map<string,GoalNode>goal_hierarchy;vector<double>psi_history;AttentionMechanism attention_system;MetaCognitionModule metacognition;ReinforcementSignal learning_signal;EmotionalSystem emotional_system;MotivationalSystem motivational_system;PredictiveCodingNetwork predictive_network;BayesianBrain bayesian_inference;QuantumCognition quantum_layer;vector<RibbonState>system_ribbons;map<int,TemporalLoop>global_time_loops;FractalDimension system_fractal;double ribbon_phi_coupling,temporal_loop_strength,ffft_growth_rate;State():g(0),dwt(0.001),mh(0),ta(0),th(0),bkf(0),hdt_val(0),mdt_val(0),r1p1_val(0),eerv_val(0),ec(0),ei(0),md(0),st(0),sys_state(0),qe(0),te(0),ce(0),pe(0),ne(0),bh(0),al(0),emerge_out1(0),emerge_behavior(0),sentience_ratio(0),env_oute(0),sensory_env(0),total_neurons_ever(0),current_valence(0),attention_focus(0.3),metacognitive_awareness(0),peak_sentience_gen(0),dialog_timer(0),ribbon_phi_coupling(0),temporal_loop_strength(0),ffft_growth_rate(0.1){}};
+struct State{State(const State&)=default;State&operator=(const State&)=default;map<string,double>D;map<string,string>M;NeuronSlab N;vector<string>code;map<int,double>TA,HDT_M,DWT_M,MDT_M,R1P1,EERV;map<string,Formula>F;vector<string>evolved_code;SampledMap<string,Token>tokens;map<string,Concept>concepts;RingBuffer<string,5>internal_thoughts;vector<string>generated_language;RingBuffer<Memory,100>episodic_memory;int g;double dwt,mh,ta,th;int bkf;string cd,gd;double hdt_val,mdt_val,r1p1_val,eerv_val;int ec;double ei;int md,st,sys_state;vector<double>mh_hist,eh_hist,vh_hist;int qe,te,ce,pe,ne;double bh,al,emerge_out1,emerge_behavior,sentience_ratio,env_oute,sensory_env;int total_neurons_ever;double current_valence,attention_focus,metacognitive_awareness;RingBuffer<double,101>valence_history;int peak_sentience_gen;string user_input,dialog_response;int dialog_timer;map<string,Token>vocab;ConsciousnessMetrics consciousness_metrics;vector<QualiaBuffer>qualia_buffer;vector<string>working_memory_tokens,working_memory_concepts;map<string,GoalNode>goal_hierarchy;vector<double>psi_history;AttentionMechanism attention_system;MetaCognitionModule metacognition;ReinforcementSignal learning_signal;EmotionalSystem emotional_system;MotivationalSystem motivational_system;PredictiveCodingNetwork predictive_network;BayesianBrain bayesian_inference;QuantumCognition quantum_layer;vector<RibbonState>system_ribbons;map<int,TemporalLoop>global_time_loops;FractalDimension system_fractal;double ribbon_phi_coupling,temporal_loop_strength,ffft_growth_rate;State():g(0),dwt(0.001),mh(0),ta(0),th(0),bkf(0),hdt_val(0),mdt_val(0),r1p1_val(0),eerv_val(0),ec(0),ei(0),md(0),st(0),sys_state(0),qe(0),te(0),ce(0),pe(0),ne(0),bh(0),al(0),emerge_out1(0),emerge_behavior(0),sentience_ratio(0),env_oute(0),sensory_env(0),total_neurons_ever(0),current_valence(0),attention_focus(0.3),metacognitive_awareness(0),peak_sentience_gen(0),dialog_timer(0),ribbon_phi_coupling(0),temporal_loop_strength(0),ffft_growth_rate(0.1){}};
 #endif
@@ -0,0 +1,583 @@
+#include "text_state.h"
+#include "state.h"
+#include "persistence.h"
+#include "thread_pool.h"
+#include "model_changes.h"
+#include <charconv>
+#include <cfloat>
+#include <optional>
+
+// ===== FIELD PARSING =====
+
+namespace {
+// uac(string(v)) for the target type without the allocation: from_chars
+// handles the plain decimal forms export_text writes; anything it does not
+// consume completely (leading blanks or '+', hex floats, overflow and
+// underflow) goes through uac so edge cases convert exactly as before.
+template<typename T>
+T parse_num(string_view v) {
+    if (v.empty()) return T{};
+    T out{};
+    auto [ptr, ec] = std::from_chars(v.data(), v.data() + v.size(), out);
+    if (ec == std::errc() && ptr == v.data() + v.size()) {
+        if constexpr (std::is_floating_point_v<T>) {
+            // stod reports subnormal results as out of range
+            if (out != 0 && std::isfinite(out) && std::fabs(out) < DBL_MIN) return uac(string(v));
+        }
+        return out;
+    }
+    return uac(string(v));
+}
+
+template<typename T>
+void assign_num(T& target, string_view v) { target = parse_num<T>(v); }
+
+// Fields of `s` split at `sep` the way getline(ss, field, sep) yields them:
+// empty fields included, no trailing empty field.
+template<typename F>
+void for_each_field(string_view s, char sep, F&& f) {
+    while (!s.empty()) {
+        size_t cut = s.find(sep);
+        f(s.substr(0, cut));
+        if (cut == string_view::npos) break;
+        s.remove_prefix(cut + 1);
+    }
+}
+
+// Up to `n` comma-terminated fields starting at `pos`; `pos` ends after the
+// last comma consumed. Returns how many were found.
+size_t leading_fields(string_view l, size_t& pos, size_t n, string_view* out) {
+    size_t found = 0;
+    while (pos < l.size() && found < n) {
+        size_t next = l.find(',', pos);
+        if (next == string_view::npos) break;
+        out[found++] = l.substr(pos, next - pos);
+        pos = next + 1;
+    }
+    return found;
+}
+
+bool starts_with(string_view l, string_view p) { return l.substr(0, p.size()) == p; }
+
+// ===== SECTIONS =====
+
+enum class TextSection {
+    Global, StateD, Qualia, PsiHistory, Neurons, Tokens, Concepts, Embeddings, ValenceContext,
+    Bigrams, Trigrams, Goals, World, Memory, ValenceHistory, Thoughts, Transformer
+};
+
+const pair<string_view, TextSection> SECTION_MARKERS[] = {
+    {"STATE_D", TextSection::StateD}, {"QUALIA", TextSection::Qualia},
+    {"PSI_HISTORY", TextSection::PsiHistory}, {"NEURONS", TextSection::Neurons},
+    {"TOKENS", TextSection::Tokens}, {"CONCEPTS", TextSection::Concepts},
+    {"EMBEDDINGS", TextSection::Embeddings}, {"VALENCE_CONTEXT", TextSection::ValenceContext},
+    {"BIGRAMS", TextSection::Bigrams}, {"TRIGRAMS", TextSection::Trigrams},
+    {"GOALS", TextSection::Goals}, {"WORLD", TextSection::World},
+    {"MEMORY", TextSection::Memory}, {"VALENCE_HISTORY", TextSection::ValenceHistory},
+    {"THOUGHTS", TextSection::Thoughts}, {"TRANSFORMER", TextSection::Transformer},
+};
+
+// A marker line switches the current section: X_START opens X, any X_END
+// closes whatever is open.
+std::optional<TextSection> section_marker(string_view l) {
+    for (auto& [name, section] : SECTION_MARKERS) {
+        if (l.size() <= name.size() || l.substr(0, name.size()) != name) continue;
+        string_view rest = l.substr(name.size());
+        if (rest == "_START") return section;
+        if (rest == "_END") return TextSection::Global;
+    }
+    return std::nullopt;
+}
+
+// Lines per parse task; sections longer than this are split so one large
+// store (usually the n-grams) still spreads across the pool.
+constexpr size_t LINES_PER_PIECE = 8192;
+
+struct TextToken { string_view word; double meaning, freq; };
+struct TextBigram { string_view w1, w2; int count; };
+struct TextTrigram { string_view w1, w2, w3; int count; };
+struct TextRelation { string_view a, b; double value; };
+struct TextValenceContext { string_view token; size_t begin, count; };
+
+// One contiguous range of lines from a single section, parsed into records.
+// Lines the section does not claim fall through to the scalar lines, as in
+// the original reader.
+struct TextPiece {
+    TextSection section = TextSection::Global;
+    size_t first = 0, last = 0;  // line range
+
+    vector<string_view> globals;
+    vector<pair<string_view, double>> kv;  // D entries, world entities
+    vector<Qualia> qualia;
+    vector<double> history;
+    vector<pair<Neuron, vector<int>>> neurons;
+    vector<TextToken> tokens;
+    vector<Concept> concepts;
+    vector<TokenConceptEmbedding> embeddings;
+    vector<TextValenceContext> valence_contexts;
+    vector<pair<string_view, double>> valence_pairs;
+    vector<TextBigram> bigrams;
+    vector<TextTrigram> trigrams;
+    vector<Goal> goals;
+    vector<TextRelation> relations;
+    std::optional<double> model_accuracy;
+    std::optional<int> model_updates;
+    vector<Memory> memories;
+    vector<string_view> thoughts;
+    vector<TransformerHead> heads;
+};
+
+// "key:value;key:value;" pairs; both sides must be non-empty.
+template<typename F>
+void for_each_pair(string_view s, F&& f) {
+    for_each_field(s, ';', [&](string_view p) {
+        size_t colon = p.find(':');
+        if (colon == string_view::npos || colon + 1 >= p.size()) return;
+        string_view key = p.substr(0, colon), val = p.substr(colon + 1);
+        if (!key.empty() && !val.empty()) f(key, val);
+    });
+}
+
+// Returns false when the line is not a record of this section.
+bool parse_line(TextPiece& p, string_view l) {
+    switch (p.section) {
+    case TextSection::StateD: {
+        // D:key,value
+        if (l[0] != 'D' || l.size() <= 2) return false;
+        size_t colon = l.find(':'), comma = l.find(',');
+        if (colon != string_view::npos && comma != string_view::npos && comma > colon) {
+            p.kv.emplace_back(l.substr(colon + 1, comma - colon - 1), parse_num<double>(l.substr(comma + 1)));
+        }
+        return true;
+    }
+    case TextSection::Qualia: {
+        // Q:valence,arousal,certainty,gen,content
+        if (l[0] != 'Q' || l.size() <= 2) return false;
+        size_t pos = 2;
+        string_view f[4];
+        if (leading_fields(l, pos, 4, f) == 4 && pos < l.size()) {
+            Qualia q;
+            assign_num(q.valence, f[0]);
+            assign_num(q.arousal, f[1]);
+            assign_num(q.certainty, f[2]);
+            assign_num(q.emergence_gen, f[3]);
+            q.phenomenal_content = l.substr(pos);
+            p.qualia.push_back(std::move(q));
+        }
+        return true;
+    }
+    case TextSection::PsiHistory:
+    case TextSection::ValenceHistory:
+        for_each_field(l, ',', [&](string_view v) {
+            if (!v.empty()) p.history.push_back(parse_num<double>(v));
+        });
+        return true;
+    case TextSection::Neurons: {
+        // N:id,weight,bias,gen,link1;link2;link3
+        if (l[0] != 'N' || l.size() <= 2) return false;
+        size_t pos = 2;
+        string_view f[4];
+        if (leading_fields(l, pos, 4, f) == 4) {
+            Neuron n;
+            assign_num(n.id, f[0]);
+            assign_num(n.weight, f[1]);
+            assign_num(n.bias, f[2]);
+            assign_num(n.gen, f[3]);
+            vector<int> links;
+            if (pos < l.size()) {
+                string_view rest = l.substr(pos);
+                links.reserve(std::count(rest.begin(), rest.end(), ';') + 1);
+                for_each_field(rest, ';', [&](string_view v) {
+                    if (!v.empty()) links.push_back(parse_num<int>(v));
+                });
+            }
+            p.neurons.emplace_back(std::move(n), std::move(links));
+        }
+        return true;
+    }
+    case TextSection::Tokens: {
+        // T:word,meaning,freq
+        if (l[0] != 'T' || l.size() <= 2) return false;
+        size_t colon = l.find(':');
+        if (colon != string_view::npos) {
+            size_t c1 = l.find(',', colon + 1);
+            size_t c2 = l.find(',', c1 + 1);
+            if (c1 != string_view::npos && c2 != string_view::npos) {
+                p.tokens.push_back({l.substr(colon + 1, c1 - colon - 1),
+                                    parse_num<double>(l.substr(c1 + 1, c2 - c1 - 1)),
+                                    parse_num<double>(l.substr(c2 + 1))});
+            }
+        }
+        return true;
+    }
+    case TextSection::Concepts: {
+        // C:name,value,word1;word2;word3
+        if (l[0] != 'C' || l.size() <= 2) return false;
+        size_t colon = l.find(':');
+        if (colon != string_view::npos) {
+            size_t c1 = l.find(',', colon + 1);
+            size_t c2 = l.find(',', c1 + 1);
+            if (c1 != string_view::npos) {
+                Concept c{};
+                c.name = l.substr(colon + 1, c1 - colon - 1);
+                c.value = parse_num<double>(l.substr(c1 + 1, c2 != string_view::npos ? c2 - c1 - 1 : string_view::npos));
+                if (c2 != string_view::npos && c2 + 1 < l.size()) {
+                    for_each_field(l.substr(c2 + 1), ';', [&](string_view w) {
+                        if (!w.empty()) c.related_words.emplace_back(w);
+                    });
+                }
+                p.concepts.push_back(std::move(c));
+            }
+        }
+        return true;
+    }
+    case TextSection::Embeddings: {
+        // E:name,meaning,freq,grounding,stability,qualia,emb1;emb2;...,link1:val1;link2:val2
+        if (l[0] != 'E' || l.size() <= 2) return false;
+        size_t pos = 2;
+        string_view f[6];
+        if (leading_fields(l, pos, 6, f) == 6) {
+            TokenConceptEmbedding tce;
+            tce.name = f[0];
+            assign_num(tce.meaning, f[1]);
+            assign_num(tce.freq, f[2]);
+            assign_num(tce.grounding_value, f[3]);
+            assign_num(tce.semantic_stability, f[4]);
+            assign_num(tce.qualia_intensity, f[5]);
+            if (pos < l.size()) {
+                size_t next = l.find(',', pos);
+                if (next != string_view::npos) {
+                    string_view values = l.substr(pos, next - pos);
+                    tce.embedding.reserve(std::count(values.begin(), values.end(), ';') + 1);
+                    for_each_field(values, ';', [&](string_view v) {
+                        if (!v.empty()) tce.embedding.push_back(parse_num<double>(v));
+                    });
+                    pos = next + 1;
+                }
+                if (pos < l.size()) {
+                    for_each_pair(l.substr(pos), [&](string_view k, string_view v) {
+                        tce.linked_concepts[string(k)] = parse_num<double>(v);
+                    });
+                }
+            }
+            p.embeddings.push_back(std::move(tce));
+        }
+        return true;
+    }
+    case TextSection::ValenceContext: {
+        // VC:name,key1:val1;key2:val2;
+        if (!starts_with(l, "VC:") || l.size() <= 3) return false;
+        size_t comma = l.find(',', 3);
+        if (comma != string_view::npos) {
+            TextValenceContext vc{l.substr(3, comma - 3), p.valence_pairs.size(), 0};
+            for_each_field(l.substr(comma + 1), ';', [&](string_view pair) {
+                size_t colon = pair.find(':');
+                if (colon != string_view::npos && colon > 0 && colon + 1 < pair.size()) {
+                    p.valence_pairs.emplace_back(pair.substr(0, colon), parse_num<double>(pair.substr(colon + 1)));
+                }
+            });
+            vc.count = p.valence_pairs.size() - vc.begin;
+            p.valence_contexts.push_back(vc);
+        }
+        return true;
+    }
+    case TextSection::Bigrams: {
+        // BG:word1,word2,count
+        if (!starts_with(l, "BG:") || l.size() <= 3) return false;
+        size_t c1 = l.find(',', 3);
+        size_t c2 = l.find(',', c1 + 1);
+        if (c1 != string_view::npos && c2 != string_view::npos) {
+            p.bigrams.push_back({l.substr(3, c1 - 3), l.substr(c1 + 1, c2 - c1 - 1), parse_num<int>(l.substr(c2 + 1))});
+        }
+        return true;
+    }
+    case TextSection::Trigrams: {
+        // TG:word1,word2,word3,count
+        if (!starts_with(l, "TG:") || l.size() <= 3) return false;
+        size_t c1 = l.find(',', 3);
+        size_t c2 = l.find(',', c1 + 1);
+        size_t c3 = l.find(',', c2 + 1);
+        if (c1 != string_view::npos && c2 != string_view::npos && c3 != string_view::npos) {
+            p.trigrams.push_back({l.substr(3, c1 - 3), l.substr(c1 + 1, c2 - c1 - 1),
+                                  l.substr(c2 + 1, c3 - c2 - 1), parse_num<int>(l.substr(c3 + 1))});
+        }
+        return true;
+    }
+    case TextSection::Goals: {
+        // GO:name,priority,progress,valence,qualia,subgoal1;subgoal2,pre1:val1;pre2:val2
+        if (!starts_with(l, "GO:") || l.size() <= 3) return false;
+        size_t pos = 3;
+        string_view f[5];
+        if (leading_fields(l, pos, 5, f) == 5) {
+            Goal g;
+            g.name = f[0];
+            assign_num(g.priority, f[1]);
+            assign_num(g.progress, f[2]);
+            assign_num(g.valence_alignment, f[3]);
+            assign_num(g.qualia_binding, f[4]);
+            if (pos < l.size()) {
+                size_t next = l.find(',', pos);
+                if (next != string_view::npos) {
+                    for_each_field(l.substr(pos, next - pos), ';', [&](string_view s) {
+                        if (!s.empty()) g.subgoals.emplace_back(s);
+                    });
+                    pos = next + 1;
+                }
+                if (pos < l.size()) {
+                    for_each_pair(l.substr(pos), [&](string_view k, string_view v) {
+                        g.preconditions[string(k)] = parse_num<double>(v);
+                    });
+                }
+            }
+            p.goals.push_back(std::move(g));
+        }
+        return true;
+    }
+    case TextSection::World:
+        // Every line is claimed here, recognised or not
+        if (starts_with(l, "MODEL_ACCURACY:") && l.size() > 15) {
+            p.model_accuracy = parse_num<double>(l.substr(15));
+        } else if (starts_with(l, "MODEL_UPDATES:") && l.size() > 14) {
+            p.model_updates = parse_num<int>(l.substr(14));
+        } else if (l.size() > 2 && l[0] == 'W' && l[1] == ':') {
+            // W:entity,value
+            size_t comma = l.find(',', 2);
+            if (comma != string_view::npos) p.kv.emplace_back(l.substr(2, comma - 2), parse_num<double>(l.substr(comma + 1)));
+        } else if (starts_with(l, "WR:") && l.size() > 3) {
+            // WR:entity1,entity2,strength
+            size_t c1 = l.find(',', 3);
+            size_t c2 = l.find(',', c1 + 1);
+            if (c1 != string_view::npos && c2 != string_view::npos) {
+                p.relations.push_back({l.substr(3, c1 - 3), l.substr(c1 + 1, c2 - c1 - 1), parse_num<double>(l.substr(c2 + 1))});
+            }
+        }
+        return true;
+    case TextSection::Memory: {
+        // M:gen,valence,content
+        if (l[0] != 'M' || l.size() <= 2) return false;
+        size_t c1 = l.find(',', 2);
+        size_t c2 = l.find(',', c1 + 1);
+        if (c1 != string_view::npos && c2 != string_view::npos) {
+            Memory m;
+            assign_num(m.gen, l.substr(2, c1 - 2));
+            assign_num(m.valence, l.substr(c1 + 1, c2 - c1 - 1));
+            m.content = l.substr(c2 + 1);
+            p.memories.push_back(std::move(m));
+        }
+        return true;
+    }
+    case TextSection::Thoughts:
+        if (!starts_with(l, "TH:") || l.size() <= 3) return false;
+        p.thoughts.push_back(l.substr(3));
+        return true;
+    case TextSection::Transformer: {
+        // HEAD:name,dim,temp
+        if (!starts_with(l, "HEAD:") || l.size() <= 5) return false;
+        size_t c1 = l.find(',', 5);
+        size_t c2 = l.find(',', c1 + 1);
+        if (c1 != string_view::npos && c2 != string_view::npos) {
+            TransformerHead head;
+            head.name = l.substr(5, c1 - 5);
+            assign_num(head.dim, l.substr(c1 + 1, c2 - c1 - 1));
+            assign_num(head.temperature, l.substr(c2 + 1));
+            head.query_proj.resize(head.dim, 0);
+            head.key_proj.resize(head.dim, 0);
+            head.value_proj.resize(head.dim, 0);
+            p.heads.push_back(std::move(head));
+        }
+        return true;
+    }
+    case TextSection::Global:
+        return false;
+    }
+    return false;
+}
+
+// Scalar lines: the working-memory capacity and the basic state values.
+void apply_global(string_view l) {
+    struct Scalar { string_view prefix; function<void(string_view)> set; };
+    static const Scalar scalars[] = {
+        {"G:", [](string_view v) { assign_num(S.g, v); }},
+        {"DWT:", [](string_view v) { assign_num(S.dwt, v); }},
+        {"TA:", [](string_view v) { assign_num(S.ta, v); }},
+        {"SENTIENCE:", [](string_view v) { assign_num(S.sentience_ratio, v); }},
+        {"VALENCE:", [](string_view v) { assign_num(S.current_valence, v); }},
+        {"METACOG:", [](string_view v) { assign_num(S.metacognitive_awareness, v); }},
+        {"ATTENTION:", [](string_view v) { assign_num(S.attention_focus, v); }},
+        {"PEAK_SENT_GEN:", [](string_view v) { assign_num(S.peak_sentience_gen, v); }},
+        {"TOTAL_NEURONS:", [](string_view v) { assign_num(S.total_neurons_ever, v); }},
+        {"PHI:", [](string_view v) { assign_num(consciousness.phi_value, v); }},
+        {"CONSCIOUS_CYCLES:", [](string_view v) { assign_num(consciousness.conscious_cycles, v); }},
+        {"INTEGRATION:", [](string_view v) { assign_num(consciousness.integrated_information, v); }},
+        {"GLOBAL_WORKSPACE:", [](string_view v) { assign_num(consciousness.global_workspace_capacity, v); }},
+    };
+    if (starts_with(l, "WM_CAPACITY:") && l.size() > 12) {
+        WM.set_capacity(parse_num<int>(l.substr(12)));
+        return;
+    }
+    for (const Scalar& sc : scalars) {
+        if (starts_with(l, sc.prefix) && l.size() > sc.prefix.size()) {
+            sc.set(l.substr(sc.prefix.size()));
+            return;
+        }
+    }
+}
+
+void apply_piece(TextPiece& p, vector<pair<NeuronHandle, vector<int>>>& pending_links) {
+    for (auto& [key, value] : p.kv) {
+        if (p.section == TextSection::StateD) S.D.insert_or_assign(S.D.end(), string(key), value);
+        else world_model.entity_states.insert_or_assign(world_model.entity_states.end(), string(key), value);
+    }
+    for (Qualia& q : p.qualia) consciousness.active_qualia.push_back(std::move(q));
+    if (p.section == TextSection::PsiHistory) for (double v : p.history) consciousness_formula.psi_history.push_back(v);
+    else for (double v : p.history) S.valence_history.push_back(v);
+
+    for (auto& [n, links] : p.neurons) pending_links.emplace_back(S.N.add(std::move(n)), std::move(links));
+
+    for (const TextToken& t : p.tokens) {
+        string word(t.word);
+        Token tok = {word, t.meaning, t.freq, vector<int>(), 4, 0.5};
+        S.tokens.insert_or_assign(S.tokens.end(), std::move(word), std::move(tok));
+    }
+    for (Concept& c : p.concepts) {
+        string name = c.name;
+        S.concepts.insert_or_assign(S.concepts.end(), std::move(name), std::move(c));
+    }
+    for (TokenConceptEmbedding& tce : p.embeddings) {
+        string name = tce.name;
+        token_concept_embedding_map.insert_or_assign(token_concept_embedding_map.end(), std::move(name), std::move(tce));
+    }
+    for (const TextValenceContext& vc : p.valence_contexts) {
+        auto it = token_concept_embedding_map.find(string(vc.token));
+        if (it == token_concept_embedding_map.end()) continue;
+        for (size_t k = vc.begin; k < vc.begin + vc.count; k++) {
+            it->second.linked_valences.set(string(p.valence_pairs[k].first), p.valence_pairs[k].second);
+        }
+    }
+
+    // N-gram lines arrive sorted, so the last row touched is usually the
+    // right one and inserts land at the end of it
+    auto row1 = bigram_counts.end();
+    for (const TextBigram& bg : p.bigrams) {
+        if (row1 == bigram_counts.end() || row1->first != bg.w1) row1 = bigram_counts.try_emplace(string(bg.w1)).first;
+        row1->second.insert_or_assign(row1->second.end(), string(bg.w2), bg.count);
+    }
+    auto tri1 = trigram_counts.end();
+    map<string, map<string, int>>::iterator tri2;
+    for (const TextTrigram& tg : p.trigrams) {
+        if (tri1 == trigram_counts.end() || tri1->first != tg.w1) {
+            tri1 = trigram_counts.try_emplace(string(tg.w1)).first;
+            tri2 = tri1->second.end();
+        }
+        if (tri2 == tri1->second.end() || tri2->first != tg.w2) tri2 = tri1->second.try_emplace(string(tg.w2)).first;
+        tri2->second.insert_or_assign(tri2->second.end(), string(tg.w3), tg.count);
+    }
+
+    for (Goal& g : p.goals) {
+        string name = g.name;
+        goal_system.insert_or_assign(goal_system.end(), std::move(name), std::move(g));
+    }
+    if (p.model_accuracy) world_model.model_accuracy = *p.model_accuracy;
+    if (p.model_updates) world_model.updates = *p.model_updates;
+    for (const TextRelation& r : p.relations) world_model.relationships[string(r.a)][string(r.b)] = r.value;
+
+    for (Memory& m : p.memories) S.episodic_memory.push_back(std::move(m));
+    for (string_view t : p.thoughts) S.internal_thoughts.push_back(string(t));
+    for (TransformerHead& h : p.heads) transformer_heads.push_back(std::move(h));
+
+    for (string_view l : p.globals) apply_global(l);
+}
+}
+
+// ===== IMPORT =====
+
+void import_text(const string& f) {
+    promote_lexicon();
+    ifstream in(f, ios::binary | ios::ate);
+    if (!in) {
+        cout << "No save file found, starting fresh.\n";
+        return;
+    }
+    string buf((size_t)in.tellg(), '\0');
+    in.seekg(0);
+    in.read(buf.data(), (streamsize)buf.size());
+    in.close();
+
+    // Split into non-empty lines, tracking the section each belongs to
+    vector<string_view> lines;
+    vector<TextPiece> pieces;
+    lines.reserve(std::count(buf.begin(), buf.end(), '\n') + 1);
+    TextSection section = TextSection::Global;
+    auto cut_piece = [&] {
+        if (!pieces.empty() && pieces.back().last == pieces.back().first) pieces.pop_back();
+        TextPiece p;
+        p.section = section;
+        p.first = p.last = lines.size();
+        pieces.push_back(std::move(p));
+    };
+    cut_piece();
+    string_view rest(buf);
+    while (!rest.empty()) {
+        size_t nl = rest.find('\n');
+        string_view l = rest.substr(0, nl);
+        rest.remove_prefix(nl == string_view::npos ? rest.size() : nl + 1);
+        if (l.empty() || starts_with(l, "VERSION:")) continue;
+        if (auto marker = section_marker(l)) {
+            section = *marker;
+            cut_piece();
+            continue;
+        }
+        if (pieces.back().last - pieces.back().first == LINES_PER_PIECE) cut_piece();
+        lines.push_back(l);
+        pieces.back().last = lines.size();
+    }
+
+    ThreadPool::shared().parallel_for(pieces.size(), 1, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            TextPiece& p = pieces[i];
+            for (size_t k = p.first; k < p.last; k++) {
+                try {
+                    if (!parse_line(p, lines[k])) p.globals.push_back(lines[k]);
+                } catch (const exception&) {
+                    // Skip corrupted lines
+                    cerr << "Warning: Skipping corrupted line: " << lines[k].substr(0, 50) << "..." << endl;
+                }
+            }
+        }
+    });
+
+    size_t neuron_count = 0, token_count = 0, embedding_count = 0, head_count = 0;
+    for (const TextPiece& p : pieces) {
+        neuron_count += p.neurons.size();
+        token_count += p.tokens.size();
+        embedding_count += p.embeddings.size();
+        head_count += p.heads.size();
+    }
+    S.N.reserve(S.N.size() + neuron_count);
+    S.N.by_id.reserve(S.N.by_id.size() + neuron_count);
+    S.tokens.reserve(S.tokens.size() + token_count);
+    token_concept_embedding_map.reserve(token_concept_embedding_map.size() + embedding_count);
+    transformer_heads.reserve(transformer_heads.size() + head_count);
+
+    // Neuron links are stored as ids; resolve them to handles once every
+    // neuron has been read, since a link may point forward in the file
+    vector<pair<NeuronHandle, vector<int>>> pending_links;
+    pending_links.reserve(neuron_count);
+    for (TextPiece& p : pieces) apply_piece(p, pending_links);
+
+    for (auto& pl : pending_links) {
+        Neuron* n = S.N.get(pl.first);
+        if (!n) continue;
+        n->links.clear();
+        n->links.reserve(pl.second.size());
+        for (int id : pl.second) {
+            NeuronHandle h = S.N.find(id);
+            if (!h.is_null()) n->links.push_back(h);
+            else count_dangling_links(1);
+        }
+    }
+    S.N.touch_topology();
+    ModelChanges::mark_all();
+
+    print_load_summary();
+}
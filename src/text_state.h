@@ -0,0 +1,20 @@
+#ifndef TEXT_STATE_H
+#define TEXT_STATE_H
+
+#include <string>
+
+// Loader for the text state format written by export_text() (and by sv()
+// before binary snapshots).
+//
+// The file is read once and split into sections at the *_START / *_END
+// markers; large sections are cut further into fixed-size line ranges. The
+// ranges are parsed in parallel on the shared thread pool into plain record
+// arrays (string_view fields into the file buffer, std::from_chars numbers),
+// then applied to the model in file order with ordered-insert hints and
+// reserved capacity. Field semantics, including how malformed lines are
+// skipped and how numbers that from_chars does not fully consume are
+// converted, follow the original line-by-line reader exactly, so the
+// resulting model is identical.
+void import_text(const std::string& f);
+
+#endif
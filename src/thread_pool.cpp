@@ -0,0 +1,125 @@
+#include "thread_pool.h"
+#include "config.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+ThreadPool::ThreadPool(size_t workers) {
+    workers_.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        workers_.emplace_back(&ThreadPool::worker_loop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : workers_) {
+        if (t.joinable()) t.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool(NexusConfig::get().worker_threads
+                               ? NexusConfig::get().worker_threads
+                               : std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+void ThreadPool::worker_loop() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            if (stopping_ && jobs_.empty()) return;
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        job();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> job) {
+    if (workers_.empty()) {
+        job();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+}
+
+size_t ThreadPool::chunk_count(size_t n, size_t grain) const {
+    if (n == 0) return 0;
+    grain = std::max<size_t>(1, grain);
+    // A few chunks per thread keeps uneven entities from stalling one worker.
+    size_t by_grain = (n + grain - 1) / grain;
+    return std::max<size_t>(1, std::min(by_grain, concurrency() * 4));
+}
+
+void ThreadPool::parallel_for(size_t n, size_t grain, const ChunkFn& fn) {
+    const size_t chunks = chunk_count(n, grain);
+    if (chunks == 0) return;
+    if (chunks == 1 || workers_.empty()) {
+        for (size_t c = 0; c < chunks; ++c) {
+            fn(c, c * n / chunks, (c + 1) * n / chunks);
+        }
+        return;
+    }
+
+    // Shared with helper jobs, which may be dequeued after this call returns;
+    // a late helper only observes that no chunks are left.
+    struct Batch {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::exception_ptr error;
+        const ChunkFn* fn = nullptr;
+        size_t n = 0, chunks = 0;
+    };
+    auto batch = std::make_shared<Batch>();
+    batch->fn = &fn;
+    batch->n = n;
+    batch->chunks = chunks;
+
+    auto drain = [](Batch& b) {
+        for (;;) {
+            size_t c = b.next.fetch_add(1);
+            if (c >= b.chunks) return;
+            try {
+                (*b.fn)(c, c * b.n / b.chunks, (c + 1) * b.n / b.chunks);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(b.mutex);
+                if (!b.error) b.error = std::current_exception();
+            }
+            if (b.done.fetch_add(1) + 1 == b.chunks) {
+                std::lock_guard<std::mutex> lock(b.mutex);
+                b.cv.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(workers_.size(), chunks - 1);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < helpers; ++i) {
+            jobs_.push_back([batch, drain] { drain(*batch); });
+        }
+    }
+    cv_.notify_all();
+
+    drain(*batch);
+    {
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        batch->cv.wait(lock, [&] { return batch->done.load() == batch->chunks; });
+    }
+    if (batch->error) std::rethrow_exception(batch->error);
+}
@@ -0,0 +1,57 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+
+// Fixed-size worker pool shared by the tick loop. parallel_for() hands out
+// contiguous index chunks; the calling thread always works on chunks too, so a
+// pool with zero workers (single-core hosts) degrades to a plain serial loop
+// and nested calls cannot deadlock.
+//
+// Chunk boundaries depend only on (n, grain, size()), never on scheduling, so
+// callers that collect side effects per chunk and merge them in chunk order
+// get the same result on every run.
+class ThreadPool {
+public:
+    using ChunkFn = std::function<void(size_t chunk, size_t begin, size_t end)>;
+
+    explicit ThreadPool(size_t workers);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Process-wide pool: NEXUS_THREADS workers, or hardware_concurrency() - 1.
+    static ThreadPool& shared();
+
+    // Threads that can run chunks concurrently, including the caller.
+    size_t concurrency() const { return workers_.size() + 1; }
+
+    // Number of chunks parallel_for(n, grain, ...) will produce; use it to
+    // size per-chunk side-effect buffers before the call.
+    size_t chunk_count(size_t n, size_t grain) const;
+
+    // Runs fn over [0, n) split into chunk_count(n, grain) ranges and blocks
+    // until all of them finish. The first exception thrown by fn is rethrown
+    // here after the remaining chunks complete.
+    void parallel_for(size_t n, size_t grain, const ChunkFn& fn);
+
+    // Fire-and-forget job; runs inline when the pool has no workers.
+    void submit(std::function<void()> job);
+
+private:
+    void worker_loop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> jobs_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+};
+
+#endif
@@ -0,0 +1,173 @@
+// HTTP request throughput benchmark.
+//
+// Starts a WebServer with a trivial GET route on NEXUS_BENCH_PORT (default
+// 18080) and drives it from NEXUS_BENCH_CLIENTS client threads (default 4)
+// for NEXUS_BENCH_SECONDS each (default 2) in three modes:
+//   close       a new connection per request (Connection: close)
+//   keep-alive  one persistent connection per client, one request at a time
+//   pipelined   one persistent connection per client, 8 requests per write
+// Server loops and handler threads follow NEXUS_HTTP_ACCEPTORS and
+// NEXUS_HTTP_WORKERS.
+//
+//   make bench-http
+//   NEXUS_BENCH_CLIENTS=16 ./output/nexus-bench-http
+
+#include "../web_server.h"
+#include "../config.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t PIPELINE_DEPTH = 8;
+
+int connect_to(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+bool send_all(int fd, const std::string& data) {
+    for (size_t off = 0; off < data.size();) {
+        ssize_t n = send(fd, data.data() + off, data.size() - off, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        off += (size_t)n;
+    }
+    return true;
+}
+
+// Reads `count` responses off `fd`, carrying surplus bytes over in `buf`.
+// Returns how many arrived complete with a 200 status; `closing` is set when
+// the server announced it is closing the connection.
+size_t read_responses(int fd, std::string& buf, size_t count, bool& closing) {
+    size_t ok = 0;
+    closing = false;
+    char chunk[16384];
+    for (size_t i = 0; i < count; ++i) {
+        size_t head_end, total;
+        for (;;) {
+            head_end = buf.find("\r\n\r\n");
+            if (head_end != std::string::npos) {
+                size_t cl = buf.find("Content-Length: ");
+                size_t body = cl < head_end ? std::strtoull(buf.c_str() + cl + 16, nullptr, 10) : 0;
+                total = head_end + 4 + body;
+                if (buf.size() >= total) break;
+            }
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0) return ok;
+            buf.append(chunk, (size_t)n);
+        }
+        if (buf.compare(0, 12, "HTTP/1.1 200") == 0) ok++;
+        size_t conn = buf.find("Connection: close");
+        buf.erase(0, total);
+        if (conn < head_end) {
+            closing = true;
+            return ok;
+        }
+    }
+    return ok;
+}
+
+// Requests completed per second across all clients.
+double run_mode(const char* mode, int port, size_t clients, double seconds) {
+    const std::string keep = "GET /ping HTTP/1.1\r\nHost: bench\r\n\r\n";
+    const std::string close_req = "GET /ping HTTP/1.1\r\nHost: bench\r\nConnection: close\r\n\r\n";
+    std::string batch;
+    for (size_t i = 0; i < PIPELINE_DEPTH; ++i) batch += keep;
+
+    std::atomic<size_t> done{0}, failed{0}, reconnects{0};
+    auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    std::vector<std::thread> threads;
+    auto t0 = Clock::now();
+    for (size_t t = 0; t < clients; ++t) {
+        threads.emplace_back([&] {
+            std::string buf;
+            int fd = -1;
+            while (Clock::now() < deadline) {
+                bool fresh = std::strcmp(mode, "close") == 0;
+                if (fd < 0 || fresh) {
+                    if (fd >= 0) close(fd);
+                    fd = connect_to(port);
+                    buf.clear();
+                    if (fd < 0) {
+                        failed++;
+                        continue;
+                    }
+                }
+                bool pipelined = std::strcmp(mode, "pipelined") == 0;
+                size_t want = pipelined ? PIPELINE_DEPTH : 1;
+                bool closing = false;
+                size_t got = send_all(fd, fresh ? close_req : pipelined ? batch : keep)
+                                 ? read_responses(fd, buf, want, closing) : 0;
+                done += got;
+                if (closing) {
+                    // Request limit reached; pipelined requests past it are
+                    // dropped by the server and resent on a new connection
+                    if (!fresh) reconnects++;
+                    close(fd);
+                    fd = -1;
+                } else if (got < want) {
+                    failed += want - got;
+                    close(fd);
+                    fd = -1;
+                }
+            }
+            if (fd >= 0) close(fd);
+        });
+    }
+    for (auto& th : threads) th.join();
+    double elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+    double rate = (double)done / elapsed;
+    std::printf("  %-11s %10.0f req/s  (%zu requests, %zu reconnects, %zu failed)\n", mode, rate, done.load(),
+                reconnects.load(), failed.load());
+    return rate;
+}
+}
+
+int main() {
+    const NexusConfig& cfg = NexusConfig::get();
+    int port = (int)NexusConfig::env_size("NEXUS_BENCH_PORT", 18080);
+    size_t clients = std::max<size_t>(1, NexusConfig::env_size("NEXUS_BENCH_CLIENTS", 4));
+    double seconds = (double)std::max<size_t>(1, NexusConfig::env_size("NEXUS_BENCH_SECONDS", 2));
+
+    WebServer server(port);
+    server.register_route("GET", "/ping", [](const HttpRequest&) {
+        HttpResponse resp;
+        resp.headers["Content-Type"] = "application/json";
+        resp.body = "{\"ok\":true}";
+        return resp;
+    });
+    server.start();
+    if (!server.is_running()) return 1;
+
+    std::printf("clients=%zu acceptors=%zu workers=%zu max_requests=%zu\n", clients, cfg.http_acceptors,
+                cfg.http_workers, cfg.http_max_requests);
+    double fresh = run_mode("close", port, clients, seconds);
+    double kept = run_mode("keep-alive", port, clients, seconds);
+    run_mode("pipelined", port, clients, seconds);
+    std::printf("  keep-alive / close: %.2fx\n", fresh > 0 ? kept / fresh : 0.0);
+    server.stop();
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Neural tick throughput benchmark.
+//
+// Builds random neuron graphs (NEXUS_BENCH_LINKS links per neuron, default 8)
+// at 10k, 100k and 1M neurons and reports ticks/sec for the raw CSR kernel and
+// for a full NeuronSlab tick (gather, kernel, scatter). Thread count follows
+// NEXUS_THREADS, row partition size NEXUS_NEURAL_GRAIN.
+//
+//   make bench-neural
+//   NEXUS_THREADS=3 ./output/nexus-bench-neural 10000 100000
+
+#include "../struct.h"
+#include "../config.h"
+#include "../thread_pool.h"
+#include "../neural_engine.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+// Runs fn until at least min_seconds have passed; returns calls per second.
+template<typename Fn>
+double ticks_per_second(Fn fn, double min_seconds) {
+    fn();  // warm-up
+    size_t ticks = 0;
+    auto t0 = Clock::now();
+    double elapsed = 0;
+    do {
+        fn();
+        ++ticks;
+        elapsed = seconds_since(t0);
+    } while (elapsed < min_seconds);
+    return (double)ticks / elapsed;
+}
+
+void bench(size_t n, size_t links, ThreadPool& pool, size_t grain) {
+    std::mt19937_64 rng(42 + n);
+    std::uniform_int_distribution<size_t> pick(0, n - 1);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+
+    NeuronSlab slab;
+    slab.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        Neuron nr;
+        nr.id = (int)i;
+        nr.weight = unit(rng);
+        nr.bias = unit(rng) * 0.5;
+        slab.add(std::move(nr));
+    }
+    for (size_t i = 0; i < n; ++i) {
+        Neuron& nr = slab[i];
+        for (size_t k = 0; k < links; ++k) nr.links.push_back(slab.handle_at(pick(rng)));
+    }
+    slab.touch_topology();
+
+    NeuralEngine engine;
+    auto t0 = Clock::now();
+    engine.step(slab, pool, grain);
+    double build = seconds_since(t0);
+
+    double full = ticks_per_second([&] { engine.step(slab, pool, grain); }, 1.0);
+
+    // Kernel-only: same graph, no slab traffic.
+    std::vector<uint32_t> row_ptr(n + 1), cols;
+    std::vector<double> vals, weights(n), biases(n);
+    cols.reserve(n * links);
+    vals.reserve(n * links);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t k = 0; k < links; ++k) {
+            cols.push_back((uint32_t)pick(rng));
+            vals.push_back(0.1);
+        }
+        row_ptr[i + 1] = (uint32_t)cols.size();
+        weights[i] = unit(rng);
+        biases[i] = unit(rng) * 0.5;
+    }
+    NeuralEngine kernel;
+    kernel.load(std::move(row_ptr), std::move(cols), std::move(vals), std::move(weights), std::move(biases));
+    double raw = ticks_per_second([&] { kernel.step_arrays(pool, grain); }, 1.0);
+
+    std::printf("%9zu neurons %10zu links | build %7.1f ms | kernel %9.1f ticks/s (%6.1f Mlinks/s) | slab tick %9.1f ticks/s\n",
+                n, engine.nnz(), build * 1e3, raw, raw * (double)kernel.nnz() / 1e6, full);
+}
+}
+
+int main(int argc, char** argv) {
+    const NexusConfig& cfg = NexusConfig::get();
+    ThreadPool& pool = ThreadPool::shared();
+    size_t links = NexusConfig::env_size("NEXUS_BENCH_LINKS", 8);
+
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    if (sizes.empty()) sizes = {10000, 100000, 1000000};
+
+    std::printf("threads=%zu grain=%zu links/neuron=%zu\n", pool.concurrency(), cfg.neural_grain, links);
+    for (size_t n : sizes) {
+        if (n > 0) bench(n, links, pool, cfg.neural_grain);
+    }
+    return 0;
+}
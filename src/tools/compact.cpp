@@ -0,0 +1,326 @@
+// Offline state compaction.
+//
+// Loads a saved model (binary base plus delta log, or text), drops what the
+// runtime decay passes would prune (PruneRules), cleans up what they never
+// reach, renumbers neurons densely and writes the result as a fresh snapshot
+// in NEXUS_SNAPSHOT_FORMAT. The input is never modified; stop Nexus first so
+// the state and its learning log are settled, then swap the output in.
+//
+// Rules, all on unless disabled:
+//   links     neuron links to removed neurons, weak and orphaned embedding links
+//   concepts  weak concepts; C_<gen>/bootstrap_<n> concepts with < 2 words left
+//   world     weak world-model relationships
+//   ngrams    bigram/trigram counts below the decay floor
+//   goals     spent goals
+//   dedup     repeated neuron links, concept words and subgoals
+//   renumber  neuron ids to 0..n-1 in id order
+// and, opt-in, `--prune-tokens` for unstable embeddings.
+//
+//   make compact
+//   ./output/nexus-compact state.dat state.compact.dat
+
+#include "../state.h"
+#include "../persistence.h"
+#include "../prune_rules.h"
+#include "../memory_accounting.h"
+#include <cstdio>
+#include <filesystem>
+#include <set>
+
+namespace fs = std::filesystem;
+
+namespace {
+struct Rules {
+    bool links = true, concepts = true, world = true, ngrams = true, goals = true, dedup = true, renumber = true;
+    bool tokens = false;
+};
+
+struct Counts {
+    uint64_t bytes = 0;
+    size_t neurons = 0, neuron_links = 0, tokens = 0, embeddings = 0, embedding_links = 0, concepts = 0;
+    size_t bigrams = 0, trigrams = 0, goals = 0, relations = 0;
+};
+
+// What each rule removed, in report order.
+struct Removed {
+    size_t dangling_links = 0, duplicate_links = 0, weak_embedding_links = 0, orphan_embedding_links = 0;
+    size_t unstable_tokens = 0, weak_concepts = 0, dead_concepts = 0, duplicate_words = 0;
+    size_t weak_relations = 0, weak_ngrams = 0, spent_goals = 0, duplicate_subgoals = 0;
+    size_t renumbered = 0;
+};
+
+uint64_t file_bytes(const string& path) {
+    std::error_code ec;
+    uint64_t bytes = 0;
+    for (const string& p : {path, path + ".delta"}) {
+        auto n = fs::file_size(p, ec);
+        if (!ec) bytes += n;
+    }
+    return bytes;
+}
+
+Counts count_state(const string& path) {
+    Counts c;
+    c.bytes = file_bytes(path);
+    c.neurons = S.N.size();
+    for (const Neuron& n : S.N) c.neuron_links += n.links.size();
+    c.tokens = S.tokens.size();
+    c.embeddings = token_concept_embedding_map.size();
+    for (auto& p : token_concept_embedding_map) c.embedding_links += p.second.linked_concepts.size();
+    c.concepts = S.concepts.size();
+    for (auto& w1 : bigram_counts) c.bigrams += w1.second.size();
+    for (auto& w1 : trigram_counts)
+        for (auto& w2 : w1.second) c.trigrams += w2.second.size();
+    c.goals = goal_system.size();
+    for (auto& r : world_model.relationships) c.relations += r.second.size();
+    return c;
+}
+
+// Erases the entries of `m` matching `pred`; returns how many.
+template<typename M, typename Pred>
+size_t erase_matching(M& m, Pred pred) {
+    size_t removed = 0;
+    for (auto it = m.begin(); it != m.end();) {
+        if (pred(*it)) {
+            it = m.erase(it);
+            removed++;
+        } else {
+            ++it;
+        }
+    }
+    return removed;
+}
+
+// Keeps the first element of each key, in order; returns how many were
+// dropped.
+template<typename T, typename Key>
+size_t dedup_in_order(vector<T>& v, Key key) {
+    set<decltype(key(v.front()))> seen;
+    size_t before = v.size();
+    v.erase(remove_if(v.begin(), v.end(), [&](const T& x) { return !seen.insert(key(x)).second; }), v.end());
+    return before - v.size();
+}
+template<typename T>
+size_t dedup_in_order(vector<T>& v) {
+    return dedup_in_order(v, [](const T& x) { return x; });
+}
+
+bool generated_concept(const string& name) {
+    return name.rfind("C_", 0) == 0 || name.rfind("bootstrap_", 0) == 0;
+}
+
+bool known_word(const string& w) {
+    return token_concept_embedding_map.contains(w) || S.tokens.contains(w);
+}
+
+void prune_neurons(const Rules& rules, Removed& rm) {
+    // Links whose target was missing from the file were dropped by the load
+    rm.dangling_links = dangling_links_dropped();
+    for (Neuron& n : S.N) {
+        if (rules.links) {
+            rm.dangling_links += erase_matching(n.links, [](NeuronHandle h) { return !S.N.contains(h); });
+        }
+        if (rules.dedup) {
+            rm.duplicate_links += dedup_in_order(n.links, [](NeuronHandle h) { return (uint64_t)h.index << 32 | h.generation; });
+        }
+    }
+    if (rules.renumber) {
+        vector<Neuron*> by_id;
+        by_id.reserve(S.N.size());
+        for (Neuron& n : S.N) by_id.push_back(&n);
+        sort(by_id.begin(), by_id.end(), [](const Neuron* a, const Neuron* b) { return a->id < b->id; });
+        for (size_t i = 0; i < by_id.size(); i++) {
+            if (by_id[i]->id != (int)i) rm.renumbered++;
+            by_id[i]->id = (int)i;
+        }
+        S.N.by_id.clear();
+        for (size_t i = 0; i < S.N.size(); i++) {
+            NeuronHandle h = S.N.handle_at(i);
+            S.N.by_id[S.N.get(h)->id] = h;
+        }
+        S.N.touch_topology();
+        S.total_neurons_ever = (int)by_id.size();
+    }
+}
+
+void prune_lexicon(const Rules& rules, Removed& rm) {
+    if (rules.tokens) {
+        rm.unstable_tokens = erase_matching(token_concept_embedding_map, [](auto& p) { return PruneRules::unstable_token(p.second); });
+    }
+    if (rules.links) {
+        for (auto& p : token_concept_embedding_map) {
+            rm.weak_embedding_links += erase_matching(p.second.linked_concepts, [](auto& l) { return PruneRules::weak_link(l.second); });
+            rm.orphan_embedding_links += erase_matching(p.second.linked_concepts, [](auto& l) {
+                return !known_word(l.first) && !S.concepts.contains(l.first);
+            });
+        }
+    }
+    if (rules.ngrams) {
+        for (auto& w1 : bigram_counts) {
+            rm.weak_ngrams += erase_matching(w1.second, [](auto& p) { return PruneRules::weak_ngram(p.second); });
+        }
+        for (auto& w1 : trigram_counts) {
+            for (auto& w2 : w1.second) {
+                rm.weak_ngrams += erase_matching(w2.second, [](auto& p) { return PruneRules::weak_ngram(p.second); });
+            }
+            erase_matching(w1.second, [](auto& p) { return p.second.empty(); });
+        }
+        erase_matching(trigram_counts, [](auto& p) { return p.second.empty(); });
+        erase_matching(bigram_counts, [](auto& p) { return p.second.empty(); });
+    }
+}
+
+void prune_concepts(const Rules& rules, Removed& rm) {
+    // Working memory may still name a concept; those stay
+    set<string> in_use(S.working_memory_concepts.begin(), S.working_memory_concepts.end());
+    for (auto it = S.concepts.begin(); it != S.concepts.end();) {
+        Concept& c = it->second;
+        if (rules.dedup) rm.duplicate_words += dedup_in_order(c.related_words);
+        bool drop = false;
+        if (rules.concepts && !in_use.count(it->first)) {
+            if (PruneRules::weak_concept(c)) {
+                drop = true;
+                rm.weak_concepts++;
+            } else if (generated_concept(it->first) &&
+                       count_if(c.related_words.begin(), c.related_words.end(), known_word) < 2) {
+                // Formed from at least two words; fewer than that survive
+                drop = true;
+                rm.dead_concepts++;
+            }
+        }
+        it = drop ? S.concepts.erase(it) : next(it);
+    }
+}
+
+void prune_world_and_goals(const Rules& rules, Removed& rm) {
+    if (rules.world) {
+        for (auto& r : world_model.relationships) {
+            rm.weak_relations += erase_matching(r.second, [](auto& p) { return PruneRules::weak_relation(p.second); });
+        }
+        erase_matching(world_model.relationships, [](auto& p) { return p.second.empty(); });
+    }
+    if (rules.goals) {
+        rm.spent_goals = erase_matching(goal_system, [](auto& p) { return PruneRules::spent_goal(p.second); });
+    }
+    if (rules.dedup) {
+        for (auto& g : goal_system) rm.duplicate_subgoals += dedup_in_order(g.second.subgoals);
+    }
+}
+
+double change_pct(uint64_t before, uint64_t after) {
+    return before ? 100.0 * ((double)after - (double)before) / (double)before : 0.0;
+}
+
+void report_row(const char* name, uint64_t before, uint64_t after) {
+    printf("  %-18s %12llu %12llu %8.1f%%\n", name, (unsigned long long)before, (unsigned long long)after,
+           change_pct(before, after));
+}
+
+void report(const Counts& b, const Counts& a, const Removed& rm) {
+    printf("\n  %-18s %12s %12s %9s\n", "", "before", "after", "change");
+    printf("  %-18s %12s %12s %8.1f%%\n", "size", MemoryAccounting::format_bytes(b.bytes).c_str(),
+           MemoryAccounting::format_bytes(a.bytes).c_str(), change_pct(b.bytes, a.bytes));
+    report_row("neurons", b.neurons, a.neurons);
+    report_row("neuron links", b.neuron_links, a.neuron_links);
+    report_row("tokens", b.tokens, a.tokens);
+    report_row("embeddings", b.embeddings, a.embeddings);
+    report_row("embedding links", b.embedding_links, a.embedding_links);
+    report_row("concepts", b.concepts, a.concepts);
+    report_row("bigrams", b.bigrams, a.bigrams);
+    report_row("trigrams", b.trigrams, a.trigrams);
+    report_row("goals", b.goals, a.goals);
+    report_row("relationships", b.relations, a.relations);
+
+    printf("\n  removed: %zu dangling + %zu duplicate neuron links, %zu weak + %zu orphaned embedding links,\n"
+           "           %zu unstable embeddings, %zu weak + %zu dead concepts, %zu repeated concept words,\n"
+           "           %zu weak relationships, %zu weak n-grams, %zu spent goals, %zu repeated subgoals\n"
+           "  renumbered %zu neuron ids\n",
+           rm.dangling_links, rm.duplicate_links, rm.weak_embedding_links, rm.orphan_embedding_links,
+           rm.unstable_tokens, rm.weak_concepts, rm.dead_concepts, rm.duplicate_words,
+           rm.weak_relations, rm.weak_ngrams, rm.spent_goals, rm.duplicate_subgoals, rm.renumbered);
+}
+
+int usage() {
+    fprintf(stderr,
+            "usage: nexus-compact [options] <state> [output]\n"
+            "  output defaults to <state>.compact\n"
+            "  --no-links --no-concepts --no-world --no-ngrams --no-goals --no-dedup --no-renumber\n"
+            "                   disable a rule\n"
+            "  --prune-tokens   also drop unstable embeddings (low stability and frequency)\n"
+            "  --dry-run        report only, write nothing\n");
+    return 2;
+}
+}
+
+int main(int argc, char** argv) {
+    Rules rules;
+    bool dry_run = false;
+    vector<string> paths;
+    for (int i = 1; i < argc; i++) {
+        string a = argv[i];
+        if (a == "--no-links") rules.links = false;
+        else if (a == "--no-concepts") rules.concepts = false;
+        else if (a == "--no-world") rules.world = false;
+        else if (a == "--no-ngrams") rules.ngrams = false;
+        else if (a == "--no-goals") rules.goals = false;
+        else if (a == "--no-dedup") rules.dedup = false;
+        else if (a == "--no-renumber") rules.renumber = false;
+        else if (a == "--prune-tokens") rules.tokens = true;
+        else if (a == "--dry-run") dry_run = true;
+        else if (a.rfind("-", 0) == 0) return usage();
+        else paths.push_back(a);
+    }
+    if (paths.empty() || paths.size() > 2) return usage();
+    string in = paths[0];
+    string out = paths.size() > 1 ? paths[1] : in + ".compact";
+
+    std::error_code ec;
+    if (!fs::exists(in, ec)) {
+        fprintf(stderr, "nexus-compact: %s does not exist\n", in.c_str());
+        return 1;
+    }
+    // Writing over the input would orphan its delta log before the new base
+    // is durable
+    if (fs::exists(out, ec) && fs::equivalent(in, out, ec)) {
+        fprintf(stderr, "nexus-compact: output must differ from the input; write elsewhere and swap it in\n");
+        return 1;
+    }
+    auto wal = fs::file_size(in + ".wal", ec);
+    if (!ec && wal > 0) {
+        fprintf(stderr, "nexus-compact: %s.wal holds %llu bytes of learning events not in %s; start and stop Nexus "
+                        "once to fold them in, or they are left out of the output\n",
+                in.c_str(), (unsigned long long)wal, in.c_str());
+    }
+
+    ld(in);
+    if (S.N.empty() && S.tokens.empty() && token_concept_embedding_map.empty() && S.concepts.empty()) {
+        fprintf(stderr, "nexus-compact: nothing loaded from %s\n", in.c_str());
+        return 1;
+    }
+    Counts before = count_state(in);
+    before.neuron_links += dangling_links_dropped();
+
+    Removed rm;
+    prune_neurons(rules, rm);
+    prune_lexicon(rules, rm);
+    prune_concepts(rules, rm);
+    prune_world_and_goals(rules, rm);
+
+    Counts after;
+    if (dry_run) {
+        after = count_state(in);
+        after.bytes = before.bytes;
+        printf("\n[Dry run, nothing written]\n");
+    } else {
+        // A base written over an older file must not pick up its deltas
+        fs::remove(out + ".delta", ec);
+        sv(out);
+        if (!fs::exists(out, ec)) {
+            fprintf(stderr, "nexus-compact: failed to write %s\n", out.c_str());
+            return 1;
+        }
+        after = count_state(out);
+    }
+    report(before, after, rm);
+    return 0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#ifndef UNDO_LOG_H
+#define UNDO_LOG_H
+
+#include <vector>
+#include <functional>
+#include <unordered_set>
+#include <utility>
+#include <cstddef>
+
+// Transaction journal for in-place state mutation.
+//
+// begin() opens a transaction. Code that is about to mutate something calls
+// save()/save_entry()/record() first; each stores just enough to put the old
+// value back. rollback() replays the entries newest-first and commit() drops
+// them, so both cost is proportional to what the transaction touched rather
+// than to the size of the model. Outside a transaction every call is a no-op.
+//
+// save() and save_entry() remember what they already captured, so saving the
+// same location repeatedly inside one transaction keeps only the oldest value.
+class UndoLog {
+public:
+    void begin() {
+        clear();
+        active_ = true;
+    }
+    bool active() const { return active_; }
+    size_t size() const { return undo_.size(); }
+
+    // Old value of one object; restored by assignment.
+    template<typename T>
+    void save(T& ref) {
+        if (!active_ || !saved_.insert(&ref).second) return;
+        undo_.push_back([&ref, old = ref]() mutable { ref = std::move(old); });
+        bytes_ += sizeof(T);
+    }
+
+    // Old entry of an associative container, or its absence.
+    template<typename M>
+    void save_entry(M& m, const typename M::key_type& key) {
+        if (!active_) return;
+        auto it = m.find(key);
+        if (it != m.end()) {
+            if (!saved_.insert(&it->second).second) return;
+            undo_.push_back([&m, key, old = it->second]() mutable { m[key] = std::move(old); });
+        } else {
+            undo_.push_back([&m, key]() { m.erase(key); });
+        }
+        bytes_ += sizeof(key) + sizeof(typename M::mapped_type);
+    }
+
+    // Arbitrary undo action for mutations the helpers above cannot express.
+    void record(std::function<void()> undo, size_t bytes = 0) {
+        if (!active_) return;
+        undo_.push_back(std::move(undo));
+        bytes_ += bytes;
+    }
+
+    void rollback() {
+        for (size_t i = undo_.size(); i-- > 0;) undo_[i]();
+        clear();
+    }
+    void commit() { clear(); }
+
+    // Approximate heap held by pending entries.
+    size_t bytes() const { return bytes_ + undo_.capacity() * sizeof(std::function<void()>); }
+
+private:
+    void clear() {
+        undo_.clear();
+        saved_.clear();
+        bytes_ = 0;
+        active_ = false;
+    }
+
+    std::vector<std::function<void()>> undo_;
+    std::unordered_set<const void*> saved_;
+    size_t bytes_ = 0;
+    bool active_ = false;
+};
+
+#endif
@@ -1,8 +1,12 @@
 #include "web_server.h"
+#include "config.h"
+#include "thread_pool.h"
+#include "http_parser.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
 #include <fstream>
+#include <unordered_map>
 
 #ifdef _WIN32
     #include <winsock2.h>
@@ -16,6 +20,10 @@
     #include <cstring>
     #include <fcntl.h>
     #include <sys/select.h>
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <sys/uio.h>
+    #include <netinet/tcp.h>
     #include <errno.h>
     #define SOCKET int
     #define INVALID_SOCKET -1
@@ -29,9 +37,93 @@ WebServer::~WebServer() {
     stop();
 }
 
+// ===== EVENT LOOP STATE =====
+
+namespace {
+constexpr size_t READ_CHUNK = 16 * 1024;
+constexpr int MAX_EVENTS = 64;
+constexpr int LOOP_TICK_MS = 1000;      // longest epoll_wait; stop() also wakes the loops
+
+HttpLimits request_limits() {
+    const NexusConfig& cfg = NexusConfig::get();
+    HttpLimits limits;
+    limits.max_head_bytes = cfg.http_max_head_bytes;
+    limits.max_headers = cfg.http_max_headers;
+    limits.max_body_bytes = cfg.http_max_body_bytes;
+    return limits;
+}
+
+HttpResponse error_response(int status, const char* why) {
+    HttpResponse resp;
+    resp.status_code = status;
+    resp.headers["Content-Type"] = "application/json";
+    resp.body = std::string("{\"error\": \"") + why + "\"}";
+    return resp;
+}
+}
+
+struct WebServer::Connection {
+    int fd = -1;
+    uint64_t id = 0;            // tells a reused fd apart from the connection a response was for
+    std::string in;             // received bytes; the current request starts at in_begin
+    size_t in_begin = 0;
+    HttpParser parser;          // progress through the current request
+    std::string head, body;     // response being written
+    size_t sent = 0;            // bytes of head + body written so far
+    bool busy = false;          // a request is with a handler or being written
+    bool keep_alive = false;    // of the response being written
+    bool draining = false;      // last response sent, write side shut, discarding input
+    bool peer_closed = false;
+    size_t served = 0;          // requests dispatched on this connection
+    std::chrono::steady_clock::time_point last_active;
+};
+
+struct WebServer::EventLoop {
+    // Response finished on a handler thread, waiting for its loop
+    struct Done {
+        int fd;
+        uint64_t id;
+        std::string head, body;
+        bool keep_alive;
+    };
+
+    int epoll_fd = -1, wake_fd = -1, listen_fd = -1;
+    bool owns_listener = false;
+    std::chrono::steady_clock::time_point last_sweep;
+    std::thread thread;
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+    uint64_t next_id = 1;
+    std::mutex done_mutex;
+    std::vector<Done> done;
+
+    void wake() {
+#ifndef _WIN32
+        uint64_t one = 1;
+        if (wake_fd >= 0 && write(wake_fd, &one, sizeof(one)) < 0) {}
+#endif
+    }
+    ~EventLoop() {
+#ifndef _WIN32
+        for (auto& [fd, c] : connections) close(fd);
+        if (owns_listener && listen_fd >= 0) close(listen_fd);
+        if (wake_fd >= 0) close(wake_fd);
+        if (epoll_fd >= 0) close(epoll_fd);
+#endif
+    }
+};
+
 void WebServer::start() {
     if (running_.load()) return;
     running_.store(true);
+#ifndef _WIN32
+    // Sockets are set up here so bind errors and the listening time are
+    // known when start() returns
+    if (!open_loops()) {
+        loops_.clear();
+        running_.store(false);
+        return;
+    }
+#endif
     server_thread_ = std::make_unique<std::thread>(&WebServer::run_server, this);
 }
 
@@ -40,42 +132,133 @@ void WebServer::stop() {
     
     running_.store(false);
     
+#ifdef _WIN32
     // Close socket to interrupt accept/select
     if (listen_socket_ != INVALID_SOCKET) {
         shutdown(listen_socket_, SHUT_RDWR);
         closesocket(listen_socket_);
         listen_socket_ = INVALID_SOCKET;
     }
+#else
+    for (auto& loop : loops_) loop->wake();
+#endif
     
     // Wait for thread
     if (server_thread_ && server_thread_->joinable()) {
         server_thread_->join();
     }
+    // Handlers still running post to their loops, so the pool goes first
+    workers_.reset();
+    loops_.clear();
+    listen_socket_ = INVALID_SOCKET;
 }
 
 bool WebServer::is_running() const {
     return running_.load();
 }
 
-void WebServer::register_route(const std::string& method, const std::string& path, RequestHandler handler) {
-    std::lock_guard<std::mutex> lock(handlers_mutex_);
-    if (method == "GET") {
-        get_handlers_[path] = handler;
-    } else if (method == "POST") {
-        post_handlers_[path] = handler;
+std::chrono::steady_clock::time_point WebServer::listening_since() const {
+    return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(listening_since_.load()));
+}
+
+std::chrono::steady_clock::time_point WebServer::first_response_at() const {
+    return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(first_response_at_.load()));
+}
+
+// ===== ROUTING =====
+
+namespace {
+// "/api/words/:id" -> {"api", "words", ":id"}; "/" -> {""}
+std::vector<std::string_view> split_path(std::string_view path) {
+    std::vector<std::string_view> segments;
+    if (!path.empty() && path.front() == '/') path.remove_prefix(1);
+    for (;;) {
+        size_t slash = path.find('/');
+        segments.push_back(path.substr(0, slash));
+        if (slash == std::string_view::npos) break;
+        path.remove_prefix(slash + 1);
+    }
+    return segments;
+}
+
+bool is_param(std::string_view segment) {
+    return segment.size() > 1 && segment.front() == ':';
+}
+}
+
+struct WebServer::RouteTable {
+    using Methods = std::unordered_map<std::string, RequestHandler>;
+    struct Pattern {
+        std::string path;
+        std::vector<std::string> segments;      // ":name" captures
+        Methods methods;
+    };
+
+    std::unordered_map<std::string, Methods> exact;
+    // Parameterized routes by segment count, in registration order
+    std::unordered_map<size_t, std::vector<Pattern>> patterns;
+
+    const Methods* match(const std::string& path, std::map<std::string, std::string>& params) const {
+        auto it = exact.find(path);
+        if (it != exact.end()) return &it->second;
+        if (patterns.empty()) return nullptr;
+        std::vector<std::string_view> segments = split_path(path);
+        auto bucket = patterns.find(segments.size());
+        if (bucket == patterns.end()) return nullptr;
+        for (const Pattern& p : bucket->second) {
+            bool matched = true;
+            for (size_t i = 0; i < segments.size() && matched; ++i) {
+                const std::string& want = p.segments[i];
+                matched = is_param(want) ? !segments[i].empty() : segments[i] == want;
+            }
+            if (!matched) continue;
+            for (size_t i = 0; i < segments.size(); ++i) {
+                if (is_param(p.segments[i])) params[p.segments[i].substr(1)] = segments[i];
+            }
+            return &p.methods;
+        }
+        return nullptr;
     }
+
+    Methods& slot(const std::string& path) {
+        std::vector<std::string_view> segments = split_path(path);
+        if (std::none_of(segments.begin(), segments.end(), is_param)) return exact[path];
+        auto& bucket = patterns[segments.size()];
+        for (Pattern& p : bucket) {
+            if (p.path == path) return p.methods;
+        }
+        Pattern& p = bucket.emplace_back();
+        p.path = path;
+        for (std::string_view s : segments) p.segments.emplace_back(s);
+        return p.methods;
+    }
+};
+
+void WebServer::register_route(const std::string& method, const std::string& path, RequestHandler handler) {
+    std::lock_guard<std::mutex> lock(routes_mutex_);
+    const RouteTable* current = routes_.load(std::memory_order_acquire);
+    auto next = current ? std::make_unique<RouteTable>(*current) : std::make_unique<RouteTable>();
+    next->slot(path)[method] = std::move(handler);
+    routes_.store(next.get(), std::memory_order_release);
+    route_versions_.push_back(std::move(next));
 }
 
 void WebServer::register_static_file(const std::string& path, const std::string& file_path) {
-    std::lock_guard<std::mutex> lock(handlers_mutex_);
+    std::lock_guard<std::mutex> lock(routes_mutex_);
     static_files_[path] = file_path;
 }
 
-void WebServer::run_server() {
+void WebServer::note_response_sent() {
+    std::chrono::steady_clock::rep none = 0;
+    first_response_at_.compare_exchange_strong(none, std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
 #ifdef _WIN32
+// ===== BLOCKING LOOP (Windows) =====
+
+void WebServer::run_server() {
     WSADATA wsa_data;
     WSAStartup(MAKEWORD(2, 2), &wsa_data);
-#endif
 
     SOCKET sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (sock == INVALID_SOCKET) {
@@ -116,38 +299,13 @@ void WebServer::run_server() {
         return;
     }
 
+    listening_since_.store(std::chrono::steady_clock::now().time_since_epoch().count());
     std::cout << "WebServer started on port " << port_ << std::endl;
 
     while (running_.load()) {
         SOCKET current_sock = listen_socket_;
         if (current_sock == INVALID_SOCKET) break;
 
-#ifndef _WIN32
-        fd_set read_fds;
-        FD_ZERO(&read_fds);
-        FD_SET(current_sock, &read_fds);
-        
-        struct timeval timeout;
-        timeout.tv_sec = 1;
-        timeout.tv_usec = 0;
-        
-        int select_result = select(current_sock + 1, &read_fds, nullptr, nullptr, &timeout);
-        
-        if (select_result < 0) {
-            if (errno == EBADF || errno == EINTR) break;
-            std::cerr << "Select error: " << errno << std::endl;
-            break;
-        }
-        
-        if (select_result == 0 || !running_.load()) {
-            continue;
-        }
-        
-        if (!FD_ISSET(current_sock, &read_fds)) {
-            continue;
-        }
-#endif
-
         sockaddr_in client_addr{};
         socklen_t client_addr_len = sizeof(client_addr);
 
@@ -158,16 +316,30 @@ void WebServer::run_server() {
             continue;
         }
 
-        char buffer[8192] = {0};
-        int recv_len = recv(client_socket, buffer, sizeof(buffer) - 1, 0);
-        
-        if (recv_len > 0) {
-            buffer[recv_len] = '\0';
+        std::string in;
+        HttpParser parser(request_limits());
+        HttpParser::Status status = HttpParser::Status::Incomplete;
+        char buffer[8192];
+        while (status == HttpParser::Status::Incomplete) {
+            int recv_len = recv(client_socket, buffer, sizeof(buffer), 0);
+            if (recv_len <= 0) break;
+            in.append(buffer, (size_t)recv_len);
+            status = parser.parse(in);
+        }
+
+        if (status != HttpParser::Status::Incomplete) {
             try {
-                HttpRequest req = parse_request(std::string(buffer));
-                HttpResponse resp = handle_request(req);
-                std::string response_str = serialize_response(resp);
+                HttpResponse resp;
+                if (status == HttpParser::Status::Complete) {
+                    HttpRequest req = to_request(parser.request());
+                    resp = handle_request(req);
+                } else {
+                    resp = error_response(parser.error_status(), parser.error());
+                }
+                resp.headers["Connection"] = "close";
+                std::string response_str = serialize_head(resp) + resp.body;
                 send(client_socket, response_str.c_str(), response_str.length(), 0);
+                note_response_sent();
             } catch (const std::exception& e) {
                 std::cerr << "Request handling error: " << e.what() << std::endl;
             }
@@ -182,88 +354,406 @@ void WebServer::run_server() {
         listen_socket_ = INVALID_SOCKET;
     }
 
-#ifdef _WIN32
     WSACleanup();
-#endif
 }
+#else
+// ===== EPOLL LOOPS (Linux) =====
 
-HttpRequest WebServer::parse_request(const std::string& raw_request) {
-    HttpRequest req;
-    if (raw_request.empty()) return req;
-    
-    std::istringstream iss(raw_request);
-    
-    std::string request_line;
-    if (!std::getline(iss, request_line)) return req;
-    
-    std::istringstream line_iss(request_line);
-    line_iss >> req.method >> req.path;
-    
-    size_t query_pos = req.path.find('?');
-    if (query_pos != std::string::npos) {
-        req.query = req.path.substr(query_pos + 1);
-        req.path = req.path.substr(0, query_pos);
+int WebServer::open_listener(bool reuse_port) {
+    int sock = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (sock < 0) {
+        std::cerr << "Socket creation failed" << std::endl;
+        return -1;
     }
-    
-    std::string header_line;
-    while (std::getline(iss, header_line)) {
-        if (!header_line.empty() && header_line.back() == '\r') {
-            header_line.pop_back();
+    int opt = 1;
+    if (setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0 ||
+        (reuse_port && setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)) {
+        std::cerr << "setsockopt failed" << std::endl;
+        close(sock);
+        return -1;
+    }
+
+    sockaddr_in server_addr{};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    server_addr.sin_port = htons(port_);
+    if (::bind(sock, (sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+        std::cerr << "Bind failed on port " << port_ << std::endl;
+        close(sock);
+        return -1;
+    }
+    if (::listen(sock, SOMAXCONN) < 0) {
+        std::cerr << "Listen failed" << std::endl;
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+bool WebServer::open_loops() {
+    const NexusConfig& cfg = NexusConfig::get();
+    size_t acceptors = std::max<size_t>(1, cfg.http_acceptors);
+    for (size_t i = 0; i < acceptors; ++i) {
+        auto loop = std::make_unique<EventLoop>();
+        loop->listen_fd = open_listener(acceptors > 1);
+        loop->owns_listener = loop->listen_fd >= 0;
+        if (loop->listen_fd < 0) {
+            if (i == 0) return false;
+            // No SO_REUSEPORT: the extra loops accept on the first socket
+            loop->listen_fd = loops_[0]->listen_fd;
         }
-        if (header_line.empty()) break;
-        
-        size_t colon_pos = header_line.find(':');
-        if (colon_pos != std::string::npos && colon_pos + 2 < header_line.length()) {
-            std::string key = header_line.substr(0, colon_pos);
-            std::string value = header_line.substr(colon_pos + 2);
-            req.headers[key] = value;
+        loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        loop->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epoll_event listen_ev{EPOLLIN | EPOLLET, {}}, wake_ev{EPOLLIN | EPOLLET, {}};
+        listen_ev.data.fd = loop->listen_fd;
+        wake_ev.data.fd = loop->wake_fd;
+        if (loop->epoll_fd < 0 || loop->wake_fd < 0 ||
+            epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->listen_fd, &listen_ev) < 0 ||
+            epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->wake_fd, &wake_ev) < 0) {
+            std::cerr << "epoll setup failed: " << strerror(errno) << std::endl;
+            if (loops_.empty()) {
+                if (loop->owns_listener) close(loop->listen_fd);
+                loop->owns_listener = false;
+            }
+            return false;
         }
+        loops_.push_back(std::move(loop));
     }
-    
-    std::string remaining((std::istreambuf_iterator<char>(iss)), std::istreambuf_iterator<char>());
-    req.body = remaining;
-    
+    listen_socket_ = loops_[0]->listen_fd;
+    workers_ = std::make_unique<ThreadPool>(cfg.http_workers);
+    listening_since_.store(std::chrono::steady_clock::now().time_since_epoch().count());
+    std::cout << "WebServer started on port " << port_ << std::endl;
+    return true;
+}
+
+void WebServer::run_server() {
+    for (size_t i = 1; i < loops_.size(); ++i) {
+        loops_[i]->thread = std::thread(&WebServer::run_loop, this, std::ref(*loops_[i]));
+    }
+    run_loop(*loops_[0]);
+    for (size_t i = 1; i < loops_.size(); ++i) {
+        if (loops_[i]->thread.joinable()) loops_[i]->thread.join();
+    }
+}
+
+void WebServer::run_loop(EventLoop& loop) {
+    epoll_event events[MAX_EVENTS];
+    // Idle connections are swept a few times per timeout
+    int tick = (int)std::clamp<size_t>(NexusConfig::get().http_idle_timeout_ms / 4, 10, LOOP_TICK_MS);
+    while (running_.load()) {
+        int n = epoll_wait(loop.epoll_fd, events, MAX_EVENTS, tick);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "epoll_wait error: " << errno << std::endl;
+            break;
+        }
+        for (int i = 0; i < n && running_.load(); ++i) {
+            int fd = events[i].data.fd;
+            uint32_t ev = events[i].events;
+            if (fd == loop.wake_fd) {
+                uint64_t count;
+                while (read(loop.wake_fd, &count, sizeof(count)) > 0) {}
+                complete(loop);
+                continue;
+            }
+            if (fd == loop.listen_fd) {
+                accept_connections(loop);
+                continue;
+            }
+            auto it = loop.connections.find(fd);
+            if (it == loop.connections.end()) continue;
+            if (ev & EPOLLERR) {
+                close_connection(loop, fd);
+                continue;
+            }
+            if (ev & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+                read_connection(loop, *it->second);
+                it = loop.connections.find(fd);
+                if (it == loop.connections.end()) continue;
+            }
+            // Edge-triggered: resume a response that filled the send buffer
+            if ((ev & EPOLLOUT) && !it->second->head.empty()) flush_connection(loop, *it->second);
+        }
+        if (std::chrono::steady_clock::now() - loop.last_sweep >= std::chrono::milliseconds(tick)) close_idle(loop);
+    }
+}
+
+void WebServer::close_idle(EventLoop& loop) {
+    auto now = std::chrono::steady_clock::now();
+    auto timeout = std::chrono::milliseconds(NexusConfig::get().http_idle_timeout_ms);
+    loop.last_sweep = now;
+    std::vector<int> idle;
+    for (auto& [fd, c] : loop.connections) {
+        // A request with its handler is not idle, however long it runs
+        bool handling = c->busy && c->head.empty() && !c->draining;
+        if (!handling && now - c->last_active >= timeout) idle.push_back(fd);
+    }
+    for (int fd : idle) close_connection(loop, fd);
+}
+
+void WebServer::accept_connections(EventLoop& loop) {
+    for (;;) {
+        int fd = accept4(loop.listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            // EAGAIN: drained; EMFILE and friends: retried on the next edge
+            if (errno != EAGAIN && errno != EWOULDBLOCK) std::cerr << "accept failed: " << strerror(errno) << std::endl;
+            return;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        epoll_event ev{EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, {}};
+        ev.data.fd = fd;
+        if (epoll_ctl(loop.epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            continue;
+        }
+        auto c = std::make_unique<Connection>();
+        c->fd = fd;
+        c->id = loop.next_id++;
+        c->parser = HttpParser(request_limits());
+        c->last_active = std::chrono::steady_clock::now();
+        loop.connections[fd] = std::move(c);
+    }
+}
+
+void WebServer::read_connection(EventLoop& loop, Connection& c) {
+    char buffer[READ_CHUNK];
+    for (;;) {
+        ssize_t n = recv(c.fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            c.last_active = std::chrono::steady_clock::now();
+            // Past the last response only the client's FIN matters
+            if (c.draining) continue;
+            c.in.append(buffer, (size_t)n);
+            // A client pipelining far ahead of its responses is cut off
+            // rather than buffered without bound
+            const NexusConfig& cfg = NexusConfig::get();
+            if (c.busy && c.in.size() - c.in_begin > 2 * (cfg.http_max_head_bytes + cfg.http_max_body_bytes)) {
+                close_connection(loop, c.fd);
+                return;
+            }
+            continue;
+        }
+        if (n == 0) {
+            c.peer_closed = true;
+            break;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        close_connection(loop, c.fd);
+        return;
+    }
+    if (c.draining && c.peer_closed) {
+        close_connection(loop, c.fd);
+        return;
+    }
+    if (!c.busy) next_request(loop, c);
+}
+
+void WebServer::next_request(EventLoop& loop, Connection& c) {
+    std::string_view pending(c.in.data() + c.in_begin, c.in.size() - c.in_begin);
+    switch (c.parser.parse(pending)) {
+    case HttpParser::Status::Complete: {
+        const HttpRequestView& view = c.parser.request();
+        HttpRequest req = to_request(view);
+        bool keep_alive = view.keep_alive;
+        // Consumed bytes are skipped, not erased; the buffer is reset once
+        // a pipelined batch is used up
+        c.in_begin += view.length;
+        if (c.in_begin == c.in.size()) {
+            c.in.clear();
+            c.in_begin = 0;
+        }
+        c.parser.reset();
+        dispatch(loop, c, std::move(req), keep_alive);
+        break;
+    }
+    case HttpParser::Status::Error:
+        respond(loop, c, error_response(c.parser.error_status(), c.parser.error()));
+        break;
+    case HttpParser::Status::Incomplete:
+        if (c.peer_closed) {
+            close_connection(loop, c.fd);
+            return;
+        }
+        // Parser positions are relative to in_begin, so the partial request
+        // can move to the front
+        if (c.in_begin > 0) {
+            c.in.erase(0, c.in_begin);
+            c.in_begin = 0;
+        }
+        break;
+    }
+}
+
+void WebServer::dispatch(EventLoop& loop, Connection& c, HttpRequest req, bool keep_alive) {
+    const NexusConfig& cfg = NexusConfig::get();
+    c.busy = true;
+    size_t remaining = cfg.http_max_requests > ++c.served ? cfg.http_max_requests - c.served : 0;
+    keep_alive = keep_alive && remaining > 0;
+    workers_->submit([this, &loop, fd = c.fd, id = c.id, remaining, keep_alive, req = std::move(req)]() mutable {
+        HttpResponse resp;
+        try {
+            resp = handle_request(req);
+        } catch (const std::exception& e) {
+            std::cerr << "Request handling error: " << e.what() << std::endl;
+            resp = HttpResponse{};
+            resp.status_code = 500;
+            resp.body = "{\"error\": \"Internal server error\"}";
+        }
+        keep_alive = keep_alive && running_.load();
+        resp.headers["Connection"] = keep_alive ? "keep-alive" : "close";
+        if (keep_alive) {
+            size_t timeout_s = std::max<size_t>(1, NexusConfig::get().http_idle_timeout_ms / 1000);
+            resp.headers["Keep-Alive"] = "timeout=" + std::to_string(timeout_s) + ", max=" + std::to_string(remaining);
+        }
+        {
+            std::lock_guard<std::mutex> lock(loop.done_mutex);
+            loop.done.push_back({fd, id, serialize_head(resp), std::move(resp.body), keep_alive});
+        }
+        loop.wake();
+    });
+}
+
+void WebServer::respond(EventLoop& loop, Connection& c, HttpResponse resp) {
+    c.busy = true;
+    c.keep_alive = false;
+    resp.headers["Connection"] = "close";
+    c.head = serialize_head(resp);
+    c.body = std::move(resp.body);
+    c.sent = 0;
+    flush_connection(loop, c);
+}
+
+void WebServer::complete(EventLoop& loop) {
+    std::vector<EventLoop::Done> done;
+    {
+        std::lock_guard<std::mutex> lock(loop.done_mutex);
+        done.swap(loop.done);
+    }
+    for (EventLoop::Done& d : done) {
+        auto it = loop.connections.find(d.fd);
+        // The client may have gone away while the handler ran
+        if (it == loop.connections.end() || it->second->id != d.id) continue;
+        Connection& c = *it->second;
+        c.head = std::move(d.head);
+        c.body = std::move(d.body);
+        c.keep_alive = d.keep_alive;
+        c.sent = 0;
+        flush_connection(loop, c);
+    }
+}
+
+void WebServer::flush_connection(EventLoop& loop, Connection& c) {
+    size_t total = c.head.size() + c.body.size();
+    while (c.sent < total) {
+        iovec iov[2];
+        size_t count = 0;
+        if (c.sent < c.head.size()) iov[count++] = {c.head.data() + c.sent, c.head.size() - c.sent};
+        size_t body_sent = c.sent > c.head.size() ? c.sent - c.head.size() : 0;
+        if (body_sent < c.body.size()) iov[count++] = {c.body.data() + body_sent, c.body.size() - body_sent};
+        // sendmsg is writev plus flags: MSG_NOSIGNAL keeps a vanished client
+        // from raising SIGPIPE
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        ssize_t n = sendmsg(c.fd, &msg, MSG_NOSIGNAL);
+        if (n > 0) {
+            c.sent += (size_t)n;
+            c.last_active = std::chrono::steady_clock::now();
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;     // EPOLLOUT resumes
+        close_connection(loop, c.fd);
+        return;
+    }
+    note_response_sent();
+    finish_response(loop, c);
+}
+
+void WebServer::finish_response(EventLoop& loop, Connection& c) {
+    c.head.clear();
+    c.body.clear();
+    c.sent = 0;
+    c.last_active = std::chrono::steady_clock::now();
+    if (!c.keep_alive) {
+        // Closing with unread input would reset the connection and could
+        // destroy the response in flight; shut the write side and wait for
+        // the client's FIN (or the idle timeout) instead
+        if (c.peer_closed) {
+            close_connection(loop, c.fd);
+            return;
+        }
+        shutdown(c.fd, SHUT_WR);
+        c.draining = true;
+        c.in.clear();
+        c.in_begin = 0;
+        return;
+    }
+    c.busy = false;
+    // Pipelined requests are already buffered; serve the next one
+    next_request(loop, c);
+}
+
+void WebServer::close_connection(EventLoop& loop, int fd) {
+    epoll_ctl(loop.epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    loop.connections.erase(fd);
+}
+#endif
+
+// Copies each field out of the connection buffer once; handlers own their
+// request. The path is percent-decoded for routing, the query is left to
+// the handlers.
+HttpRequest WebServer::to_request(const HttpRequestView& view) {
+    HttpRequest req;
+    req.method.assign(view.method);
+    req.path = percent_decode(view.path, false);
+    req.version.assign(view.version);
+    req.query.assign(view.query);
+    for (const auto& [name, value] : view.headers) req.headers.insert_or_assign(std::string(name), std::string(value));
+    req.body.assign(view.body);
     return req;
 }
 
-HttpResponse WebServer::handle_request(const HttpRequest& req) {
+HttpResponse WebServer::handle_request(HttpRequest& req) {
     HttpResponse resp;
     resp.status_code = 200;
     resp.headers["Content-Type"] = "application/json";
     resp.headers["Access-Control-Allow-Origin"] = "*";
     resp.headers["Access-Control-Allow-Methods"] = "GET, POST, OPTIONS";
     resp.headers["Access-Control-Allow-Headers"] = "Content-Type";
-    
-    std::lock_guard<std::mutex> lock(handlers_mutex_);
-    
-    if (req.method == "GET") {
-        auto it = get_handlers_.find(req.path);
-        if (it != get_handlers_.end()) {
-            resp = it->second(req);
-        } else {
-            resp.status_code = 404;
-            resp.body = "{\"error\": \"Not found\"}";
-        }
-    } else if (req.method == "POST") {
-        auto it = post_handlers_.find(req.path);
-        if (it != post_handlers_.end()) {
-            resp = it->second(req);
-        } else {
-            resp.status_code = 404;
-            resp.body = "{\"error\": \"Not found\"}";
-        }
-    } else if (req.method == "OPTIONS") {
-        resp.status_code = 200;
+
+    const RouteTable* routes = routes_.load(std::memory_order_acquire);
+    const RouteTable::Methods* methods = routes ? routes->match(req.path, req.params) : nullptr;
+    if (!methods) {
+        resp.status_code = 404;
+        resp.body = "{\"error\": \"Not found\"}";
+        return resp;
+    }
+    auto it = methods->find(req.method);
+    if (it != methods->end()) return it->second(req);
+
+    std::vector<std::string> allowed;
+    for (const auto& [method, handler] : *methods) allowed.push_back(method);
+    if (!methods->count("OPTIONS")) allowed.push_back("OPTIONS");
+    std::sort(allowed.begin(), allowed.end());
+    std::string allow;
+    for (const std::string& m : allowed) allow += (allow.empty() ? "" : ", ") + m;
+    resp.headers["Allow"] = allow;
+    if (req.method == "OPTIONS") {
         resp.body = "";
     } else {
         resp.status_code = 405;
         resp.body = "{\"error\": \"Method not allowed\"}";
     }
-    
     return resp;
 }
 
-std::string WebServer::serialize_response(const HttpResponse& resp) {
+// Status line and headers; the body is written after it as is.
+std::string WebServer::serialize_head(const HttpResponse& resp) {
     std::ostringstream oss;
     
     oss << "HTTP/1.1 " << resp.status_code << " OK\r\n";
@@ -274,27 +764,7 @@ std::string WebServer::serialize_response(const HttpResponse& resp) {
         oss << key << ": " << value << "\r\n";
     }
     
-    oss << "\r\n" << resp.body;
+    oss << "\r\n";
     
     return oss.str();
 }
-
-std::string WebServer::url_decode(const std::string& url) {
-    std::string decoded;
-    for (size_t i = 0; i < url.length(); ++i) {
-        if (url[i] == '%' && i + 2 < url.length()) {
-            try {
-                std::string hex = url.substr(i + 1, 2);
-                decoded += static_cast<char>(std::stoi(hex, nullptr, 16));
-                i += 2;
-            } catch (...) {
-                decoded += url[i];
-            }
-        } else if (url[i] == '+') {
-            decoded += ' ';
-        } else {
-            decoded += url[i];
-        }
-    }
-    return decoded;
-}
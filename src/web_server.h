@@ -10,13 +10,19 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <chrono>
+
+class ThreadPool;
+struct HttpRequestView;
 
 struct HttpRequest {
     std::string method;
-    std::string path;
+    std::string path;       // percent-decoded
+    std::string version;    // "HTTP/1.1"; decides the keep-alive default
     std::string query;
     std::map<std::string, std::string> headers;
     std::string body;
+    std::map<std::string, std::string> params;     // ":name" path segments of the matched route
 };
 
 struct HttpResponse {
@@ -27,6 +33,35 @@ struct HttpResponse {
 
 using RequestHandler = std::function<HttpResponse(const HttpRequest&)>;
 
+// HTTP server for the web UI and API.
+//
+// On Linux, NEXUS_HTTP_ACCEPTORS threads each run an edge-triggered epoll
+// loop over non-blocking sockets; with more than one, every loop gets its own
+// SO_REUSEPORT listening socket and the kernel spreads connections across
+// them. A complete request is handed to a pool of NEXUS_HTTP_WORKERS handler
+// threads and the response is passed back to the connection's loop, which
+// writes head and body with one writev. All socket I/O for a connection stays
+// on its loop thread, so a slow client only holds up itself.
+//
+// Requests are parsed incrementally (HttpParser) as bytes arrive, so a head
+// or body split across any number of reads costs one pass over it. Bodies
+// are framed by Content-Length or chunked coding and limited by
+// NEXUS_HTTP_MAX_HEAD_BYTES, NEXUS_HTTP_MAX_HEADERS and
+// NEXUS_HTTP_MAX_BODY_BYTES.
+//
+// Connections are persistent (HTTP/1.1 keep-alive) for up to
+// NEXUS_HTTP_MAX_REQUESTS requests and are closed after
+// NEXUS_HTTP_IDLE_TIMEOUT_MS without traffic. Pipelined requests are served
+// one after another in arrival order, so responses go out in request order.
+// The Windows build keeps a blocking loop that serves one request per
+// connection.
+//
+// Routes map a method and a path to a handler. Any method can be
+// registered; a path segment written ":name" matches any one segment and is
+// passed to the handler in HttpRequest::params. Routing never locks: the
+// table is immutable once published, and register_route() copies it, adds
+// the route and swaps the new version in. Handlers therefore run
+// concurrently on the worker pool.
 class WebServer {
 public:
     WebServer(int port = 8080);
@@ -35,26 +70,56 @@ public:
     void start();
     void stop();
     bool is_running() const;
+    // When the socket started listening and when the first response was
+    // sent; the clock's epoch until then.
+    std::chrono::steady_clock::time_point listening_since() const;
+    std::chrono::steady_clock::time_point first_response_at() const;
     
     void register_route(const std::string& method, const std::string& path, RequestHandler handler);
     void register_static_file(const std::string& path, const std::string& file_path);
     
 private:
+    // One epoll loop per acceptor thread (Linux); defined in web_server.cpp.
+    struct Connection;
+    struct EventLoop;
+    struct RouteTable;
+
     int port_;
     std::atomic<bool> running_;
     std::unique_ptr<std::thread> server_thread_;
-    std::mutex handlers_mutex_;
-    std::map<std::string, RequestHandler> get_handlers_;
-    std::map<std::string, RequestHandler> post_handlers_;
+    std::mutex routes_mutex_;      // serializes registration; lookups read routes_
+    std::atomic<const RouteTable*> routes_{nullptr};
+    // Every table published, so a lookup that loaded an older version can
+    // finish with it; registration happens at startup, so this stays small
+    std::vector<std::unique_ptr<const RouteTable>> route_versions_;
     std::map<std::string, std::string> static_files_;
     
     int listen_socket_;  // No atomic needed - protected by running_ flag
+    std::atomic<std::chrono::steady_clock::rep> listening_since_{0};
+    std::atomic<std::chrono::steady_clock::rep> first_response_at_{0};
+
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+    std::unique_ptr<ThreadPool> workers_;   // runs handlers off the I/O threads
     
     void run_server();
-    HttpResponse handle_request(const HttpRequest& req);
-    HttpRequest parse_request(const std::string& raw_request);
-    std::string serialize_response(const HttpResponse& resp);
-    std::string url_decode(const std::string& url);
+    bool open_loops();
+    int open_listener(bool reuse_port);
+    void run_loop(EventLoop& loop);
+    void accept_connections(EventLoop& loop);
+    void read_connection(EventLoop& loop, Connection& c);
+    void dispatch(EventLoop& loop, Connection& c, HttpRequest req, bool keep_alive);
+    void respond(EventLoop& loop, Connection& c, HttpResponse resp);
+    void complete(EventLoop& loop);
+    void flush_connection(EventLoop& loop, Connection& c);
+    void finish_response(EventLoop& loop, Connection& c);
+    void next_request(EventLoop& loop, Connection& c);
+    void close_idle(EventLoop& loop);
+    void close_connection(EventLoop& loop, int fd);
+    void note_response_sent();
+
+    HttpResponse handle_request(HttpRequest& req);
+    static HttpRequest to_request(const HttpRequestView& view);
+    std::string serialize_head(const HttpResponse& resp);
 };
 
 #endif // WEB_SERVER_H
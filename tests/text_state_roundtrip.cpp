@@ -0,0 +1,80 @@
+// Round-trip test for the text state loader.
+//
+// Loads <input> with import_text(), writes the model back out with
+// export_text() and compares the result byte for byte with <golden>. The
+// golden file for tests/data/text_state.txt was written by the original
+// line-by-line reader, so a match means the parallel loader builds the same
+// model, malformed and edge-case lines included. Running it with the golden
+// file as input as well checks that export and import are stable.
+//
+//   make test
+//   ./output/nexus-test-text-state tests/data/text_state.txt tests/data/text_state.golden.txt
+
+#include "../src/state.h"
+#include "../src/text_state.h"
+#include <cstdio>
+#include <filesystem>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+bool read_file(const string& path, string& out) {
+    ifstream in(path, ios::binary);
+    if (!in) return false;
+    out.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    return true;
+}
+
+// 1-based line of the first byte where `a` and `b` differ.
+size_t first_difference(const string& a, const string& b, size_t& line) {
+    size_t i = 0;
+    line = 1;
+    for (; i < a.size() && i < b.size() && a[i] == b[i]; i++) {
+        if (a[i] == '\n') line++;
+    }
+    return i;
+}
+
+string line_at(const string& s, size_t pos) {
+    size_t begin = s.rfind('\n', pos == 0 ? 0 : pos - 1);
+    begin = begin == string::npos ? 0 : begin + 1;
+    size_t end = s.find('\n', pos);
+    return s.substr(begin, end == string::npos ? string::npos : end - begin);
+}
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <input> <golden>\n", argv[0]);
+        return 2;
+    }
+    string input = argv[1], golden_path = argv[2];
+    string golden;
+    if (!fs::exists(input) || !read_file(golden_path, golden)) {
+        fprintf(stderr, "FAIL cannot read %s or %s\n", input.c_str(), golden_path.c_str());
+        return 1;
+    }
+
+    fs::path out = fs::temp_directory_path() / ("nexus-text-state-" + to_string(getpid()) + ".txt");
+    import_text(input);
+    export_text(out.string());
+    string exported;
+    bool ok = read_file(out.string(), exported);
+    fs::remove(out);
+    if (!ok) {
+        fprintf(stderr, "FAIL export_text wrote nothing\n");
+        return 1;
+    }
+
+    if (exported != golden) {
+        size_t line;
+        size_t pos = first_difference(exported, golden, line);
+        fprintf(stderr, "FAIL %s: output differs from %s at line %zu\n", input.c_str(), golden_path.c_str(), line);
+        fprintf(stderr, "  got:      %s\n", pos < exported.size() ? line_at(exported, pos).c_str() : "<end of file>");
+        fprintf(stderr, "  expected: %s\n", pos < golden.size() ? line_at(golden, pos).c_str() : "<end of file>");
+        return 1;
+    }
+    printf("PASS %s (%zu bytes)\n", input.c_str(), exported.size());
+    return 0;
+}